@@ -0,0 +1,66 @@
+#include "trie.hpp"
+#include "trie-bench.hpp"
+
+#include "tests-helpers.hpp"
+#include "catch.hpp"
+
+/*
+ * Nodes of all tries are kept in one global list, so benchmarks only
+ * ever keep a single trie alive and deallocate it before making another.
+ */
+namespace {
+    const char generation[] = "trie1";
+}
+
+TEST_CASE("Benchmark: insert", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "insert", dist, size), words.size(), [&] {
+            trie t;
+            init(t);
+            scope_guard sg([&] () { deallocate(t); });
+            return bench::time_it([&] {
+                for (const auto& word : words) {
+                    insert(t, word);
+                }
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: contains", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t;
+        init(t);
+        scope_guard sg([&] () { deallocate(t); });
+        insert_all(t, words);
+        auto misses = bench::generate_misses(dist, size);
+        bench::run(bench::name(generation, "contains", dist, size), words.size() + misses.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    found += contains(t, word);
+                }
+                for (const auto& word : misses) {
+                    found += contains(t, word);
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: erase", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "erase", dist, size), words.size(), [&] {
+            trie t;
+            init(t);
+            scope_guard sg([&] () { deallocate(t); });
+            insert_all(t, words);
+            return bench::time_it([&] {
+                for (const auto& word : words) {
+                    erase(t, word);
+                }
+            });
+        });
+    });
+}
@@ -0,0 +1,106 @@
+#include "trie.hpp"
+#include "trie-bench.hpp"
+
+#include "catch.hpp"
+
+/*
+ * Nodes of all tries are kept in one global list that the destructor of
+ * any trie frees, so benchmarks never keep two tries alive at once.
+ */
+namespace {
+    const char generation[] = "trie2";
+
+    // Queries that take time proportional to the size of the result are limited to this many calls
+    const size_t max_queries = 1'000;
+}
+
+TEST_CASE("Benchmark: insert", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "insert", dist, size), words.size(), [&] {
+            trie t;
+            return bench::time_it([&] {
+                for (const auto& word : words) {
+                    t.insert(word);
+                }
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: contains", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        auto misses = bench::generate_misses(dist, size);
+        bench::run(bench::name(generation, "contains", dist, size), words.size() + misses.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    found += t.contains(word);
+                }
+                for (const auto& word : misses) {
+                    found += t.contains(word);
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: erase", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "erase", dist, size), words.size(), [&] {
+            trie t{ words };
+            return bench::time_it([&] {
+                for (const auto& word : words) {
+                    t.erase(word);
+                }
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: search_by_prefix", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        auto prefixes = bench::shortened(words, 2, max_queries);
+        bench::run(bench::name(generation, "search_by_prefix", dist, size), prefixes.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& prefix : prefixes) {
+                    found += t.search_by_prefix(prefix).size();
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: get_prefixes", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ bench::shortened(words, 2, words.size()) };
+        bench::run(bench::name(generation, "get_prefixes", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    found += t.get_prefixes(word).size();
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: iteration", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        bench::run(bench::name(generation, "iteration", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                size_t length = 0;
+                for (auto cursor = t.get_word_cursor(); cursor.has_word(); cursor.move_to_next_word()) {
+                    length += cursor.word().size();
+                }
+                bench::do_not_optimize(length);
+            });
+        });
+    });
+}
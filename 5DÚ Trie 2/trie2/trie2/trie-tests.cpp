@@ -1,201 +1,274 @@
-#include "trie.hpp"
-
-#include "catch.hpp"
-
-#include <chrono>
-#include <random>
-#include <iostream>
-#include <algorithm>
-
-#define VALIDATE_SETS(lhs, rhs) \
-    do {\
-        auto l = lhs; \
-        auto r = rhs; \
-        std::sort(begin(l), end(l)); \
-        std::sort(begin(r), end(r)); \
-        REQUIRE(l == r);             \
-   } while(0)
-
-
-namespace {
-
-    std::vector<std::string> as_vec(std::vector<std::string> v) {
-        return v;
-    }
-
-    void insert_all(trie& t, const std::vector<std::string>& strings) {
-        for (const auto& string : strings) {
-            t.insert(string);
-        }
-    }
-}
-
-TEST_CASE("Basics: inserts") {
-    trie trie;
-
-    SECTION("Empty trie") {
-        REQUIRE_FALSE(trie.contains(""));
-        REQUIRE(trie.size() == 0);
-        REQUIRE(trie.empty());
-    }
-
-    SECTION("Trivial inserts") {
-        REQUIRE(trie.insert("abcd"));
-        REQUIRE(trie.contains("abcd"));
-        REQUIRE_FALSE(trie.contains(""));
-        REQUIRE_FALSE(trie.contains("a"));
-        REQUIRE_FALSE(trie.contains("ab"));
-        REQUIRE_FALSE(trie.contains("abc"));
-        REQUIRE(trie.size() == 1);
-
-        REQUIRE(trie.insert("abc"));
-        REQUIRE(trie.contains("abc"));
-        REQUIRE(trie.size() == 2);
-
-        REQUIRE_FALSE(trie.empty());
-    }
-}
-
-TEST_CASE("Basics: erase") {
-    trie trie;
-
-    SECTION("Trivial erase") {
-        REQUIRE(trie.insert("a"));
-        REQUIRE(trie.erase("a"));
-        REQUIRE_FALSE(trie.contains("a"));
-        REQUIRE(trie.size() == 0);
-        REQUIRE(trie.empty());
-
-        REQUIRE(trie.insert("bcd"));
-        REQUIRE(trie.erase("bcd"));
-        REQUIRE_FALSE(trie.contains("bcd"));
-        REQUIRE(trie.size() == 0);
-        REQUIRE(trie.empty());
-    }
-
-    SECTION("Erase in the middle of a link") {
-        insert_all(trie, { "", "a", "ab", "abc", "abcd" });
-        REQUIRE(trie.erase("ab"));
-        REQUIRE(trie.size() == 4);
-        REQUIRE_FALSE(trie.contains("ab"));
-
-        REQUIRE(trie.erase("abc"));
-        REQUIRE(trie.size() == 3);
-        REQUIRE_FALSE(trie.contains("abc"));
-
-        REQUIRE(trie.contains("abcd"));
-    }
-}
-
-TEST_CASE("Complex: inserts") {
-    trie trie;
-
-    SECTION("Repeated inserts do not reinsert given string") {
-        REQUIRE(trie.insert("abcd"));
-        REQUIRE_FALSE(trie.insert("abcd"));
-        REQUIRE(trie.insert("abc"));
-        REQUIRE_FALSE(trie.insert("abc"));
-
-        REQUIRE(trie.contains("abcd"));
-        REQUIRE(trie.contains("abc"));
-        REQUIRE(trie.size() == 2);
-    }
-}
-
-TEST_CASE("Complex: repeated interaction") {
-    trie trie;
-
-    SECTION("Reinserting and reerasing the same element works properly") {
-        insert_all(trie, { "a", "aa", "ab", "ac" });
-        REQUIRE(trie.erase("a"));
-        REQUIRE_FALSE(trie.contains("a"));
-        REQUIRE(trie.insert("a"));
-        REQUIRE(trie.contains("a"));
-        REQUIRE(trie.erase("a"));
-        REQUIRE_FALSE(trie.erase("a"));
-        REQUIRE(trie.contains("aa"));
-        REQUIRE(trie.contains("ab"));
-        REQUIRE(trie.contains("ac"));
-
-        REQUIRE(trie.size() == 3);
-    }
-}
-
-TEST_CASE("Vector constructor") {
-    trie trie({ "abc", "bc", "a", "bc", "d", "", "d", "abcd", "abc" });
-    REQUIRE(trie.size() == 6);
-    REQUIRE(trie.contains(""));
-    REQUIRE(trie.contains("a"));
-    REQUIRE(trie.contains("d"));
-    REQUIRE_FALSE(trie.contains("b"));
-    REQUIRE(trie.contains("bc"));
-    REQUIRE_FALSE(trie.contains("ab"));
-    REQUIRE(trie.contains("abc"));
-    REQUIRE(trie.contains("abcd"));
-}
-
-TEST_CASE("Cursor") {
-    trie t({ "abcd", "aceg", "adgj", "bcde" });
-    auto cursor = t.get_word_cursor();
-    SECTION("Prefix increment") {
-        REQUIRE(cursor.has_word());
-        REQUIRE(cursor.read_word() == "abcd");
-        cursor.move_to_next_word();
-
-        REQUIRE(cursor.has_word());
-        REQUIRE(cursor.read_word() == "aceg");
-        cursor.move_to_next_word();
-
-        REQUIRE(cursor.has_word());
-        REQUIRE(cursor.read_word() == "adgj");
-        cursor.move_to_next_word();
-
-        REQUIRE(cursor.has_word());
-        REQUIRE(cursor.read_word() == "bcde");
-        cursor.move_to_next_word();
-
-        REQUIRE_FALSE(cursor.has_word());
-    }
-    SECTION("Cursor can be reused") {
-        auto cursor2 = cursor;
-        cursor.move_to_next_word();
-        REQUIRE(cursor2.read_word() == "abcd");
-        cursor.move_to_next_word();
-        REQUIRE(cursor2.read_word() == "abcd");
-        cursor.move_to_next_word();
-        REQUIRE(cursor2.read_word() == "abcd");
-        cursor2.move_to_next_word();
-        REQUIRE(cursor2.read_word() == "aceg");
-    }
-    SECTION("Empty string handling") {
-        trie yes({ "", "a", "b", "aaa", "aab" });
-        auto cursor = yes.get_word_cursor();
-        REQUIRE(cursor.read_word() == "");
-        trie no({ "a", "b", "aaa", "aab" });
-        cursor = no.get_word_cursor();
-        REQUIRE(cursor.read_word() == "a");
-    }
-}
-
-TEST_CASE("Search by prefix") {
-    trie trie;
-    auto elems = std::vector<std::string>{ "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" };
-    insert_all(trie, elems);
-    SECTION("Search is inclusive") {
-        VALIDATE_SETS(trie.search_by_prefix("aa"), as_vec({ "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" }));
-    }
-    SECTION("Prefix not in the trie") {
-        VALIDATE_SETS(trie.search_by_prefix(""), elems);
-    }
-}
-
-TEST_CASE("Get prefixes") {
-    trie trie;
-    insert_all(trie, { "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
-    SECTION("Search is inclusive") {
-        VALIDATE_SETS(trie.get_prefixes("aabab"), as_vec({ "aa", "a", "aabab" }));
-    }
-    SECTION("Input is not in the trie") {
-        VALIDATE_SETS(trie.get_prefixes("aaaaa"), as_vec({ "a", "aa", "aaa" }));
-    }
-}
+#include "trie.hpp"
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <algorithm>
+
+#define VALIDATE_SETS(lhs, rhs) \
+    do {\
+        auto l = lhs; \
+        auto r = rhs; \
+        std::sort(begin(l), end(l)); \
+        std::sort(begin(r), end(r)); \
+        REQUIRE(l == r);             \
+   } while(0)
+
+
+namespace {
+
+    std::vector<std::string> as_vec(std::vector<std::string> v) {
+        return v;
+    }
+
+    void insert_all(trie& t, const std::vector<std::string>& strings) {
+        for (const auto& string : strings) {
+            t.insert(string);
+        }
+    }
+}
+
+TEST_CASE("Basics: inserts") {
+    trie trie;
+
+    SECTION("Empty trie") {
+        REQUIRE_FALSE(trie.contains(""));
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.empty());
+    }
+
+    SECTION("Trivial inserts") {
+        REQUIRE(trie.insert("abcd"));
+        REQUIRE(trie.contains("abcd"));
+        REQUIRE_FALSE(trie.contains(""));
+        REQUIRE_FALSE(trie.contains("a"));
+        REQUIRE_FALSE(trie.contains("ab"));
+        REQUIRE_FALSE(trie.contains("abc"));
+        REQUIRE(trie.size() == 1);
+
+        REQUIRE(trie.insert("abc"));
+        REQUIRE(trie.contains("abc"));
+        REQUIRE(trie.size() == 2);
+
+        REQUIRE_FALSE(trie.empty());
+    }
+}
+
+TEST_CASE("Basics: erase") {
+    trie trie;
+
+    SECTION("Trivial erase") {
+        REQUIRE(trie.insert("a"));
+        REQUIRE(trie.erase("a"));
+        REQUIRE_FALSE(trie.contains("a"));
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.empty());
+
+        REQUIRE(trie.insert("bcd"));
+        REQUIRE(trie.erase("bcd"));
+        REQUIRE_FALSE(trie.contains("bcd"));
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.empty());
+    }
+
+    SECTION("Erase in the middle of a link") {
+        insert_all(trie, { "", "a", "ab", "abc", "abcd" });
+        REQUIRE(trie.erase("ab"));
+        REQUIRE(trie.size() == 4);
+        REQUIRE_FALSE(trie.contains("ab"));
+
+        REQUIRE(trie.erase("abc"));
+        REQUIRE(trie.size() == 3);
+        REQUIRE_FALSE(trie.contains("abc"));
+
+        REQUIRE(trie.contains("abcd"));
+    }
+}
+
+TEST_CASE("Complex: inserts") {
+    trie trie;
+
+    SECTION("Repeated inserts do not reinsert given string") {
+        REQUIRE(trie.insert("abcd"));
+        REQUIRE_FALSE(trie.insert("abcd"));
+        REQUIRE(trie.insert("abc"));
+        REQUIRE_FALSE(trie.insert("abc"));
+
+        REQUIRE(trie.contains("abcd"));
+        REQUIRE(trie.contains("abc"));
+        REQUIRE(trie.size() == 2);
+    }
+}
+
+TEST_CASE("Complex: repeated interaction") {
+    trie trie;
+
+    SECTION("Reinserting and reerasing the same element works properly") {
+        insert_all(trie, { "a", "aa", "ab", "ac" });
+        REQUIRE(trie.erase("a"));
+        REQUIRE_FALSE(trie.contains("a"));
+        REQUIRE(trie.insert("a"));
+        REQUIRE(trie.contains("a"));
+        REQUIRE(trie.erase("a"));
+        REQUIRE_FALSE(trie.erase("a"));
+        REQUIRE(trie.contains("aa"));
+        REQUIRE(trie.contains("ab"));
+        REQUIRE(trie.contains("ac"));
+
+        REQUIRE(trie.size() == 3);
+    }
+}
+
+TEST_CASE("Vector constructor") {
+    trie trie({ "abc", "bc", "a", "bc", "d", "", "d", "abcd", "abc" });
+    REQUIRE(trie.size() == 6);
+    REQUIRE(trie.contains(""));
+    REQUIRE(trie.contains("a"));
+    REQUIRE(trie.contains("d"));
+    REQUIRE_FALSE(trie.contains("b"));
+    REQUIRE(trie.contains("bc"));
+    REQUIRE_FALSE(trie.contains("ab"));
+    REQUIRE(trie.contains("abc"));
+    REQUIRE(trie.contains("abcd"));
+}
+
+TEST_CASE("Cursor") {
+    trie t({ "abcd", "aceg", "adgj", "bcde" });
+    auto cursor = t.get_word_cursor();
+    SECTION("Prefix increment") {
+        REQUIRE(cursor.has_word());
+        REQUIRE(cursor.read_word() == "abcd");
+        cursor.move_to_next_word();
+
+        REQUIRE(cursor.has_word());
+        REQUIRE(cursor.read_word() == "aceg");
+        cursor.move_to_next_word();
+
+        REQUIRE(cursor.has_word());
+        REQUIRE(cursor.read_word() == "adgj");
+        cursor.move_to_next_word();
+
+        REQUIRE(cursor.has_word());
+        REQUIRE(cursor.read_word() == "bcde");
+        cursor.move_to_next_word();
+
+        REQUIRE_FALSE(cursor.has_word());
+    }
+    SECTION("Cursor can be reused") {
+        auto cursor2 = cursor;
+        cursor.move_to_next_word();
+        REQUIRE(cursor2.read_word() == "abcd");
+        cursor.move_to_next_word();
+        REQUIRE(cursor2.read_word() == "abcd");
+        cursor.move_to_next_word();
+        REQUIRE(cursor2.read_word() == "abcd");
+        cursor2.move_to_next_word();
+        REQUIRE(cursor2.read_word() == "aceg");
+    }
+    SECTION("Empty string handling") {
+        trie yes({ "", "a", "b", "aaa", "aab" });
+        auto cursor = yes.get_word_cursor();
+        REQUIRE(cursor.read_word() == "");
+        trie no({ "a", "b", "aaa", "aab" });
+        cursor = no.get_word_cursor();
+        REQUIRE(cursor.read_word() == "a");
+    }
+}
+
+TEST_CASE("Cursor -- seek and range scans") {
+    trie t({ "bcde", "ab", "abcd", "adgj", "aceg", "b" });
+    auto cursor = t.get_word_cursor();
+    auto read_range = [&] (const std::string& from, const std::string& to) {
+        std::vector<std::string> words;
+        for (cursor.seek(from); cursor.has_word() && cursor.word() < to; cursor.move_to_next_word()) {
+            words.emplace_back(cursor.word());
+        }
+        return words;
+    };
+    SECTION("Words are visited in lexicographical order") {
+        REQUIRE(read_range("", "~") == as_vec({ "ab", "abcd", "aceg", "adgj", "b", "bcde" }));
+    }
+    SECTION("Seek to a word") {
+        cursor.seek("aceg");
+        REQUIRE(cursor.word() == "aceg");
+        cursor.seek("ab");
+        REQUIRE(cursor.word() == "ab");
+    }
+    SECTION("Seek between words") {
+        cursor.seek("abd");
+        REQUIRE(cursor.word() == "aceg");
+        cursor.seek("a");
+        REQUIRE(cursor.word() == "ab");
+        cursor.seek("ba");
+        REQUIRE(cursor.word() == "bcde");
+        cursor.seek("bd");
+        REQUIRE_FALSE(cursor.has_word());
+        cursor.seek("");
+        REQUIRE(cursor.word() == "ab");
+    }
+    SECTION("Skip subtree") {
+        cursor.seek("ab");
+        cursor.skip_subtree();
+        REQUIRE(cursor.word() == "aceg");
+        cursor.seek("b");
+        cursor.skip_subtree();
+        REQUIRE_FALSE(cursor.has_word());
+    }
+    SECTION("Range scans are half-open") {
+        REQUIRE(read_range("abcd", "adgj") == as_vec({ "abcd", "aceg" }));
+        REQUIRE(read_range("ac", "b") == as_vec({ "aceg", "adgj" }));
+        REQUIRE(read_range("c", "d").empty());
+    }
+    SECTION("Merge-join of two tries") {
+        trie other({ "aceg", "b", "bcd", "bcde", "zzz" });
+        auto lhs = t.get_word_cursor();
+        auto rhs = other.get_word_cursor();
+        std::vector<std::string> common;
+        while (lhs.has_word() && rhs.has_word()) {
+            if (lhs.word() < rhs.word()) {
+                lhs.seek(rhs.word());
+            } else if (rhs.word() < lhs.word()) {
+                rhs.seek(lhs.word());
+            } else {
+                common.emplace_back(lhs.word());
+                lhs.move_to_next_word();
+                rhs.move_to_next_word();
+            }
+        }
+        REQUIRE(common == as_vec({ "aceg", "b", "bcde" }));
+    }
+    SECTION("Empty string is the smallest word") {
+        trie with_empty({ "a", "" });
+        auto c = with_empty.get_word_cursor();
+        c.seek("");
+        REQUIRE(c.has_word());
+        REQUIRE(c.word() == "");
+        c.move_to_next_word();
+        REQUIRE(c.word() == "a");
+    }
+}
+
+TEST_CASE("Search by prefix") {
+    trie trie;
+    auto elems = std::vector<std::string>{ "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" };
+    insert_all(trie, elems);
+    SECTION("Search is inclusive") {
+        VALIDATE_SETS(trie.search_by_prefix("aa"), as_vec({ "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" }));
+    }
+    SECTION("Prefix not in the trie") {
+        VALIDATE_SETS(trie.search_by_prefix(""), elems);
+    }
+}
+
+TEST_CASE("Get prefixes") {
+    trie trie;
+    insert_all(trie, { "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
+    SECTION("Search is inclusive") {
+        VALIDATE_SETS(trie.get_prefixes("aabab"), as_vec({ "aa", "a", "aabab" }));
+    }
+    SECTION("Input is not in the trie") {
+        VALIDATE_SETS(trie.get_prefixes("aaaaa"), as_vec({ "a", "aa", "aaa" }));
+    }
+}
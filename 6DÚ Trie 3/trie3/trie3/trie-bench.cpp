@@ -0,0 +1,657 @@
+#include "trie.hpp"
+#include "trie-bench.hpp"
+#include "trie-dawg.hpp"
+#include "trie-labels.hpp"
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <utility>
+
+namespace {
+    const char generation[] = "trie3";
+
+    // Queries that take time proportional to the size of the result are limited to this many calls
+    const size_t max_queries = 1'000;
+    // Queries answered by scanning all strings are limited to this many calls
+    const size_t max_scans = 100;
+
+    // Stands in for an English word list: random stems with common inflections
+    const bench::distribution inflected = { "inflected", 3, 8, "abcdefghijklmnopqrstuvwxyz", "" };
+    const char* const endings[] = { "", "s", "ed", "ing", "er", "ers", "ly", "ness" };
+
+    std::vector<std::string> generate_inflected(size_t size) {
+        std::vector<std::string> words;
+        for (const auto& stem : bench::generate_corpus(inflected, size / (sizeof(endings) / sizeof(endings[0])))) {
+            for (const char* ending : endings) {
+                words.push_back(stem + ending);
+            }
+        }
+        return words;
+    }
+
+    /*
+     * Times f (which processes given number of bytes) a few times and prints the best throughput.
+     */
+    template <typename Function>
+    void report_throughput(const std::string& name, size_t bytes, Function f) {
+        double best = 0;
+        for (size_t run = 0; run < bench::min_runs; ++run) {
+            double seconds = f();
+            best = run ? std::min(best, seconds) : seconds;
+        }
+        std::printf("%-48s %14.1f MB/s\n", name.c_str(), bytes / best / 1e6);
+        std::fflush(stdout);
+    }
+
+    // Parents with the same number of children each, and lookups of (parent, character)
+    struct child_search_setup {
+        std::vector<trie_node> parents;
+        std::vector<std::unique_ptr<trie_node>> children;
+        std::vector<std::pair<size_t, char>> lookups;
+    };
+
+    child_search_setup make_child_search(size_t fan_out, size_t parent_count, size_t lookup_count) {
+        child_search_setup setup;
+        std::mt19937 gen(static_cast<unsigned>(fan_out));
+        std::vector<char> all(num_chars);
+        for (size_t c = 0; c < num_chars; ++c) {
+            all[c] = static_cast<char>(c);
+        }
+
+        setup.parents.resize(parent_count);
+        for (auto& parent : setup.parents) {
+            std::shuffle(all.begin(), all.end(), gen);
+            std::sort(all.begin(), all.begin() + fan_out);
+            for (size_t i = 0; i < fan_out; ++i) {
+                setup.children.emplace_back(new trie_node);
+                setup.children.back()->payload = all[i];
+                parent.children[i] = setup.children.back().get();
+                parent.labels[i] = all[i];
+            }
+            parent.child_count = static_cast<std::uint8_t>(fan_out);
+        }
+
+        // half of the lookups find a child, the other half look for a random character
+        std::uniform_int_distribution<size_t> parent(0, parent_count - 1);
+        std::uniform_int_distribution<size_t> slot(0, fan_out - 1);
+        std::uniform_int_distribution<int> character(0, num_chars - 1);
+        for (size_t i = 0; i < lookup_count; ++i) {
+            size_t p = parent(gen);
+            char c = i % 2 ? setup.parents[p].labels[slot(gen)] : static_cast<char>(character(gen));
+            setup.lookups.push_back({ p, c });
+        }
+        return setup;
+    }
+
+    /*
+     * Prints time per lookup of find(node, character), which returns the child or nullptr.
+     */
+    template <typename Find>
+    void report_child_search(const char* variant, size_t fan_out, const child_search_setup& setup, Find find) {
+        std::string name = std::string(generation) + "/child_search/" + variant + '/' + std::to_string(fan_out);
+        bench::run(name, setup.lookups.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& lookup : setup.lookups) {
+                    found += find(setup.parents[lookup.first], lookup.second) != nullptr;
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    }
+
+    void report_dawg(const std::string& name, const trie& t) {
+        dawg d(t);
+        std::printf("%-48s %8zu -> %8zu nodes %10zu -> %8zu bytes (%.1fx)\n", name.c_str(),
+            d.source_node_count(), d.node_count(), d.source_memory_usage(), d.memory_usage(),
+            double(d.source_memory_usage()) / d.memory_usage());
+
+        std::vector<std::string> words(t.begin(), t.end());
+        bench::run(name + "/contains", words.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    found += d.contains(word);
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    }
+}
+
+TEST_CASE("Benchmark: insert", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "insert", dist, size), words.size(), [&] {
+            trie t;
+            return bench::time_it([&] {
+                for (const auto& word : words) {
+                    t.insert(word);
+                }
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: contains", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        auto misses = bench::generate_misses(dist, size);
+        bench::run(bench::name(generation, "contains", dist, size), words.size() + misses.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    found += t.contains(word);
+                }
+                for (const auto& word : misses) {
+                    found += t.contains(word);
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: contains_many", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        // half of the keys are in the trie, in random order
+        trie t{ words };
+        auto keys = words;
+        auto misses = bench::generate_misses(dist, size);
+        keys.insert(keys.end(), misses.begin(), misses.end());
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{});
+        for (size_t batch_size : { 1, 8, 32, 128 }) {
+            std::string operation = "contains_many(" + std::to_string(batch_size) + ")";
+            bench::run(bench::name(generation, operation.c_str(), dist, size), keys.size(), [&] {
+                return bench::time_it([&] {
+                    auto found = t.contains_many(keys, batch_size);
+                    bench::do_not_optimize(static_cast<size_t>(std::count(found.begin(), found.end(), true)));
+                });
+            });
+        }
+    });
+}
+
+TEST_CASE("Benchmark: erase", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "erase", dist, size), words.size(), [&] {
+            trie t{ words };
+            return bench::time_it([&] {
+                for (const auto& word : words) {
+                    t.erase(word);
+                }
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: search_by_prefix", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        auto prefixes = bench::shortened(words, 2, max_queries);
+        bench::run(bench::name(generation, "search_by_prefix", dist, size), prefixes.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& prefix : prefixes) {
+                    found += t.search_by_prefix(prefix).size();
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: get_prefixes", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ bench::shortened(words, 2, words.size()) };
+        bench::run(bench::name(generation, "get_prefixes", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    found += t.get_prefixes(word).size();
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: get_prefix_lengths", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ bench::shortened(words, 2, words.size()) };
+        std::vector<size_t> lengths;
+        bench::run(bench::name(generation, "get_prefix_lengths", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                size_t found = 0;
+                for (const auto& word : words) {
+                    t.get_prefix_lengths(word, lengths);
+                    found += lengths.size();
+                }
+                bench::do_not_optimize(found);
+            });
+        });
+        bench::run(bench::name(generation, "longest_prefix", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                size_t length = 0;
+                for (const auto& word : words) {
+                    length += t.longest_prefix(word);
+                }
+                bench::do_not_optimize(length);
+            });
+        });
+
+        // greedy longest-match tokenizer over the words glued together, timed per character
+        std::string text;
+        for (const auto& word : words) {
+            text += word;
+        }
+        size_t calls = 0;
+        bench::run(bench::name(generation, "tokenize", dist, size), text.size(), [&] {
+            return bench::time_it([&] {
+                calls = 0;
+                for (size_t pos = 0; pos < text.size(); ++calls) {
+                    pos += std::max<size_t>(t.longest_prefix(text, pos), 1);
+                }
+                bench::do_not_optimize(calls);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: search_by_suffix", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        std::vector<std::string> suffixes;
+        for (size_t i = 0; i < words.size() && i < max_queries; ++i) {
+            suffixes.push_back(words[i].substr(words[i].size() - 3));
+        }
+        for (auto mode : { trie_index_mode::none, trie_index_mode::reversed }) {
+            t.set_index_mode(mode);
+            size_t queries = mode == trie_index_mode::none ? std::min(suffixes.size(), max_scans) : suffixes.size();
+            const char* operation = mode == trie_index_mode::none ? "search_by_suffix(scan)" : "search_by_suffix(reversed)";
+            bench::run(bench::name(generation, operation, dist, size), queries, [&] {
+                return bench::time_it([&] {
+                    size_t found = 0;
+                    for (size_t i = 0; i < queries; ++i) {
+                        found += t.search_by_suffix(suffixes[i]).size();
+                    }
+                    bench::do_not_optimize(found);
+                });
+            });
+        }
+    });
+}
+
+TEST_CASE("Benchmark: search_by_substring", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        // The suffix index needs a node per distinct substring, larger corpora do not fit into memory
+        if (size > 1'000) {
+            return;
+        }
+        trie t{ words };
+        std::vector<std::string> substrings;
+        for (size_t i = 0; i < words.size() && i < max_queries; ++i) {
+            substrings.push_back(words[i].substr(words[i].size() / 2 - 1, 3));
+        }
+        for (auto mode : { trie_index_mode::none, trie_index_mode::suffixes }) {
+            t.set_index_mode(mode);
+            size_t queries = mode == trie_index_mode::none ? std::min(substrings.size(), max_scans) : substrings.size();
+            const char* operation = mode == trie_index_mode::none ? "search_by_substring(scan)" : "search_by_substring(suffixes)";
+            bench::run(bench::name(generation, operation, dist, size), queries, [&] {
+                return bench::time_it([&] {
+                    size_t found = 0;
+                    for (size_t i = 0; i < queries; ++i) {
+                        found += t.search_by_substring(substrings[i]).size();
+                    }
+                    bench::do_not_optimize(found);
+                });
+            });
+        }
+    });
+}
+
+TEST_CASE("Benchmark: iteration", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        bench::run(bench::name(generation, "iteration", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                size_t length = 0;
+                for (auto it = t.begin(); it != t.end(); ++it) {
+                    length += (*it).size();
+                }
+                bench::do_not_optimize(length);
+            });
+        });
+    });
+}
+
+/*
+ * Reading one page of words at the start, the middle and the end of the sorted words,
+ * by advancing an iterator from begin() and by select.
+ */
+TEST_CASE("Benchmark: pages", "[.bench]") {
+    const size_t page_size = 20;
+
+    bench::for_each_corpus([&] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        const std::pair<const char*, size_t> pages[] = { { "first", 0 }, { "middle", size / 2 }, { "last", size - page_size } };
+        for (const auto& page : pages) {
+            std::string operation = std::string("page(") + page.first + ")";
+            bench::run(bench::name(generation, (operation + "/iterate").c_str(), dist, size), page_size, [&] {
+                return bench::time_it([&] {
+                    auto it = t.begin();
+                    std::advance(it, page.second);
+                    size_t length = 0;
+                    for (size_t i = 0; i < page_size; ++i, ++it) {
+                        length += (*it).size();
+                    }
+                    bench::do_not_optimize(length);
+                });
+            });
+            bench::run(bench::name(generation, (operation + "/select").c_str(), dist, size), page_size, [&] {
+                return bench::time_it([&] {
+                    size_t length = 0;
+                    for (size_t i = 0; i < page_size; ++i) {
+                        length += t.select(page.second + i).size();
+                    }
+                    bench::do_not_optimize(length);
+                });
+            });
+        }
+    });
+}
+
+TEST_CASE("Benchmark: copy", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        bench::run(bench::name(generation, "copy", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                trie copy(t);
+                bench::do_not_optimize(copy.size());
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: move", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        bench::run(bench::name(generation, "move", dist, size), words.size(), [&] {
+            trie t{ words };
+            trie* moved = nullptr;
+            double seconds = bench::time_it([&] {
+                moved = new trie(std::move(t));
+            });
+            delete moved;
+            return seconds;
+        });
+    });
+}
+
+TEST_CASE("Benchmark: snapshot", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        std::ostringstream out;
+        t.save(out);
+        const std::string snapshot = out.str();
+
+        report_throughput(bench::name(generation, "snapshot(save)", dist, size), snapshot.size(), [&] {
+            std::ostringstream saved;
+            return bench::time_it([&] {
+                t.save(saved);
+            });
+        });
+        report_throughput(bench::name(generation, "snapshot(load)", dist, size), snapshot.size(), [&] {
+            std::istringstream in(snapshot);
+            trie loaded;
+            return bench::time_it([&] {
+                loaded.load(in);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: dawg", "[.bench]") {
+    for (size_t size : bench::corpus_sizes) {
+        trie t{ generate_inflected(size) };
+        report_dawg(bench::name(generation, "dawg", inflected, size), t);
+    }
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        report_dawg(bench::name(generation, "dawg", dist, size), t);
+    });
+}
+
+TEST_CASE("Benchmark: diff", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        // replicas receive an update that replaces 1 % of the words
+        size_t changed = size / 100;
+        auto newer_words = std::vector<std::string>(words.begin() + changed, words.end());
+        auto added = bench::generate_misses(dist, changed);
+        newer_words.insert(newer_words.end(), added.begin(), added.end());
+        trie older{ words };
+        trie newer{ newer_words };
+
+        std::ostringstream snapshot;
+        newer.save(snapshot);
+        std::ostringstream encoded;
+        older.diff(newer).save(encoded);
+        std::printf("%-48s %8zu bytes snapshot %8zu bytes diff\n", bench::name(generation, "diff", dist, size).c_str(),
+            snapshot.str().size(), encoded.str().size());
+
+        bench::run(bench::name(generation, "diff(compute)", dist, size), 1, [&] {
+            return bench::time_it([&] {
+                bench::do_not_optimize(older.diff(newer).added.size());
+            });
+        });
+        bench::run(bench::name(generation, "diff(apply)", dist, size), 1, [&] {
+            trie replica(older);
+            std::istringstream in(encoded.str());
+            return bench::time_it([&] {
+                trie_diff diff;
+                diff.load(in);
+                replica.apply_diff(diff);
+            });
+        });
+        bench::run(bench::name(generation, "diff(load snapshot)", dist, size), 1, [&] {
+            trie replica;
+            std::istringstream in(snapshot.str());
+            return bench::time_it([&] {
+                replica.load(in);
+            });
+        });
+    });
+}
+
+TEST_CASE("Benchmark: ingest", "[.bench]") {
+    const size_t text_size = 32 << 20;
+    const size_t parts = 8;
+    const char* const separators[] = { " ", " ", " ", ", ", ". ", "\n" };
+
+    for (size_t size : bench::corpus_sizes) {
+        // log-like text, tokens drawn from a vocabulary of size words
+        auto vocabulary = bench::generate_corpus(bench::distributions[0], size);
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<size_t> word(0, vocabulary.size() - 1);
+        std::uniform_int_distribution<size_t> separator(0, sizeof(separators) / sizeof(separators[0]) - 1);
+        std::vector<std::string> texts(parts);
+        for (auto& text : texts) {
+            while (text.size() < text_size / parts) {
+                text += vocabulary[word(gen)];
+                text += separators[separator(gen)];
+            }
+        }
+
+        report_throughput(bench::name(generation, "ingest", bench::distributions[0], size), text_size, [&] {
+            trie t;
+            return bench::time_it([&] {
+                for (const auto& text : texts) {
+                    std::istringstream in(text);
+                    t.ingest(in);
+                }
+            });
+        });
+        for (size_t threads : { 1, 2, 4, 8 }) {
+            std::string operation = "ingest_parallel(" + std::to_string(threads) + ")";
+            report_throughput(bench::name(generation, operation.c_str(), bench::distributions[0], size), text_size, [&] {
+                std::vector<std::unique_ptr<std::istringstream>> streams;
+                std::vector<std::istream*> inputs;
+                for (const auto& text : texts) {
+                    streams.emplace_back(new std::istringstream(text));
+                    inputs.push_back(streams.back().get());
+                }
+                trie t;
+                return bench::time_it([&] {
+                    t.ingest_parallel(inputs, threads);
+                });
+            });
+        }
+    }
+}
+
+/*
+ * Cost of finding one child in a node, without the rest of the trie around.
+ * "payloads" is the search before nodes kept labels of their children,
+ * it reads the payload of every child it passes.
+ */
+TEST_CASE("Benchmark: child search", "[.bench]") {
+    for (size_t fan_out : { 4, 16, 48 }) {
+        auto setup = make_child_search(fan_out, 64, 1 << 20);
+
+        report_child_search("payloads", fan_out, setup, [] (const trie_node& node, char c) -> const trie_node* {
+            for (size_t i = 0; i < num_chars && node.children[i]; i++) {
+                if (node.children[i]->payload == c) {
+                    return node.children[i];
+                }
+            }
+            return nullptr;
+        });
+        report_child_search("scalar", fan_out, setup, [] (const trie_node& node, char c) -> const trie_node* {
+            int i = labels::find_scalar(node.labels, node.child_count, c);
+            return i < 0 ? nullptr : node.children[i];
+        });
+#ifdef TRIE_LABELS_SSE2
+        report_child_search("sse2", fan_out, setup, [] (const trie_node& node, char c) -> const trie_node* {
+            int i = labels::find_sse2(node.labels, node.child_count, c);
+            return i < 0 ? nullptr : node.children[i];
+        });
+#endif
+#ifdef TRIE_LABELS_AVX2
+        report_child_search("avx2", fan_out, setup, [] (const trie_node& node, char c) -> const trie_node* {
+            int i = labels::find_avx2(node.labels, node.child_count, c);
+            return i < 0 ? nullptr : node.children[i];
+        });
+#endif
+    }
+}
+
+/*
+ * Prints memory usage of every corpus, then times lookups and iteration
+ * before and after shrink_to_fit lays the nodes out in depth-first order.
+ */
+TEST_CASE("Benchmark: memory", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        trie t{ words };
+        auto usage = t.memory_usage();
+        std::printf("%-48s %8zu nodes %10.1f MB %6.2f fan-out %4zu levels\n", bench::name(generation, "memory", dist, size).c_str(),
+            usage.node_count, usage.total_bytes() / 1e6, usage.average_fan_out, usage.depth_histogram.size());
+
+        auto measure = [&] (const char* when) {
+            bench::run(bench::name(generation, (std::string("contains/") + when).c_str(), dist, size), words.size(), [&] {
+                return bench::time_it([&] {
+                    size_t found = 0;
+                    for (const auto& word : words) {
+                        found += t.contains(word);
+                    }
+                    bench::do_not_optimize(found);
+                });
+            });
+            bench::run(bench::name(generation, (std::string("iteration/") + when).c_str(), dist, size), words.size(), [&] {
+                return bench::time_it([&] {
+                    size_t length = 0;
+                    for (const auto& word : t) {
+                        length += word.size();
+                    }
+                    bench::do_not_optimize(length);
+                });
+            });
+        };
+
+        measure("before_shrink");
+        std::printf("%-48s %14.1f ms\n", bench::name(generation, "shrink_to_fit", dist, size).c_str(),
+            bench::time_it([&] { t.shrink_to_fit(); }) * 1e3);
+        measure("after_shrink");
+    });
+}
+
+/*
+ * Merges per-thread tries into one: 8 tries with a sixteenth of the words
+ * each on their own plus another sixteenth shared by all of them.
+ */
+TEST_CASE("Benchmark: merge", "[.bench]") {
+    const size_t shard_count = 8;
+
+    bench::for_each_corpus([&] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        std::vector<std::vector<std::string>> shard_words(shard_count);
+        size_t total = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            for (size_t shard = 0; shard < shard_count; ++shard) {
+                if (i % 16 == shard || i % 16 == shard_count) {
+                    shard_words[shard].push_back(words[i]);
+                    ++total;
+                }
+            }
+        }
+
+        auto report = [&] (const char* operation, void (*merge)(trie& result, trie& shard)) {
+            bench::run(bench::name(generation, operation, dist, size), total, [&] {
+                std::vector<trie> shards;
+                for (const auto& part : shard_words) {
+                    shards.emplace_back(part);
+                }
+                trie result;
+                return bench::time_it([&] {
+                    for (auto& shard : shards) {
+                        merge(result, shard);
+                    }
+                });
+            });
+        };
+
+        report("merge/operator|", [] (trie& result, trie& shard) { result = result | shard; });
+        report("merge/operator|=", [] (trie& result, trie& shard) { result |= shard; });
+        report("merge/merge_from", [] (trie& result, trie& shard) { result.merge_from(std::move(shard)); });
+    });
+}
+
+TEST_CASE("Benchmark: intersection", "[.bench]") {
+    bench::for_each_corpus([] (const bench::distribution& dist, size_t size, const std::vector<std::string>& words) {
+        // Half of the corpus, and as many words that are not in it
+        std::vector<std::string> other;
+        for (size_t i = 0; i < words.size(); i += 2) {
+            other.push_back(words[i]);
+        }
+        auto misses = bench::generate_misses(dist, words.size() / 2);
+        other.insert(other.end(), misses.begin(), misses.end());
+
+        trie lhs{ words };
+        trie rhs{ other };
+        bench::run(bench::name(generation, "intersection/operator&", dist, size), words.size(), [&] {
+            return bench::time_it([&] {
+                trie result = lhs & rhs;
+                bench::do_not_optimize(result.size());
+            });
+        });
+        bench::run(bench::name(generation, "intersection/operator&=", dist, size), words.size(), [&] {
+            trie result(lhs);
+            return bench::time_it([&] {
+                result &= rhs;
+                bench::do_not_optimize(result.size());
+            });
+        });
+    });
+}
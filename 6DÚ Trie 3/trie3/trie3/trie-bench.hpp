@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Benchmark helpers shared by all trie generations.
+ *
+ * Trie 1, 2 and 3 keep identical copies of this file, so that their
+ * trie-bench.cpp run the same workloads and print comparable lines:
+ *
+ *     <generation>/<operation>/<distribution>/<corpus size>   <ns per op>   <runs>
+ *
+ * Benchmarks are hidden test cases tagged [.bench] in every generation's
+ * test executable, run them with e.g.
+ *
+ *     trie3.exe [.bench]
+ */
+namespace bench {
+
+    struct distribution {
+        const char* name;
+        size_t min_length;
+        size_t max_length;
+        const char* alphabet;
+        // every word starts with it, makes long shared chains of nodes
+        const char* prefix;
+    };
+
+    static const distribution distributions[] = {
+        { "short", 3, 8, "abcdefghijklmnopqrstuvwxyz", "" },
+        { "random20", 20, 20, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUWXYZ0123456789,.:;/\\\"'", "" },
+        { "prefixed", 4, 8, "abcdefghijklmnopqrstuvwxyz", "http://example.com/" },
+    };
+
+    static const size_t corpus_sizes[] = { 1'000, 10'000, 20'000 };
+
+    // Runs shorter than this are repeated, the fastest run is reported
+    static const double min_total_seconds = 0.5;
+    static const size_t min_runs = 3;
+    static const size_t max_runs = 50;
+
+    /*
+     * Returns size unique words drawn from given distribution.
+     * The result only depends on the distribution, size and seed.
+     */
+    inline std::vector<std::string> generate_corpus(const distribution& dist, size_t size, unsigned seed = 42) {
+        std::mt19937 gen(seed);
+        const std::string alphabet = dist.alphabet;
+        std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+        std::uniform_int_distribution<size_t> length(dist.min_length, dist.max_length);
+
+        std::unordered_set<std::string> seen;
+        std::vector<std::string> words;
+        words.reserve(size);
+        while (words.size() < size) {
+            std::string word = dist.prefix;
+            for (size_t len = length(gen); len > 0; --len) {
+                word.push_back(alphabet[letter(gen)]);
+            }
+            if (seen.insert(word).second) {
+                words.push_back(std::move(word));
+            }
+        }
+        return words;
+    }
+
+    /*
+     * Returns words that are (most likely) not in the corpus of the same distribution.
+     */
+    inline std::vector<std::string> generate_misses(const distribution& dist, size_t size) {
+        return generate_corpus(dist, size, 1234);
+    }
+
+    /*
+     * Runs f once and returns how long it took, in seconds.
+     */
+    template <typename Function>
+    double time_it(Function f) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        f();
+        auto end_time = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end_time - start_time).count();
+    }
+
+    // Keeps the compiler from optimizing away results of benchmarked calls
+    inline void do_not_optimize(size_t value) {
+        static volatile size_t sink;
+        sink = value;
+        (void)sink;
+    }
+
+    /*
+     * Calls measure repeatedly and prints the fastest time per operation.
+     * measure performs ops operations and returns how many seconds the measured part took,
+     * which lets it exclude its own set-up (usually done by time_it).
+     */
+    template <typename Run>
+    void run(const std::string& name, size_t ops, Run measure) {
+        double best = 0;
+        double total = 0;
+        size_t runs = 0;
+        while (runs < min_runs || (total < min_total_seconds && runs < max_runs)) {
+            double seconds = measure();
+            best = runs ? std::min(best, seconds) : seconds;
+            total += seconds;
+            ++runs;
+        }
+        std::printf("%-48s %14.1f ns/op %6zu runs\n", name.c_str(), best * 1e9 / ops, runs);
+        std::fflush(stdout);
+    }
+
+    /*
+     * Calls f(distribution, corpus size, corpus) for every distribution and corpus size.
+     */
+    template <typename Function>
+    void for_each_corpus(Function f) {
+        for (const auto& dist : distributions) {
+            for (size_t size : corpus_sizes) {
+                f(dist, size, generate_corpus(dist, size));
+            }
+        }
+    }
+
+    /*
+     * Returns the first words (at most max_count of them), each without its last cut characters.
+     */
+    inline std::vector<std::string> shortened(const std::vector<std::string>& words, size_t cut, size_t max_count) {
+        std::vector<std::string> result;
+        for (size_t i = 0; i < words.size() && i < max_count; ++i) {
+            result.push_back(words[i].substr(0, words[i].size() - std::min(cut, words[i].size())));
+        }
+        return result;
+    }
+
+    inline std::string name(const char* generation, const char* operation, const distribution& dist, size_t size) {
+        return std::string(generation) + '/' + operation + '/' + dist.name + '/' + std::to_string(size);
+    }
+}
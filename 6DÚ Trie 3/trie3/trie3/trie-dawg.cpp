@@ -0,0 +1,286 @@
+#include "trie-dawg.hpp"
+
+using namespace std;
+
+
+dawg::dawg()
+{
+	m_states.push_back(state());
+}
+
+
+dawg::dawg(const trie& source)
+{
+	registry states;
+
+	// Empty string is kept in the root of the trie instead of a terminal node
+	m_root = add_state(source.m_root, source.m_root->payload == ' ', states);
+	m_size = source.m_size;
+
+	m_states.shrink_to_fit();
+	m_edges.shrink_to_fit();
+}
+
+
+// Adds states of the whole subtree of node, children first. State is identified
+// by whether it is terminal and by labels and targets of its edges, children were
+// already merged, so equal signatures mean equal sets of words below the states.
+uint32_t dawg::add_state(const trie_node * node, bool is_terminal, registry & states)
+{
+	m_source_nodes++;
+
+	string signature(1, is_terminal ? '1' : '0');
+	vector<edge> edges;
+
+	for (size_t i = 0; i < num_chars && node->children[i]; i++)
+	{
+		const trie_node * child = node->children[i];
+		uint32_t target = add_state(child, child->is_terminal, states);
+
+		edges.push_back({ target, child->payload });
+		signature.push_back(child->payload);
+		signature.append(reinterpret_cast<const char *>(&target), sizeof(target));
+	}
+
+	auto found = states.find(signature);
+
+	if (found != states.end())
+	{
+		return found->second;
+	}
+
+	state added;
+	added.first_edge = static_cast<uint32_t>(m_edges.size());
+	added.edge_count = static_cast<uint32_t>(edges.size());
+	added.is_terminal = is_terminal;
+
+	m_edges.insert(m_edges.end(), edges.begin(), edges.end());
+	m_states.push_back(added);
+
+	uint32_t index = static_cast<uint32_t>(m_states.size() - 1);
+	states.emplace(move(signature), index);
+	return index;
+}
+
+
+const dawg::edge * dawg::find_edge(uint32_t state, char label) const
+{
+	const auto & current = m_states[state];
+
+	for (uint32_t i = current.first_edge; i < current.first_edge + current.edge_count; i++)
+	{
+		if (m_edges[i].label == label)
+		{
+			return &m_edges[i];
+		}
+	}
+
+	return nullptr;
+}
+
+
+void dawg::collect(uint32_t state, string & word, vector<string> & words) const
+{
+	const auto & current = m_states[state];
+
+	if (current.is_terminal)
+	{
+		words.push_back(word);
+	}
+
+	for (uint32_t i = current.first_edge; i < current.first_edge + current.edge_count; i++)
+	{
+		word.push_back(m_edges[i].label);
+		collect(m_edges[i].target, word, words);
+		word.pop_back();
+	}
+}
+
+
+bool dawg::contains(const string& str) const
+{
+	uint32_t current = m_root;
+
+	for (char c : str)
+	{
+		const edge * next = find_edge(current, c);
+
+		if (next == nullptr)
+		{
+			return false;
+		}
+
+		current = next->target;
+	}
+
+	return m_states[current].is_terminal;
+}
+
+
+size_t dawg::size() const
+{
+	return m_size;
+}
+
+
+bool dawg::empty() const
+{
+	return m_size == 0;
+}
+
+
+vector<string> dawg::search_by_prefix(const string& prefix) const
+{
+	vector<string> words;
+	uint32_t current = m_root;
+
+	for (char c : prefix)
+	{
+		const edge * next = find_edge(current, c);
+
+		if (next == nullptr)
+		{
+			return words;
+		}
+
+		current = next->target;
+	}
+
+	string word = prefix;
+	collect(current, word, words);
+	return words;
+}
+
+
+dawg::const_iterator dawg::begin() const
+{
+	return const_iterator(this);
+}
+
+
+dawg::const_iterator dawg::end() const
+{
+	return const_iterator();
+}
+
+
+size_t dawg::node_count() const
+{
+	return m_states.size();
+}
+
+
+size_t dawg::edge_count() const
+{
+	return m_edges.size();
+}
+
+
+size_t dawg::memory_usage() const
+{
+	return sizeof(dawg) + m_states.capacity() * sizeof(state) + m_edges.capacity() * sizeof(edge);
+}
+
+
+size_t dawg::source_node_count() const
+{
+	return m_source_nodes;
+}
+
+
+size_t dawg::source_memory_usage() const
+{
+	return m_source_nodes * sizeof(trie_node);
+}
+
+
+//
+// CONST ITERATOR
+
+dawg::const_iterator::const_iterator(const dawg* graph)
+	:graph(graph)
+{
+	const auto & root = graph->m_states[graph->m_root];
+	path.push_back({ graph->m_root, root.first_edge });
+
+	if (!root.is_terminal)
+	{
+		move_to_next_word();
+	}
+}
+
+
+// Continues the depth-first walk until it reaches the next terminal state,
+// becomes the end iterator once the walk returns above the root
+void dawg::const_iterator::move_to_next_word()
+{
+	while (!path.empty())
+	{
+		frame & top = path.back();
+		const auto & current = graph->m_states[top.state];
+
+		if (top.edge < current.first_edge + current.edge_count)
+		{
+			const auto & next = graph->m_edges[top.edge++];
+			const auto & target = graph->m_states[next.target];
+
+			path.push_back({ next.target, target.first_edge });
+			word.push_back(next.label);
+
+			if (target.is_terminal)
+			{
+				return;
+			}
+		}
+		else
+		{
+			path.pop_back();
+
+			if (!path.empty())
+			{
+				word.pop_back();
+			}
+		}
+	}
+
+	graph = nullptr;
+}
+
+
+dawg::const_iterator& dawg::const_iterator::operator++()
+{
+	move_to_next_word();
+	return *this;
+}
+
+
+dawg::const_iterator dawg::const_iterator::operator++(int)
+{
+	const_iterator old = *this;
+	operator++();
+	return old;
+}
+
+
+dawg::const_iterator::reference dawg::const_iterator::operator*() const
+{
+	return word;
+}
+
+
+dawg::const_iterator::pointer dawg::const_iterator::operator->() const
+{
+	return &word;
+}
+
+
+bool dawg::const_iterator::operator==(const dawg::const_iterator& rhs) const
+{
+	return graph == rhs.graph && path.size() == rhs.path.size() && word == rhs.word;
+}
+
+
+bool dawg::const_iterator::operator!=(const dawg::const_iterator& rhs) const
+{
+	return !(*this == rhs);
+}
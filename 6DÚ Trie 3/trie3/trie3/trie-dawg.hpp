@@ -0,0 +1,132 @@
+#pragma once
+
+#include "trie.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Directed acyclic word graph, a minimal automaton built from a trie.
+ *
+ * Subtrees of the trie that hold the same words (e.g. the "-ing", "-ed",
+ * "-s" endings of many words) are merged into a single state, so every
+ * shared suffix is stored only once. The graph is a read-only snapshot,
+ * changes to the trie are not reflected in it.
+ */
+class dawg {
+    struct state {
+        std::uint32_t first_edge = 0;
+        std::uint32_t edge_count = 0;
+        bool is_terminal = false;
+    };
+
+    struct edge {
+        std::uint32_t target;
+        char label;
+    };
+
+public:
+
+    class const_iterator {
+        struct frame {
+            std::uint32_t state;
+            // next edge of the state to follow
+            std::uint32_t edge;
+        };
+
+        const dawg* graph = nullptr;
+        std::vector<frame> path;
+        std::string word;
+
+        void move_to_next_word();
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string;
+        using reference = const std::string&;
+        using pointer = const std::string*;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() = default;
+        const_iterator(const dawg* graph);
+
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        reference operator*() const;
+        pointer operator->() const;
+        bool operator==(const const_iterator& rhs) const;
+        bool operator!=(const const_iterator& rhs) const;
+    };
+
+    /**
+     * Constructs graph that contains no strings
+     */
+    dawg();
+
+    /**
+     * Constructs graph that contains the same strings as given trie.
+     */
+    explicit dawg(const trie& source);
+
+    /**
+     * Returns true iff given string is in the graph
+     */
+    bool contains(const std::string& str) const;
+
+    /**
+     * Returns how many unique strings are in the graph
+     */
+    size_t size() const;
+
+    /**
+     * Returns whether the graph is empty (contains no strings)
+     */
+    bool empty() const;
+
+    /**
+     * Returns all strings from the graph that contain given prefix,
+     * in lexicographical order. Prefix is inclusive, same as in trie.
+     */
+    std::vector<std::string> search_by_prefix(const std::string& prefix) const;
+
+    /**
+     * Strings are iterated in lexicographical order.
+     */
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * Returns how many states (nodes) and edges the graph has.
+     */
+    size_t node_count() const;
+    size_t edge_count() const;
+
+    /**
+     * Returns how many bytes the graph occupies, including its own object.
+     */
+    size_t memory_usage() const;
+
+    /**
+     * Returns how many nodes the trie the graph was built from had,
+     * and how many bytes they occupied.
+     */
+    size_t source_node_count() const;
+    size_t source_memory_usage() const;
+
+private:
+    std::vector<state> m_states;
+    std::vector<edge> m_edges;
+    std::uint32_t m_root = 0;
+    size_t m_size = 0;
+    size_t m_source_nodes = 0;
+
+    // Maps signature of every state to its index, so that equivalent states are added only once
+    using registry = std::unordered_map<std::string, std::uint32_t>;
+
+    std::uint32_t add_state(const trie_node* node, bool is_terminal, registry& states);
+    const edge* find_edge(std::uint32_t state, char label) const;
+    void collect(std::uint32_t state, std::string& word, std::vector<std::string>& words) const;
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRIE_LABELS_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRIE_LABELS_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Search in packed arrays of child labels.
+ *
+ * Every trie node keeps payloads of its children in a byte array next to
+ * the child pointers, so looking a child up reads one or two cache lines
+ * of the node instead of dereferencing every child. Arrays are padded to
+ * a multiple of 32 bytes, which lets the vector versions load whole
+ * blocks without checking the end; lanes past count are masked off.
+ *
+ * Search uses AVX2 when the compiler targets it (/arch:AVX2, -mavx2),
+ * else SSE2 (always there on x64), else plain loops. Define
+ * TRIE_SCALAR_LABELS to force the plain loops. Every version the compiler
+ * can target is declared regardless, so that benchmarks can compare them.
+ */
+namespace labels {
+
+    // Labels arrays must be at least this long, rounded up to it
+    static const size_t block_size = 32;
+
+    inline unsigned lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    inline unsigned bit_count(unsigned mask) {
+#if defined(_MSC_VER)
+        // __popcnt needs a newer CPU than SSE2 does
+        unsigned bits = 0;
+        for (; mask; mask &= mask - 1) {
+            ++bits;
+        }
+        return bits;
+#else
+        return __builtin_popcount(mask);
+#endif
+    }
+
+    // Mask of the lanes below count, for a block that starts at given offset
+    inline unsigned lanes_below(size_t count, size_t offset) {
+        size_t lanes = count - offset;
+        return lanes >= 32 ? ~0u : (1u << lanes) - 1;
+    }
+
+    /*
+     * Returns index of c in the first count labels, or -1 if it is not there.
+     */
+    inline int find_scalar(const char* labels, size_t count, char c) {
+        for (size_t i = 0; i < count; ++i) {
+            if (labels[i] == c) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * Returns how many of the first count labels are smaller than c,
+     * i.e. the slot c belongs to. Labels must be sorted as unsigned char.
+     */
+    inline size_t lower_bound_scalar(const char* labels, size_t count, char c) {
+        size_t i = 0;
+        while (i < count && static_cast<unsigned char>(labels[i]) < static_cast<unsigned char>(c)) {
+            ++i;
+        }
+        return i;
+    }
+
+#ifdef TRIE_LABELS_SSE2
+    inline int find_sse2(const char* labels, size_t count, char c) {
+        const __m128i needle = _mm_set1_epi8(c);
+        for (size_t i = 0; i < count; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(labels + i));
+            unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)) & lanes_below(count, i);
+            if (mask) {
+                return static_cast<int>(i + lowest_bit(mask));
+            }
+        }
+        return -1;
+    }
+
+    inline size_t lower_bound_sse2(const char* labels, size_t count, char c) {
+        // label < c iff c - label does not saturate to zero
+        const __m128i needle = _mm_set1_epi8(c);
+        const __m128i zero = _mm_setzero_si128();
+        size_t smaller = 0;
+        for (size_t i = 0; i < count; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(labels + i));
+            __m128i not_smaller = _mm_cmpeq_epi8(_mm_subs_epu8(needle, block), zero);
+            unsigned mask = ~_mm_movemask_epi8(not_smaller) & 0xFFFF & lanes_below(count, i);
+            smaller += bit_count(mask);
+        }
+        return smaller;
+    }
+#endif
+
+#ifdef TRIE_LABELS_AVX2
+    inline int find_avx2(const char* labels, size_t count, char c) {
+        const __m256i needle = _mm256_set1_epi8(c);
+        for (size_t i = 0; i < count; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(labels + i));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))) & lanes_below(count, i);
+            if (mask) {
+                return static_cast<int>(i + lowest_bit(mask));
+            }
+        }
+        return -1;
+    }
+
+    inline size_t lower_bound_avx2(const char* labels, size_t count, char c) {
+        const __m256i needle = _mm256_set1_epi8(c);
+        const __m256i zero = _mm256_setzero_si256();
+        size_t smaller = 0;
+        for (size_t i = 0; i < count; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(labels + i));
+            __m256i not_smaller = _mm256_cmpeq_epi8(_mm256_subs_epu8(needle, block), zero);
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(not_smaller)) & lanes_below(count, i);
+            smaller += bit_count(mask);
+        }
+        return smaller;
+    }
+#endif
+
+    inline int find(const char* labels, size_t count, char c) {
+#if defined(TRIE_SCALAR_LABELS)
+        return find_scalar(labels, count, c);
+#elif defined(TRIE_LABELS_AVX2)
+        return find_avx2(labels, count, c);
+#elif defined(TRIE_LABELS_SSE2)
+        return find_sse2(labels, count, c);
+#else
+        return find_scalar(labels, count, c);
+#endif
+    }
+
+    inline size_t lower_bound(const char* labels, size_t count, char c) {
+#if defined(TRIE_SCALAR_LABELS)
+        return lower_bound_scalar(labels, count, c);
+#elif defined(TRIE_LABELS_AVX2)
+        return lower_bound_avx2(labels, count, c);
+#elif defined(TRIE_LABELS_SSE2)
+        return lower_bound_sse2(labels, count, c);
+#else
+        return lower_bound_scalar(labels, count, c);
+#endif
+    }
+}
@@ -0,0 +1,155 @@
+#include "trie-stats.hpp"
+
+#include <sstream>
+
+using namespace std;
+
+
+void trie_latency_histogram::record(uint64_t nanoseconds)
+{
+	size_t bucket = 0;
+
+	while (nanoseconds > 1 && bucket < bucket_count - 1)
+	{
+		nanoseconds >>= 1;
+		bucket++;
+	}
+
+	buckets[bucket].fetch_add(1, memory_order_relaxed);
+}
+
+
+uint64_t trie_latency_histogram::total() const
+{
+	uint64_t total = 0;
+
+	for (const auto & bucket : buckets)
+	{
+		total += bucket.load(memory_order_relaxed);
+	}
+
+	return total;
+}
+
+
+void trie_statistics::touch_depth(uint64_t depth)
+{
+	uint64_t current = max_depth.load(memory_order_relaxed);
+
+	while (current < depth && !max_depth.compare_exchange_weak(current, depth, memory_order_relaxed))
+	{
+	}
+}
+
+
+trie_latency_histogram& trie_statistics::latency(trie_operation operation)
+{
+	return latencies[static_cast<size_t>(operation)];
+}
+
+
+const trie_latency_histogram& trie_statistics::latency(trie_operation operation) const
+{
+	return latencies[static_cast<size_t>(operation)];
+}
+
+
+void trie_statistics::reset()
+{
+	node_visits = 0;
+	allocations = 0;
+	frees = 0;
+	max_depth = 0;
+
+	for (auto & histogram : latencies)
+	{
+		for (auto & bucket : histogram.buckets)
+		{
+			bucket = 0;
+		}
+	}
+}
+
+
+string trie_statistics::report() const
+{
+	ostringstream out;
+
+	out << "trie statistics" << (trie_instrumentation_enabled ? "" : " (instrumentation disabled)") << '\n';
+	out << "  node visits: " << node_visits << '\n';
+	out << "  allocations: " << allocations << '\n';
+	out << "  frees: " << frees << '\n';
+	out << "  max depth: " << max_depth << '\n';
+
+	for (size_t i = 0; i < trie_operation_count; i++)
+	{
+		const trie_latency_histogram & histogram = latencies[i];
+		out << "  " << to_string(static_cast<trie_operation>(i)) << ": " << histogram.total() << " calls\n";
+
+		for (size_t bucket = 0; bucket < trie_latency_histogram::bucket_count; bucket++)
+		{
+			uint64_t count = histogram.buckets[bucket];
+
+			if (count != 0)
+			{
+				out << "    < " << (uint64_t(1) << (bucket + 1)) << " ns: " << count << '\n';
+			}
+		}
+	}
+
+	return out.str();
+}
+
+
+string trie_statistics::report_json() const
+{
+	ostringstream out;
+
+	out << "{\"enabled\":" << (trie_instrumentation_enabled ? "true" : "false")
+		<< ",\"node_visits\":" << node_visits
+		<< ",\"allocations\":" << allocations
+		<< ",\"frees\":" << frees
+		<< ",\"max_depth\":" << max_depth
+		<< ",\"latency_ns\":{";
+
+	for (size_t i = 0; i < trie_operation_count; i++)
+	{
+		const trie_latency_histogram & histogram = latencies[i];
+		out << (i ? "," : "") << '"' << to_string(static_cast<trie_operation>(i)) << "\":{\"calls\":" << histogram.total() << ",\"buckets\":[";
+
+		for (size_t bucket = 0; bucket < trie_latency_histogram::bucket_count; bucket++)
+		{
+			out << (bucket ? "," : "") << histogram.buckets[bucket];
+		}
+
+		out << "]}";
+	}
+
+	out << "}}";
+	return out.str();
+}
+
+
+trie_statistics& trie_stats()
+{
+	static trie_statistics statistics;
+	return statistics;
+}
+
+
+const char* to_string(trie_operation operation)
+{
+	switch (operation)
+	{
+	case trie_operation::insert:
+		return "insert";
+	case trie_operation::erase:
+		return "erase";
+	case trie_operation::contains:
+		return "contains";
+	case trie_operation::search_by_prefix:
+		return "search_by_prefix";
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*
+ * Opt-in instrumentation of the trie.
+ *
+ * Define TRIE_INSTRUMENTATION (e.g. in project's preprocessor definitions)
+ * to make the trie record node visits, node allocations and frees, the
+ * deepest level touched and latency histograms of its main operations.
+ * Without it, all the hooks below expand to nothing and the statistics
+ * stay zero.
+ *
+ * Statistics are shared by all tries and safe to update from multiple threads.
+ */
+
+#ifdef TRIE_INSTRUMENTATION
+static const bool trie_instrumentation_enabled = true;
+#else
+static const bool trie_instrumentation_enabled = false;
+#endif
+
+enum class trie_operation {
+    insert,
+    erase,
+    contains,
+    search_by_prefix,
+};
+
+static const size_t trie_operation_count = 4;
+
+/*
+ * Bucket i counts operations that took [2^i, 2^(i+1)) nanoseconds,
+ * the first bucket also counts operations faster than 1 ns.
+ */
+struct trie_latency_histogram {
+    static const size_t bucket_count = 40;
+    std::atomic<std::uint64_t> buckets[bucket_count] = {};
+
+    void record(std::uint64_t nanoseconds);
+    std::uint64_t total() const;
+};
+
+struct trie_statistics {
+    std::atomic<std::uint64_t> node_visits{ 0 };
+    std::atomic<std::uint64_t> allocations{ 0 };
+    std::atomic<std::uint64_t> frees{ 0 };
+    std::atomic<std::uint64_t> max_depth{ 0 };
+    trie_latency_histogram latencies[trie_operation_count];
+
+    void touch_depth(std::uint64_t depth);
+    trie_latency_histogram& latency(trie_operation operation);
+    const trie_latency_histogram& latency(trie_operation operation) const;
+
+    void reset();
+    /*
+     * Returns human readable report of all statistics.
+     */
+    std::string report() const;
+    /*
+     * Returns all statistics as a JSON object.
+     */
+    std::string report_json() const;
+};
+
+/*
+ * Returns statistics collected by all tries.
+ */
+trie_statistics& trie_stats();
+
+const char* to_string(trie_operation operation);
+
+/*
+ * Measures its own lifetime and records it into the latency histogram of given operation.
+ */
+class trie_operation_timer {
+public:
+    trie_operation_timer(trie_operation operation):
+        operation(operation), start(std::chrono::steady_clock::now()) {}
+
+    trie_operation_timer(const trie_operation_timer&) = delete;
+    trie_operation_timer& operator=(const trie_operation_timer&) = delete;
+
+    ~trie_operation_timer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        trie_stats().latency(operation).record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+private:
+    trie_operation operation;
+    std::chrono::steady_clock::time_point start;
+};
+
+#ifdef TRIE_INSTRUMENTATION
+#define TRIE_STATS_VISIT() (trie_stats().node_visits.fetch_add(1, std::memory_order_relaxed))
+#define TRIE_STATS_ALLOCATION() (trie_stats().allocations.fetch_add(1, std::memory_order_relaxed))
+#define TRIE_STATS_FREE() (trie_stats().frees.fetch_add(1, std::memory_order_relaxed))
+#define TRIE_STATS_DEPTH(depth) (trie_stats().touch_depth(depth))
+#define TRIE_STATS_TIMER(operation) trie_operation_timer trie_stats_timer_(operation)
+#else
+#define TRIE_STATS_VISIT() ((void)0)
+#define TRIE_STATS_ALLOCATION() ((void)0)
+#define TRIE_STATS_FREE() ((void)0)
+#define TRIE_STATS_DEPTH(depth) ((void)0)
+#define TRIE_STATS_TIMER(operation) ((void)0)
+#endif
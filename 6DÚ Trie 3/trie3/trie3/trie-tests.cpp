@@ -1,588 +1,1368 @@
-#include "trie.hpp"
-
-#include "catch.hpp"
-
-#include <chrono>
-#include <random>
-#include <iostream>
-#include <algorithm>
-
-#define VALIDATE_SETS(lhs, rhs) \
-    do {\
-        auto l = lhs; \
-        auto r = rhs; \
-        std::sort(begin(l), end(l)); \
-        std::sort(begin(r), end(r)); \
-        REQUIRE(l == r);             \
-   } while(0)
-
-
-namespace {
-
-    std::vector<std::string> as_vec(std::vector<std::string> v) {
-        return v;
-    }
-
-    std::vector<std::string> extract_all(const trie& t) {
-        return { t.begin(), t.end() };
-    }
-
-    void insert_all(trie& t, const std::vector<std::string>& strings) {
-        for (const auto& string : strings) {
-            t.insert(string);
-        }
-    }
-
-    char generate_char() {
-        // Note: The proper way to init the generator would be to use a std::random_device
-        //       but that would lead to every run being different and I would prefer to keep
-        //       the tests deterministic.
-        static std::mt19937 gen;
-        char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUWXYZ0123456789,.:;/\\\"'";
-        // -1 because the dist is [a, b], -1 because there is a \0 at the end
-        static std::uniform_int_distribution<std::size_t> dist(0, sizeof(chars) - 2);
-        return chars[dist(gen)];
-    }
-
-    std::string generate_string() {
-        std::string ret;
-        const size_t sz = 20;
-        ret.reserve(sz);
-        std::generate_n(std::back_inserter(ret), sz, generate_char);
-        return ret;
-    }
-
-    std::vector<std::string> generate_data(size_t sz) {
-        std::vector<std::string> res;
-        res.reserve(sz);
-        std::generate_n(std::back_inserter(res), sz, generate_string);
-        return res;
-    }
-}
-
-TEST_CASE("Basics: inserts") {
-    trie trie;
-
-    SECTION("Empty trie") {
-        REQUIRE_FALSE(trie.contains(""));
-        REQUIRE(trie.size() == 0);
-        REQUIRE(trie.empty());
-    }
-
-    SECTION("Trivial inserts") {
-        REQUIRE(trie.insert("abcd"));
-        REQUIRE(trie.contains("abcd"));
-        REQUIRE_FALSE(trie.contains(""));
-        REQUIRE_FALSE(trie.contains("a"));
-        REQUIRE_FALSE(trie.contains("ab"));
-        REQUIRE_FALSE(trie.contains("abc"));
-        REQUIRE(trie.size() == 1);
-
-        REQUIRE(trie.insert("abc"));
-        REQUIRE(trie.contains("abc"));
-        REQUIRE(trie.size() == 2);
-
-        REQUIRE_FALSE(trie.empty());
-    }
-}
-
-TEST_CASE("Basics: erase") {
-    trie trie;
-
-    SECTION("Trivial erase") {
-        REQUIRE(trie.insert("a"));
-        REQUIRE(trie.erase("a"));
-        REQUIRE_FALSE(trie.contains("a"));
-        REQUIRE(trie.size() == 0);
-        REQUIRE(trie.empty());
-
-        REQUIRE(trie.insert("bcd"));
-        REQUIRE(trie.erase("bcd"));
-        REQUIRE_FALSE(trie.contains("bcd"));
-        REQUIRE(trie.size() == 0);
-        REQUIRE(trie.empty());
-    }
-
-    SECTION("Erase in the middle of a link") {
-        insert_all(trie, { "", "a", "ab", "abc", "abcd" });
-        REQUIRE(trie.erase("ab"));
-        REQUIRE(trie.size() == 4);
-        REQUIRE_FALSE(trie.contains("ab"));
-
-        REQUIRE(trie.erase("abc"));
-        REQUIRE(trie.size() == 3);
-        REQUIRE_FALSE(trie.contains("abc"));
-
-        REQUIRE(trie.contains("abcd"));
-    }
-}
-
-TEST_CASE("Complex: inserts") {
-    trie trie;
-
-    SECTION("Repeated inserts do not reinsert given string") {
-        REQUIRE(trie.insert("abcd"));
-        REQUIRE_FALSE(trie.insert("abcd"));
-        REQUIRE(trie.insert("abc"));
-        REQUIRE_FALSE(trie.insert("abc"));
-
-        REQUIRE(trie.contains("abcd"));
-        REQUIRE(trie.contains("abc"));
-        REQUIRE(trie.size() == 2);
-    }
-}
-
-TEST_CASE("Complex: repeated interaction") {
-    trie trie;
-
-    SECTION("Reinserting and reerasing the same element works properly") {
-        insert_all(trie, { "a", "aa", "ab", "ac" });
-        REQUIRE(trie.erase("a"));
-        REQUIRE_FALSE(trie.contains("a"));
-        REQUIRE(trie.insert("a"));
-        REQUIRE(trie.contains("a"));
-        REQUIRE(trie.erase("a"));
-        REQUIRE_FALSE(trie.erase("a"));
-        REQUIRE(trie.contains("aa"));
-        REQUIRE(trie.contains("ab"));
-        REQUIRE(trie.contains("ac"));
-
-        REQUIRE(trie.size() == 3);
-    }
-}
-
-TEST_CASE("Vector constructor") {
-    trie trie({ "abc", "bc", "a", "bc", "d", "", "d", "abcd", "abc" });
-    REQUIRE(trie.size() == 6);
-    REQUIRE(trie.contains(""));
-    REQUIRE(trie.contains("a"));
-    REQUIRE(trie.contains("d"));
-    REQUIRE_FALSE(trie.contains("b"));
-    REQUIRE(trie.contains("bc"));
-    REQUIRE_FALSE(trie.contains("ab"));
-    REQUIRE(trie.contains("abc"));
-    REQUIRE(trie.contains("abcd"));
-}
-
-TEST_CASE("Search by prefix") {
-    trie trie;
-    insert_all(trie, { "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
-    SECTION("Search is inclusive") {
-        VALIDATE_SETS(trie.search_by_prefix("aa"), as_vec({ "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" }));
-    }
-    SECTION("Prefix not in the trie") {
-        VALIDATE_SETS(trie.search_by_prefix(""), extract_all(trie));
-    }
-}
-
-TEST_CASE("Get prefixes") {
-    trie trie;
-    insert_all(trie, { "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
-    SECTION("Search is inclusive") {
-        VALIDATE_SETS(trie.get_prefixes("aabab"), as_vec({ "aa", "a", "aabab" }));
-    }
-    SECTION("Input is not in the trie") {
-        VALIDATE_SETS(trie.get_prefixes("aaaaa"), as_vec({ "a", "aa", "aaa" }));
-    }
-}
-
-TEST_CASE("Iterator") {
-    SECTION("Default constructed iterators are equal") {
-        trie::const_iterator iter1, iter2;
-        REQUIRE(iter1 == iter2);
-    }
-    trie t({ "abc", "bcd", "cde", "edf" });
-    auto it = t.begin();
-    auto et = t.end();
-    SECTION("End iterator and default constructed iterator are equal") {
-        trie::const_iterator iter;
-        REQUIRE(iter == et);
-    }
-    SECTION("Prefix increment") {
-        REQUIRE(it != et);
-        REQUIRE(*it == "abc");
-        ++it;
-        REQUIRE(it != et);
-        REQUIRE(*it == "bcd");
-        ++it;
-
-        REQUIRE(it != et);
-        REQUIRE(*it == "cde");
-        ++it;
-
-        REQUIRE(it != et);
-        REQUIRE(*it == "edf");
-        ++it;
-
-        REQUIRE(it == et);
-    }
-    SECTION("Postfix increment") {
-        REQUIRE(it != et);
-        REQUIRE(*it == "abc");
-        it++;
-        REQUIRE(it != et);
-        REQUIRE(*it == "bcd");
-        it++;
-
-        REQUIRE(it != et);
-        REQUIRE(*it == "cde");
-        it++;
-
-        REQUIRE(it != et);
-        REQUIRE(*it == "edf");
-        it++;
-
-        REQUIRE(it == et);
-    }
-    SECTION("Iterator can be reused") {
-        auto it2 = it;
-        ++it;
-        REQUIRE(*it2 == "abc");
-        ++it;
-        REQUIRE(*it2 == "abc");
-        ++it;
-        REQUIRE(*it2 == "abc");
-        ++it2;
-        REQUIRE(*it2 == "bcd");
-    }
-    SECTION("Empty string handling") {
-        trie yes({ "", "a", "b", "aaa", "aab" });
-        auto it = yes.begin();
-        REQUIRE(*it == "");
-        trie no({ "a", "b", "aaa", "aab" });
-        it = no.begin();
-        REQUIRE(*it == "a");
-    }
-}
-
-TEST_CASE("Copy") {
-    SECTION("Copy constructor") {
-        SECTION("Verify that deep copy is performed") {
-            trie t1({ "a", "aa", "ab", "ad", "cd", "c", "q"});
-            trie t2(t1);
-            SECTION("Add to old trie") {
-                t1.insert("xXxXx");
-                VALIDATE_SETS(extract_all(t1), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "xXxXx" }));
-                VALIDATE_SETS(extract_all(t2), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q" }));
-            }
-            SECTION("Add to new trie") {
-                t2.insert("xXxXx");
-                VALIDATE_SETS(extract_all(t1), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q" }));
-                VALIDATE_SETS(extract_all(t2), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "xXxXx" }));
-            }
-            SECTION("Add to both tries") {
-                t1.insert("xXxXx");
-                t2.insert("YYY");
-                VALIDATE_SETS(extract_all(t1), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "xXxXx" }));
-                VALIDATE_SETS(extract_all(t2), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "YYY" }));
-            }
-        }
-        SECTION("Copying an empty trie must work properly") {
-            trie t1;
-            trie t2(t1);
-            REQUIRE(t1.empty());
-            REQUIRE(t2.empty());
-        }
-    }
-    SECTION("Copy assignment") {
-        trie t1({"a", "b", "c", "d"});
-        trie t2({"A", "B", "C", "D"});
-        SECTION("Simple assignment") {
-            t1 = t2;
-            VALIDATE_SETS(extract_all(t1), as_vec({ "A", "B", "C", "D" }));
-            VALIDATE_SETS(extract_all(t2), as_vec({ "A", "B", "C", "D" }));
-        }
-        SECTION("Self assignment") {
-            t1 = t1;
-            VALIDATE_SETS(extract_all(t1), as_vec({ "a", "b", "c", "d" }));
-            REQUIRE(t1.size() == 4);
-        }
-        SECTION("Repeated assignments") {
-            t2 = t1;
-            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d" }));
-            t1.insert("A");
-            t2 = t1;
-            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A" }));
-            t1.insert("B");
-            t2 = t1;
-            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A", "B" }));
-            t1.insert("C");
-            t2 = t1;
-            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A", "B", "C" }));
-            t1.insert("D");
-            t2 = t1;
-            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A", "B", "C", "D" }));
-        }
-    }
-}
-
-TEST_CASE("Move operations") {
-    SECTION("Move constructor") {
-        SECTION("From an empty trie") {
-            trie t1;
-            trie t2(std::move(t1));
-            REQUIRE(t2.empty());
-        }
-        SECTION("From non-empty trie") {
-            trie t1({ "a", "b", "c", "d", "e" });
-            trie t2(std::move(t1));
-            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "e" }));
-        }
-    }
-    SECTION("Move assignment") {
-        SECTION("From empty trie") {
-            trie t1;
-            SECTION("To empty trie") {
-                trie t2;
-                t2 = std::move(t1);
-                REQUIRE(t2.empty());
-            }
-            SECTION("To non-empty trie") {
-                trie t2({"a", "b", "c", "d", "e"});
-                t2 = std::move(t1);
-                REQUIRE(t2.empty());
-            }
-        }
-        SECTION("From non-empty trie") {
-            trie t1({ "ab", "bc", "deg" });
-            SECTION("To empty trie") {
-                trie t2;
-                t2 = std::move(t1);
-                VALIDATE_SETS(extract_all(t2), as_vec({ "ab", "bc", "deg" }));
-            }
-            SECTION("To non-empty trie") {
-                trie t2({"kfa", "bfg", "id"});
-                t2 = std::move(t1);
-                VALIDATE_SETS(extract_all(t2), as_vec({ "ab", "bc", "deg" }));
-            }
-        }
-        SECTION("Back and forth") {
-            trie t1({ "abc", "def", "eee" });
-            trie t2({ "qwertz", "qwerty", "azerty" });
-            t1 = std::move(t2);
-            VALIDATE_SETS(extract_all(t1), as_vec({ "qwertz", "qwerty", "azerty" }));
-
-            t2 = std::move(t1);
-            VALIDATE_SETS(extract_all(t2), as_vec({ "qwertz", "qwerty", "azerty" }));
-
-            SECTION("Trie can be used after being move assigned-to") {
-                REQUIRE(t2.erase("azerty"));
-                REQUIRE(t2.insert("qzerty"));
-                VALIDATE_SETS(extract_all(t2), as_vec({ "qwertz", "qwerty", "qzerty" }));
-            }
-        }
-    }
-}
-
-TEST_CASE("member swap") {
-    SECTION("Swapping empty tries leaves both empty") {
-        trie t1, t2;
-        t1.swap(t2);
-        REQUIRE(t1.empty());
-        REQUIRE(t1.empty());
-    }
-    SECTION("Swapping tries actually swaps elements") {
-        trie t1({ "azerty", "qwerty", "qwertz" });
-        SECTION("Non-empty and empty trie") {
-            trie t2;
-            t1.swap(t2);
-            REQUIRE(t1.empty());
-            VALIDATE_SETS(extract_all(t2), as_vec({ "azerty", "qwerty", "qwertz" }));
-
-            SECTION("Roundtrip") {
-                t2.swap(t1);
-                REQUIRE(t2.empty());
-                VALIDATE_SETS(extract_all(t1), as_vec({"azerty", "qwerty", "qwertz"}));
-            }
-        }
-        SECTION("Non-empty and non-empty trie") {
-            trie t2({ "qzerty", "querty", "awerty" });
-            t1.swap(t2);
-            VALIDATE_SETS(extract_all(t1), as_vec({"qzerty", "querty", "awerty"}));
-            VALIDATE_SETS(extract_all(t2), as_vec({"azerty", "qwerty", "qwertz"}));
-
-            SECTION("Roundtrip") {
-                t1.swap(t2);
-                VALIDATE_SETS(extract_all(t1), as_vec({ "azerty", "qwerty", "qwertz" }));
-                VALIDATE_SETS(extract_all(t2), as_vec({ "qzerty", "querty", "awerty" }));
-            }
-        }
-    }
-}
-
-TEST_CASE("member swap -- complexity", "[.long]") {
-    // Swap should take constant time regardless of trie size.
-    using namespace std::chrono_literals;
-    double last_time = 0;
-    auto remove_duplicates = [] (std::vector<std::string> data) {
-        std::sort(begin(data), end(data));
-        data.erase(std::unique(begin(data), end(data)),
-                   end(data));
-        return data;
-    };
-    for (size_t i = 1'000; i <= 128'000; i *= 2) {
-        auto lhs_elems = remove_duplicates(generate_data(i));
-        trie lhs{ lhs_elems };
-        auto rhs_elems = remove_duplicates(generate_data(i));
-        trie rhs{ rhs_elems };
-        auto start_time = std::chrono::high_resolution_clock::now();
-        lhs.swap(rhs);
-        auto end_time = std::chrono::high_resolution_clock::now();
-        // Add 0.5 ms to even out variability
-        auto time_diff = end_time - start_time + 500us;
-        auto total_time = static_cast<double>(time_diff.count());
-        VALIDATE_SETS(extract_all(lhs), rhs_elems);
-        VALIDATE_SETS(extract_all(rhs), lhs_elems);
-
-        if (last_time) {
-            // The coefficient is a rough approximation.
-            // A linear time coefficient should blow out, constant time
-            // jitter should remain inside some reasonable coefficient
-            REQUIRE(total_time / last_time <= 1.25);
-        }
-        last_time = total_time;
-        std::cout << "member swap: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
-    }
-}
-
-TEST_CASE("Trie union") {
-    trie t1, t2;
-    SECTION("Empty tries") {
-        auto res = t1 | t2;
-        CHECK(res.empty());
-        REQUIRE(res.size() == 0);
-    }
-    SECTION("One trie empty") {
-        t1 = trie({ "aa", "aab", "aabb", "zzz" });
-        SECTION("LHS trie empty") {
-            auto res = t2 | t1;
-            CHECK(res.size() == 4);
-            REQUIRE(res == t1);
-        }
-        SECTION("RHS trie empty") {
-            auto res = t1 | t2;
-            CHECK(res.size() == 4);
-            REQUIRE(res == t1);
-        }
-    }
-    SECTION("No empty tries") {
-        t1 = trie({ "queue", "quiz", "quizzical", "quilt" });
-        SECTION("Identical tries") {
-            auto res = t1 | t1;
-            CHECK(res.size() == 4);
-            REQUIRE(res == t1);
-        }
-        SECTION("Overlapping tries") {
-            t2 = trie({"quilt", "queue", "quitter"});
-            auto res = t1 | t2;
-            CHECK(res.size() == 5);
-            REQUIRE(res == trie({"queue", "quiz", "quizzical", "quilt", "quitter"}));
-        }
-        SECTION("Distinct tries") {
-            t2 = trie({"abra", "kadabra","abrakadabra"});
-            auto res = t1 | t2;
-            CHECK(res.size() == 7);
-            REQUIRE(res == trie({"queue", "quiz", "quizzical", "quilt", "abra", "kadabra", "abrakadabra"}));
-        }
-    }
-    SECTION("Chained unions") {
-        t1 = trie({"aaa", "bbb", "ccc"});
-        t2 = trie({"bbb", "ccc", "ddd"});
-        trie t3({"eee", "fff", "ggg"});
-        trie t4({"ggg", "hhh", "iii"});
-        auto res = t1 | t2 | t3 | t4;
-        CHECK(res.size() == 9);
-        REQUIRE(res == trie({"aaa", "bbb", "ccc", "ddd", "eee", "fff", "ggg", "hhh" ,"iii"}));
-    }
-}
-
-TEST_CASE("Trie intersection") {
-    trie t1, t2;
-    SECTION("Empty tries") {
-        auto res = t1 & t2;
-        CHECK(res.empty());
-        REQUIRE(res.size() == 0);
-    }
-    SECTION("One trie empty") {
-        t1 = trie({ "aa", "aab", "aabb", "zzz" });
-        SECTION("LHS trie empty") {
-            auto res = t2 & t1;
-            CHECK(res.size() == 0);
-            REQUIRE(res == t2);
-        }
-        SECTION("RHS trie empty") {
-            auto res = t1 & t2;
-            CHECK(res.size() == 0);
-            REQUIRE(res == t2);
-        }
-    }
-    SECTION("No empty tries") {
-        t1 = trie({ "queue", "quiz", "quizzical", "quilt" });
-        SECTION("Identical tries") {
-            auto res = t1 & t1;
-            CHECK(res.size() == 4);
-            REQUIRE(res == t1);
-        }
-        SECTION("Overlapping tries") {
-            t2 = trie({ "quilt", "queue", "quitter" });
-            auto res = t1 & t2;
-            CHECK(res.size() == 2);
-            REQUIRE(res == trie({ "queue", "quilt" }));
-        }
-        SECTION("Distinct tries") {
-            t2 = trie({ "abra", "kadabra","abrakadabra" });
-            auto res = t1 & t2;
-            CHECK(res.size() == 0);
-            REQUIRE(res == trie{});
-        }
-    }
-    SECTION("Chained intersections") {
-        t1 = trie({ "aaa", "bbb", "ccc", "ddd" });
-        t2 = trie({ "bbb", "ccc", "ddd", "eee" });
-        trie t3({ "ccc", "ddd", "eee", "fff" });
-        trie t4({ "ddd", "eee", "fff", "ggg" });
-        auto res = t1 & t2 & t3 & t4;
-        CHECK(res.size() == 1);
-        REQUIRE(res == trie({ "ddd" }));
-    }
-}
-
-TEST_CASE("Trie intersection - complexity", "[.long]") {
-    using namespace std::chrono_literals;
-    double last_time = 0;
-    auto add_prefix = [] (std::vector<std::string> const& strings, std::string const& prefix) {
-        std::vector<std::string> results;
-        for (auto const& str : strings) {
-            results.push_back(prefix + str);
-        }
-        return results;
-    };
-    // The idea:
-    // Naive implementation of intersection would be to extract all strings
-    // in the tries and then perform intersection over vector<string>.
-    // Given 2 tries, one with all words prefixed with 'a' and second
-    // with all words prefixed with 'z', this would lead to linear complexity
-    // However, proper implementation should intersect such tries in constant time
-    for (size_t i = 1'000; i <= 64'000; i *= 2) {
-        auto lhs_elems = add_prefix(generate_data(i), "aaa");
-        trie lhs{ lhs_elems };
-        auto rhs_elems = add_prefix(generate_data(i), "zzz");
-        trie rhs{ rhs_elems };
-        auto start_time = std::chrono::high_resolution_clock::now();
-        auto res = lhs & rhs;
-        auto end_time = std::chrono::high_resolution_clock::now();
-        // Add 0.5 ms to even out variability
-        auto time_diff = end_time - start_time + 500us;
-        auto total_time = static_cast<double>(time_diff.count());
-        REQUIRE(res == trie{});
-
-        if (last_time) {
-            // The coefficient is a rough approximation.
-            // A linear time coefficient should blow out, constant time
-            // jitter should remain inside some reasonable coefficient
-            REQUIRE(total_time / last_time <= 1.25);
-        }
-        last_time = total_time;
-        std::cout << "Trie intersection: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
-    }
-}
+#include "trie.hpp"
+#include "trie-stats.hpp"
+#include "trie-dawg.hpp"
+#include "trie-labels.hpp"
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <memory>
+#include <cctype>
+#include <numeric>
+
+#define VALIDATE_SETS(lhs, rhs) \
+    do {\
+        auto l = lhs; \
+        auto r = rhs; \
+        std::sort(begin(l), end(l)); \
+        std::sort(begin(r), end(r)); \
+        REQUIRE(l == r);             \
+   } while(0)
+
+
+namespace {
+
+    std::vector<std::string> as_vec(std::vector<std::string> v) {
+        return v;
+    }
+
+    std::vector<std::string> extract_all(const trie& t) {
+        return { t.begin(), t.end() };
+    }
+
+    void insert_all(trie& t, const std::vector<std::string>& strings) {
+        for (const auto& string : strings) {
+            t.insert(string);
+        }
+    }
+
+    char generate_char() {
+        // Note: The proper way to init the generator would be to use a std::random_device
+        //       but that would lead to every run being different and I would prefer to keep
+        //       the tests deterministic.
+        static std::mt19937 gen;
+        char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUWXYZ0123456789,.:;/\\\"'";
+        // -1 because the dist is [a, b], -1 because there is a \0 at the end
+        static std::uniform_int_distribution<std::size_t> dist(0, sizeof(chars) - 2);
+        return chars[dist(gen)];
+    }
+
+    std::string generate_string() {
+        std::string ret;
+        const size_t sz = 20;
+        ret.reserve(sz);
+        std::generate_n(std::back_inserter(ret), sz, generate_char);
+        return ret;
+    }
+
+    std::vector<std::string> generate_data(size_t sz) {
+        std::vector<std::string> res;
+        res.reserve(sz);
+        std::generate_n(std::back_inserter(res), sz, generate_string);
+        return res;
+    }
+}
+
+TEST_CASE("Basics: inserts") {
+    trie trie;
+
+    SECTION("Empty trie") {
+        REQUIRE_FALSE(trie.contains(""));
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.empty());
+    }
+
+    SECTION("Trivial inserts") {
+        REQUIRE(trie.insert("abcd"));
+        REQUIRE(trie.contains("abcd"));
+        REQUIRE_FALSE(trie.contains(""));
+        REQUIRE_FALSE(trie.contains("a"));
+        REQUIRE_FALSE(trie.contains("ab"));
+        REQUIRE_FALSE(trie.contains("abc"));
+        REQUIRE(trie.size() == 1);
+
+        REQUIRE(trie.insert("abc"));
+        REQUIRE(trie.contains("abc"));
+        REQUIRE(trie.size() == 2);
+
+        REQUIRE_FALSE(trie.empty());
+    }
+}
+
+TEST_CASE("Basics: erase") {
+    trie trie;
+
+    SECTION("Trivial erase") {
+        REQUIRE(trie.insert("a"));
+        REQUIRE(trie.erase("a"));
+        REQUIRE_FALSE(trie.contains("a"));
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.empty());
+
+        REQUIRE(trie.insert("bcd"));
+        REQUIRE(trie.erase("bcd"));
+        REQUIRE_FALSE(trie.contains("bcd"));
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.empty());
+    }
+
+    SECTION("Erase in the middle of a link") {
+        insert_all(trie, { "", "a", "ab", "abc", "abcd" });
+        REQUIRE(trie.erase("ab"));
+        REQUIRE(trie.size() == 4);
+        REQUIRE_FALSE(trie.contains("ab"));
+
+        REQUIRE(trie.erase("abc"));
+        REQUIRE(trie.size() == 3);
+        REQUIRE_FALSE(trie.contains("abc"));
+
+        REQUIRE(trie.contains("abcd"));
+    }
+}
+
+TEST_CASE("Complex: inserts") {
+    trie trie;
+
+    SECTION("Repeated inserts do not reinsert given string") {
+        REQUIRE(trie.insert("abcd"));
+        REQUIRE_FALSE(trie.insert("abcd"));
+        REQUIRE(trie.insert("abc"));
+        REQUIRE_FALSE(trie.insert("abc"));
+
+        REQUIRE(trie.contains("abcd"));
+        REQUIRE(trie.contains("abc"));
+        REQUIRE(trie.size() == 2);
+    }
+}
+
+TEST_CASE("Complex: repeated interaction") {
+    trie trie;
+
+    SECTION("Reinserting and reerasing the same element works properly") {
+        insert_all(trie, { "a", "aa", "ab", "ac" });
+        REQUIRE(trie.erase("a"));
+        REQUIRE_FALSE(trie.contains("a"));
+        REQUIRE(trie.insert("a"));
+        REQUIRE(trie.contains("a"));
+        REQUIRE(trie.erase("a"));
+        REQUIRE_FALSE(trie.erase("a"));
+        REQUIRE(trie.contains("aa"));
+        REQUIRE(trie.contains("ab"));
+        REQUIRE(trie.contains("ac"));
+
+        REQUIRE(trie.size() == 3);
+    }
+}
+
+TEST_CASE("Vector constructor") {
+    trie trie({ "abc", "bc", "a", "bc", "d", "", "d", "abcd", "abc" });
+    REQUIRE(trie.size() == 6);
+    REQUIRE(trie.contains(""));
+    REQUIRE(trie.contains("a"));
+    REQUIRE(trie.contains("d"));
+    REQUIRE_FALSE(trie.contains("b"));
+    REQUIRE(trie.contains("bc"));
+    REQUIRE_FALSE(trie.contains("ab"));
+    REQUIRE(trie.contains("abc"));
+    REQUIRE(trie.contains("abcd"));
+}
+
+TEST_CASE("Search by prefix") {
+    trie trie;
+    insert_all(trie, { "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
+    SECTION("Search is inclusive") {
+        VALIDATE_SETS(trie.search_by_prefix("aa"), as_vec({ "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" }));
+    }
+    SECTION("Prefix not in the trie") {
+        VALIDATE_SETS(trie.search_by_prefix(""), extract_all(trie));
+    }
+}
+
+TEST_CASE("Suffix and substring search") {
+    const std::vector<std::string> words = { "", "walk", "walks", "walked", "talk", "talking", "king", "kin" };
+
+    for (auto mode : { trie_index_mode::none, trie_index_mode::reversed, trie_index_mode::suffixes }) {
+        trie t{ words };
+        t.set_index_mode(mode);
+        REQUIRE(t.index_mode() == mode);
+
+        REQUIRE(t.search_by_suffix("alk") == as_vec({ "talk", "walk" }));
+        REQUIRE(t.search_by_suffix("ing") == as_vec({ "king", "talking" }));
+        REQUIRE(t.search_by_suffix("walks") == as_vec({ "walks" }));
+        REQUIRE(t.search_by_suffix("x").empty());
+        REQUIRE(t.search_by_suffix("") == extract_all(t));
+        REQUIRE(t.search_by_substring("alk") == as_vec({ "talk", "talking", "walk", "walked", "walks" }));
+        REQUIRE(t.search_by_substring("kin") == as_vec({ "kin", "king", "talking" }));
+        REQUIRE(t.search_by_substring("lke") == as_vec({ "walked" }));
+        REQUIRE(t.search_by_substring("xyz").empty());
+        REQUIRE(t.search_by_substring("") == extract_all(t));
+
+        // copies keep the indexes
+        trie copy(t);
+        REQUIRE(copy.index_mode() == mode);
+        trie assigned;
+        assigned = t;
+        REQUIRE(assigned.index_mode() == mode);
+        REQUIRE(assigned.insert("talks"));
+        REQUIRE(assigned.search_by_suffix("ks") == as_vec({ "talks", "walks" }));
+        REQUIRE(t.search_by_suffix("ks") == as_vec({ "walks" }));
+        trie moved(std::move(copy));
+        REQUIRE(moved.index_mode() == mode);
+        REQUIRE(moved.search_by_substring("alke") == as_vec({ "walked" }));
+
+        // indexes follow inserts and erases
+        REQUIRE(t.erase("talking"));
+        REQUIRE(t.erase("king"));
+        REQUIRE(t.insert("baking"));
+        REQUIRE(t.search_by_suffix("ing") == as_vec({ "baking" }));
+        REQUIRE(t.search_by_substring("kin") == as_vec({ "baking", "kin" }));
+        REQUIRE(t.search_by_substring("alki").empty());
+        REQUIRE(t.erase("kin"));
+        REQUIRE(t.search_by_substring("kin") == as_vec({ "baking" }));
+    }
+    SECTION("Indexed search agrees with full scan") {
+        trie scanned{ generate_data(200) };
+        trie indexed(scanned);
+        indexed.set_index_mode(trie_index_mode::suffixes);
+        for (const auto& str : extract_all(scanned)) {
+            REQUIRE(indexed.search_by_suffix(str.substr(18)) == scanned.search_by_suffix(str.substr(18)));
+            REQUIRE(indexed.search_by_substring(str.substr(5, 2)) == scanned.search_by_substring(str.substr(5, 2)));
+        }
+    }
+}
+
+TEST_CASE("Get prefixes") {
+    trie trie;
+    insert_all(trie, { "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
+    SECTION("Search is inclusive") {
+        VALIDATE_SETS(trie.get_prefixes("aabab"), as_vec({ "aa", "a", "aabab" }));
+    }
+    SECTION("Input is not in the trie") {
+        VALIDATE_SETS(trie.get_prefixes("aaaaa"), as_vec({ "a", "aa", "aaa" }));
+    }
+    SECTION("Prefix lengths") {
+        std::vector<size_t> lengths = { 42 };
+        trie.get_prefix_lengths("aabab", lengths);
+        REQUIRE(lengths == std::vector<size_t>({ 1, 2, 5 }));
+        trie.get_prefix_lengths("xaabab", lengths, 1);
+        REQUIRE(lengths == std::vector<size_t>({ 1, 2, 5 }));
+        trie.get_prefix_lengths("aaaab", lengths, 2);
+        REQUIRE(lengths == std::vector<size_t>({ 1, 2 }));
+        trie.get_prefix_lengths("b", lengths);
+        REQUIRE(lengths.empty());
+        trie.get_prefix_lengths("aa", lengths, 5);
+        REQUIRE(lengths.empty());
+    }
+    SECTION("Longest prefix") {
+        REQUIRE(trie.longest_prefix("aabab") == 5);
+        REQUIRE(trie.longest_prefix("aaqqqq") == 5);
+        REQUIRE(trie.longest_prefix("aaqq") == 2);
+        REQUIRE(trie.longest_prefix("zaabb", 1) == 4);
+        REQUIRE(trie.longest_prefix("b") == 0);
+        REQUIRE(trie.longest_prefix("") == 0);
+    }
+}
+
+TEST_CASE("Batched lookup") {
+    trie trie;
+    insert_all(trie, { "", "a", "aa", "aaa", "aabb", "aabab", "aaaab", "aaqqq" });
+    const std::vector<std::string> keys = { "aabab", "", "b", "aaaaa", "aab", "aaqqq", "aaqqqq", "a" };
+    for (size_t batch_size : { 1, 3, 32 }) {
+        auto found = trie.contains_many(keys, batch_size);
+        auto prefixes = trie.get_prefixes_many(keys, batch_size);
+        REQUIRE(found.size() == keys.size());
+        REQUIRE(prefixes.size() == keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(found[i] == trie.contains(keys[i]));
+            REQUIRE(prefixes[i] == trie.get_prefixes(keys[i]));
+        }
+    }
+}
+
+TEST_CASE("Child labels") {
+    SECTION("Search agrees with plain loops") {
+        std::mt19937 gen(7);
+        char labels_of_node[num_chars] = {};
+        for (size_t count = 0; count <= num_chars; ++count) {
+            // count distinct labels sorted as unsigned char, the rest of the array is garbage
+            std::vector<int> all(num_chars);
+            std::iota(all.begin(), all.end(), 0);
+            std::shuffle(all.begin(), all.end(), gen);
+            std::sort(all.begin(), all.begin() + count);
+            for (size_t i = 0; i < num_chars; ++i) {
+                labels_of_node[i] = static_cast<char>(i < count ? all[i] : gen() % num_chars);
+            }
+
+            for (int c = 0; c < static_cast<int>(num_chars); ++c) {
+                const char label = static_cast<char>(c);
+                const int found = labels::find_scalar(labels_of_node, count, label);
+                const size_t slot = labels::lower_bound_scalar(labels_of_node, count, label);
+                REQUIRE((found < 0 || labels_of_node[found] == label));
+                REQUIRE(labels::find(labels_of_node, count, label) == found);
+                REQUIRE(labels::lower_bound(labels_of_node, count, label) == slot);
+#ifdef TRIE_LABELS_SSE2
+                REQUIRE(labels::find_sse2(labels_of_node, count, label) == found);
+                REQUIRE(labels::lower_bound_sse2(labels_of_node, count, label) == slot);
+#endif
+#ifdef TRIE_LABELS_AVX2
+                REQUIRE(labels::find_avx2(labels_of_node, count, label) == found);
+                REQUIRE(labels::lower_bound_avx2(labels_of_node, count, label) == slot);
+#endif
+            }
+        }
+    }
+    SECTION("Nodes with every fan-out") {
+        // root and "a" get a child for every character, inserted out of order
+        std::vector<std::string> words;
+        for (int c = num_chars - 2; c >= 0; c -= 2) {
+            words.push_back(std::string(1, static_cast<char>(c)));
+            words.push_back(std::string("a") + static_cast<char>(c));
+        }
+        for (int c = 1; c < static_cast<int>(num_chars); c += 2) {
+            words.push_back(std::string(1, static_cast<char>(c)));
+            words.push_back(std::string("a") + static_cast<char>(c));
+        }
+
+        trie t;
+        for (size_t i = 0; i < words.size(); ++i) {
+            REQUIRE(t.insert(words[i]));
+            REQUIRE(t.contains(words[i]));
+        }
+        REQUIRE(t.size() == words.size());
+        for (const auto& word : words) {
+            REQUIRE(t.contains(word));
+            REQUIRE_FALSE(t.contains(word + "zz"));
+        }
+
+        auto sorted = words;
+        std::sort(sorted.begin(), sorted.end());
+        REQUIRE(extract_all(t) == sorted);
+
+        trie copy(t);
+        std::stringstream stream;
+        t.save(stream);
+        trie loaded;
+        loaded.load(stream);
+        for (size_t i = 0; i < words.size(); i += 3) {
+            REQUIRE(t.erase(words[i]));
+            REQUIRE_FALSE(t.contains(words[i]));
+            REQUIRE(copy.contains(words[i]));
+            REQUIRE(loaded.contains(words[i]));
+        }
+        for (size_t i = 0; i < words.size(); ++i) {
+            REQUIRE(t.contains(words[i]) == (i % 3 != 0));
+        }
+        REQUIRE(extract_all(copy) == sorted);
+        REQUIRE(extract_all(loaded) == sorted);
+    }
+}
+
+TEST_CASE("Ordered queries") {
+    trie trie({ "b", "abc", "", "ab", "bcd", "abd", "a" });
+    const auto sorted = as_vec({ "", "a", "ab", "abc", "abd", "b", "bcd" });
+    SECTION("Iteration is lexicographical") {
+        REQUIRE(extract_all(trie) == sorted);
+    }
+    SECTION("select") {
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            REQUIRE(trie.select(i) == sorted[i]);
+        }
+        REQUIRE_THROWS_AS(trie.select(sorted.size()), std::out_of_range const&);
+    }
+    SECTION("rank") {
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            REQUIRE(trie.rank(sorted[i]) == i);
+        }
+        REQUIRE(trie.rank("aa") == 2);
+        REQUIRE(trie.rank("abcd") == 4);
+        REQUIRE(trie.rank("ba") == 6);
+        REQUIRE(trie.rank("c") == 7);
+    }
+    SECTION("count_range") {
+        REQUIRE(trie.count_range("", "~") == 7);
+        REQUIRE(trie.count_range("ab", "b") == 3);
+        REQUIRE(trie.count_range("abc", "abc") == 0);
+        REQUIRE(trie.count_range("b", "a") == 0);
+    }
+    SECTION("lower_bound") {
+        REQUIRE(*trie.lower_bound("abca") == "abd");
+        REQUIRE(*trie.lower_bound("") == "");
+        REQUIRE(trie.lower_bound("bcda") == trie.end());
+        auto it = trie.lower_bound("abd");
+        REQUIRE(*it == "abd");
+        ++it;
+        REQUIRE(*it == "b");
+    }
+    SECTION("Counts are kept up to date by erase") {
+        REQUIRE(trie.erase("ab"));
+        REQUIRE(trie.erase("a"));
+        REQUIRE(trie.erase(""));
+        REQUIRE(trie.rank("b") == 2);
+        REQUIRE(trie.select(2) == "b");
+        REQUIRE(trie.count_range("a", "b") == 2);
+        REQUIRE(trie.erase("abc"));
+        REQUIRE(trie.erase("abd"));
+        REQUIRE(trie.select(0) == "b");
+        REQUIRE(trie.contains("bcd"));
+    }
+}
+
+TEST_CASE("Snapshot") {
+    SECTION("Roundtrip") {
+        trie original({ "", "a", "ab", "abc", "b", "zzz", "a b" });
+        std::stringstream stream;
+        original.save(stream);
+        trie loaded;
+        loaded.load(stream);
+        REQUIRE(loaded.size() == original.size());
+        REQUIRE(extract_all(loaded) == extract_all(original));
+        REQUIRE(loaded.rank("b") == original.rank("b"));
+    }
+    SECTION("Roundtrip of an empty trie") {
+        trie original;
+        std::stringstream stream;
+        original.save(stream);
+        trie loaded({ "abc" });
+        loaded.load(stream);
+        REQUIRE(loaded.empty());
+        REQUIRE_FALSE(loaded.contains("abc"));
+    }
+    SECTION("Roundtrip of a large corpus") {
+        auto words = generate_data(5'000);
+        trie original{ words };
+        std::stringstream stream;
+        original.save(stream);
+        trie loaded;
+        loaded.load(stream);
+        REQUIRE(loaded.size() == original.size());
+        VALIDATE_SETS(extract_all(loaded), words);
+        for (const auto& word : words) {
+            REQUIRE(loaded.contains(word));
+        }
+    }
+    SECTION("Snapshots can follow each other in one stream") {
+        trie first({ "first" }), second({ "second", "seconds" });
+        std::stringstream stream;
+        first.save(stream);
+        second.save(stream);
+        trie loaded;
+        loaded.load(stream);
+        REQUIRE(extract_all(loaded) == as_vec({ "first" }));
+        loaded.load(stream);
+        REQUIRE(extract_all(loaded) == as_vec({ "second", "seconds" }));
+    }
+    SECTION("Invalid snapshots are rejected") {
+        trie original({ "abc", "abd" });
+        std::stringstream stream;
+        original.save(stream);
+        std::string data = stream.str();
+        trie loaded({ "keep" });
+
+        std::stringstream truncated(data.substr(0, data.size() - 1));
+        REQUIRE_THROWS_AS(loaded.load(truncated), std::invalid_argument const&);
+        std::stringstream garbage("not a trie");
+        REQUIRE_THROWS_AS(loaded.load(garbage), std::invalid_argument const&);
+        REQUIRE(extract_all(loaded) == as_vec({ "keep" }));
+    }
+    SECTION("Branches without words are rejected") {
+        // Root with one child "a" that is neither a word nor has children
+        const char leaf[] = { 'T', 'R', 'I', 'E', 1, 0, 1 << 1, 'a', 0 };
+        std::stringstream leaf_stream(std::string(leaf, sizeof(leaf)));
+        trie loaded({ "keep" });
+        REQUIRE_THROWS_AS(loaded.load(leaf_stream), std::invalid_argument const&);
+
+        // "a" is a word, "bc" holds none
+        const char branch[] = { 'T', 'R', 'I', 'E', 1, 1,
+                                2 << 1,
+                                'a', 0 << 1 | 1,
+                                'b', 1 << 1 | 0,
+                                'c', 0 << 1 | 0 };
+        std::stringstream branch_stream(std::string(branch, sizeof(branch)));
+        REQUIRE_THROWS_AS(loaded.load(branch_stream), std::invalid_argument const&);
+        REQUIRE(loaded == trie({ "keep" }));
+    }
+    SECTION("Text output lists the strings") {
+        std::stringstream out;
+        out << trie({ "b", "", "ab" });
+        REQUIRE(out.str() == "\nab\nb\n");
+        std::stringstream empty;
+        empty << trie();
+        REQUIRE(empty.str().empty());
+    }
+}
+
+TEST_CASE("Word counts") {
+    SECTION("Basics") {
+        trie t({ "abc" });
+        REQUIRE(t.count("abc") == 1);
+        REQUIRE(t.count("ab") == 0);
+        REQUIRE(t.count("x") == 0);
+        REQUIRE(t.add("abc") == 2);
+        REQUIRE(t.add("ab", 5) == 5);
+        REQUIRE(t.add("", 3) == 3);
+        REQUIRE(t.add("x", 0) == 0);
+        REQUIRE_FALSE(t.contains("x"));
+        REQUIRE(t.size() == 3);
+        REQUIRE(extract_all(t) == as_vec({ "", "ab", "abc" }));
+        REQUIRE(t.rank("abc") == 2);
+
+        REQUIRE_FALSE(t.insert("ab"));
+        REQUIRE(t.count("ab") == 5);
+        REQUIRE(t.erase("ab"));
+        REQUIRE(t.count("ab") == 0);
+        REQUIRE(t.add("ab") == 1);
+        REQUIRE(t.erase(""));
+        REQUIRE(t.count("") == 0);
+    }
+    SECTION("Copies and moves keep counts") {
+        trie t;
+        t.add("abc", 7);
+        t.add("", 2);
+        trie copy(t);
+        REQUIRE(copy.count("abc") == 7);
+        REQUIRE(copy.count("") == 2);
+        trie assigned;
+        assigned = copy;
+        REQUIRE(assigned.count("abc") == 7);
+        trie moved(std::move(copy));
+        REQUIRE(moved.count("abc") == 7);
+        REQUIRE(copy.empty());
+        assigned = std::move(moved);
+        REQUIRE(assigned.count("") == 2);
+        REQUIRE(moved.empty());
+    }
+    SECTION("Ingest") {
+        std::stringstream in("the cat, the dog... THE end\n42 x");
+        trie t;
+        REQUIRE(t.ingest(in) == 8);
+        REQUIRE(extract_all(t) == as_vec({ "42", "THE", "cat", "dog", "end", "the", "x" }));
+        REQUIRE(t.count("the") == 2);
+        REQUIRE(t.count("THE") == 1);
+        REQUIRE(t.count("x") == 1);
+    }
+    SECTION("Ingest reads in chunks") {
+        // long enough to have tokens cut by chunk boundaries
+        auto words = generate_data(20000);
+        std::string text;
+        for (const auto& word : words) {
+            for (char c : word) {
+                text.push_back(isalnum(static_cast<unsigned char>(c)) ? c : ' ');
+            }
+            text.push_back('\n');
+        }
+        std::stringstream in(text);
+        trie ingested;
+        size_t tokens = ingested.ingest(in);
+
+        trie expected;
+        size_t expected_tokens = 0;
+        std::stringstream words_in(text);
+        std::string token;
+        while (words_in >> token) {
+            expected.add(token);
+            expected_tokens++;
+        }
+        REQUIRE(tokens == expected_tokens);
+        REQUIRE(ingested.size() == expected.size());
+        REQUIRE(extract_all(ingested) == extract_all(expected));
+        for (const auto& word : extract_all(expected)) {
+            REQUIRE(ingested.count(word) == expected.count(word));
+        }
+    }
+    SECTION("Parallel ingest") {
+        std::vector<std::string> texts = { "a b c a", "b c d", "", "a a z", "c" };
+        std::vector<std::unique_ptr<std::stringstream>> streams;
+        std::vector<std::istream*> inputs;
+        for (const auto& text : texts) {
+            streams.emplace_back(new std::stringstream(text));
+            inputs.push_back(streams.back().get());
+        }
+        trie t({ "a", "y" });
+        t.set_index_mode(trie_index_mode::reversed);
+        REQUIRE(t.ingest_parallel(inputs, 3) == 11);
+        REQUIRE(extract_all(t) == as_vec({ "a", "b", "c", "d", "y", "z" }));
+        REQUIRE(t.size() == 6);
+        REQUIRE(t.count("a") == 5);
+        REQUIRE(t.count("b") == 2);
+        REQUIRE(t.count("c") == 3);
+        REQUIRE(t.count("y") == 1);
+        REQUIRE(t.search_by_suffix("z") == as_vec({ "z" }));
+        REQUIRE(t.rank("d") == 3);
+    }
+    SECTION("Parallel ingest of a failing stream") {
+        std::vector<std::string> texts = { "a b c", "d e", "f g h", "i" };
+        std::vector<std::unique_ptr<std::stringstream>> streams;
+        std::vector<std::istream*> inputs;
+        for (const auto& text : texts) {
+            streams.emplace_back(new std::stringstream(text));
+            inputs.push_back(streams.back().get());
+        }
+        // the short read at the end of the stream sets failbit
+        streams[2]->exceptions(std::ios::failbit);
+        trie t({ "a", "y" });
+        REQUIRE_THROWS_AS(t.ingest_parallel(inputs, 2), std::ios_base::failure const&);
+        REQUIRE(extract_all(t) == as_vec({ "a", "y" }));
+        REQUIRE(t.count("a") == 1);
+    }
+}
+
+TEST_CASE("Memory usage") {
+    SECTION("Empty trie") {
+        trie t;
+        auto usage = t.memory_usage();
+        REQUIRE(usage.node_count == 1);
+        REQUIRE(usage.node_bytes == sizeof(trie_node));
+        REQUIRE(usage.side_bytes == sizeof(trie));
+        REQUIRE(usage.total_bytes() == sizeof(trie_node) + sizeof(trie));
+        REQUIRE(usage.average_fan_out == 0);
+        REQUIRE(usage.depth_histogram == std::vector<size_t>({ 1 }));
+    }
+    SECTION("Nodes and depths") {
+        trie t({ "ab", "ac", "b", "" });
+        auto usage = t.memory_usage();
+        REQUIRE(usage.node_count == 5);
+        REQUIRE(usage.node_bytes == 5 * sizeof(trie_node));
+        REQUIRE(usage.average_fan_out == 2);
+        REQUIRE(usage.depth_histogram == std::vector<size_t>({ 1, 2, 2 }));
+
+        t.erase("ab");
+        t.erase("ac");
+        usage = t.memory_usage();
+        REQUIRE(usage.node_count == 2);
+        REQUIRE(usage.depth_histogram == std::vector<size_t>({ 1, 1 }));
+    }
+    SECTION("Indexes are side structures") {
+        trie t({ "abc", "abd" });
+        const size_t plain = t.memory_usage().side_bytes;
+        t.set_index_mode(trie_index_mode::reversed);
+        const size_t reversed = t.memory_usage().side_bytes;
+        t.set_index_mode(trie_index_mode::suffixes);
+        const size_t suffixes = t.memory_usage().side_bytes;
+        REQUIRE(plain < reversed);
+        REQUIRE(reversed < suffixes);
+        REQUIRE(t.memory_usage().node_count == 5);
+    }
+    SECTION("shrink_to_fit keeps contents") {
+        auto words = generate_data(2'000);
+        trie t{ words };
+        t.add(words[0], 5);
+        t.set_index_mode(trie_index_mode::reversed);
+        for (size_t i = 0; i < words.size(); i += 2) {
+            t.erase(words[i]);
+        }
+        auto before = t.memory_usage();
+        auto remaining = extract_all(t);
+
+        t.shrink_to_fit();
+        auto after = t.memory_usage();
+        REQUIRE(after.node_count == before.node_count);
+        REQUIRE(after.depth_histogram == before.depth_histogram);
+        REQUIRE(after.side_bytes == before.side_bytes);
+        REQUIRE(extract_all(t) == remaining);
+        REQUIRE(t.size() == remaining.size());
+        REQUIRE(t.rank(remaining.back()) == remaining.size() - 1);
+        REQUIRE(t.search_by_suffix("") == remaining);
+        REQUIRE(t.count(words[1]) == 1);
+        for (const auto& word : remaining) {
+            REQUIRE(t.erase(word));
+        }
+        REQUIRE(t.empty());
+        REQUIRE(t.memory_usage().node_count == 1);
+    }
+}
+
+TEST_CASE("Diff") {
+    SECTION("Basics") {
+        trie older({ "", "abc", "abd", "b", "xyz" });
+        trie newer({ "abc", "abde", "b", "bc", "q" });
+        auto diff = older.diff(newer);
+        REQUIRE(diff.removed == as_vec({ "", "abd", "xyz" }));
+        REQUIRE(diff.added == as_vec({ "abde", "bc", "q" }));
+        REQUIRE_FALSE(diff.empty());
+
+        older.apply_diff(diff);
+        REQUIRE(extract_all(older) == extract_all(newer));
+        REQUIRE(older.size() == newer.size());
+        REQUIRE(older.diff(newer).empty());
+    }
+    SECTION("Against empty trie") {
+        trie empty;
+        trie full({ "a", "ab", "b" });
+        REQUIRE(empty.diff(full).added == extract_all(full));
+        REQUIRE(empty.diff(full).removed.empty());
+        REQUIRE(full.diff(empty).removed == extract_all(full));
+        REQUIRE(empty.diff(empty).empty());
+    }
+    SECTION("Encoding round trip") {
+        auto older_words = generate_data(1000);
+        auto newer_words = older_words;
+        newer_words.erase(newer_words.begin(), newer_words.begin() + 50);
+        auto added = generate_data(50);
+        newer_words.insert(newer_words.end(), added.begin(), added.end());
+        trie older{ older_words };
+        trie newer{ newer_words };
+
+        auto diff = older.diff(newer);
+        REQUIRE(diff.removed.size() == 50);
+        REQUIRE(diff.added.size() == 50);
+        std::stringstream stream;
+        diff.save(stream);
+        stream << "rest";
+        trie_diff loaded;
+        loaded.load(stream);
+        REQUIRE(loaded.added == diff.added);
+        REQUIRE(loaded.removed == diff.removed);
+        std::string rest;
+        stream >> rest;
+        REQUIRE(rest == "rest");
+
+        older.apply_diff(loaded);
+        REQUIRE(extract_all(older) == extract_all(newer));
+    }
+    SECTION("Invalid diffs are rejected") {
+        trie t({ "abc", "abd" });
+        trie_diff diff;
+        diff.removed = { "abc", "x" };
+        REQUIRE_THROWS_AS(t.apply_diff(diff), std::invalid_argument const&);
+        diff.removed = { "abd" };
+        diff.added = { "abc" };
+        REQUIRE_THROWS_AS(t.apply_diff(diff), std::invalid_argument const&);
+        diff.added = { "b", "a" };
+        REQUIRE_THROWS_AS(t.apply_diff(diff), std::invalid_argument const&);
+        REQUIRE(extract_all(t) == as_vec({ "abc", "abd" }));
+
+        diff.added = { "a", "b" };
+        std::stringstream stream;
+        diff.save(stream);
+        std::string data = stream.str();
+        trie_diff loaded;
+        std::stringstream truncated(data.substr(0, data.size() - 1));
+        REQUIRE_THROWS_AS(loaded.load(truncated), std::invalid_argument const&);
+        std::stringstream garbage("not a diff");
+        REQUIRE_THROWS_AS(loaded.load(garbage), std::invalid_argument const&);
+        REQUIRE(loaded.empty());
+    }
+}
+
+TEST_CASE("Instrumentation") {
+    trie_stats().reset();
+    {
+        trie t({ "abc", "abd" });
+        REQUIRE(t.contains("abc"));
+        REQUIRE_FALSE(t.contains("b"));
+        REQUIRE(t.erase("abd"));
+        REQUIRE(t.search_by_prefix("ab").size() == 1);
+    }
+    const auto& stats = trie_stats();
+    const auto report = stats.report();
+    const auto json = stats.report_json();
+    REQUIRE(report.find("search_by_prefix") != std::string::npos);
+    REQUIRE(json.front() == '{');
+    REQUIRE(json.back() == '}');
+
+    if (trie_instrumentation_enabled) {
+        // root, a, b, c, d
+        REQUIRE(stats.allocations == 5);
+        REQUIRE(stats.frees == 5);
+        REQUIRE(stats.max_depth == 3);
+        REQUIRE(stats.node_visits > 0);
+        REQUIRE(stats.latency(trie_operation::insert).total() == 2);
+        REQUIRE(stats.latency(trie_operation::contains).total() == 2);
+        REQUIRE(stats.latency(trie_operation::erase).total() == 1);
+        REQUIRE(stats.latency(trie_operation::search_by_prefix).total() == 1);
+    } else {
+        REQUIRE(stats.allocations == 0);
+        REQUIRE(stats.node_visits == 0);
+        REQUIRE(stats.latency(trie_operation::insert).total() == 0);
+    }
+    trie_stats().reset();
+}
+
+TEST_CASE("DAWG") {
+    SECTION("Empty") {
+        trie t;
+        dawg d(t);
+        REQUIRE(d.empty());
+        REQUIRE(d.size() == 0);
+        REQUIRE_FALSE(d.contains(""));
+        REQUIRE(d.begin() == d.end());
+        REQUIRE(d.search_by_prefix("").empty());
+        REQUIRE(dawg().begin() == dawg().end());
+    }
+    SECTION("Contains the same strings as the trie") {
+        trie t({ "", "walk", "walks", "walked", "walking", "talk", "talks", "talked", "talking", "wal" });
+        dawg d(t);
+        REQUIRE(d.size() == t.size());
+        REQUIRE(std::vector<std::string>(d.begin(), d.end()) == extract_all(t));
+        for (const auto& str : { "", "walk", "talking", "wal" }) {
+            REQUIRE(d.contains(str));
+        }
+        for (const auto& str : { "w", "tal", "walki", "walkings", "x" }) {
+            REQUIRE_FALSE(d.contains(str));
+        }
+        REQUIRE(d.search_by_prefix("walk") == as_vec({ "walk", "walked", "walking", "walks" }));
+        REQUIRE(d.search_by_prefix("ta") == as_vec({ "talk", "talked", "talking", "talks" }));
+        REQUIRE(d.search_by_prefix("walks") == as_vec({ "walks" }));
+        REQUIRE(d.search_by_prefix("z").empty());
+    }
+    SECTION("Shared suffixes are stored once") {
+        trie t({ "walk", "walks", "walked", "walking", "talk", "talks", "talked", "talking" });
+        dawg d(t);
+        // "w" and "t" lead to the same state, all three endings share the final state
+        REQUIRE(d.source_node_count() == 21);
+        REQUIRE(d.node_count() == 9);
+        REQUIRE(d.memory_usage() < d.source_memory_usage());
+    }
+    SECTION("Iterators") {
+        trie t({ "a", "ab", "b" });
+        dawg d(t);
+        auto it = d.begin();
+        REQUIRE(*it++ == "a");
+        REQUIRE(it->size() == 2);
+        REQUIRE(*++it == "b");
+        REQUIRE(++it == d.end());
+    }
+    SECTION("Random data") {
+        trie t{ generate_data(1000) };
+        dawg d(t);
+        REQUIRE(std::vector<std::string>(d.begin(), d.end()) == extract_all(t));
+        for (const auto& str : t) {
+            REQUIRE(d.contains(str));
+        }
+    }
+}
+
+TEST_CASE("Iterator") {
+    SECTION("Default constructed iterators are equal") {
+        trie::const_iterator iter1, iter2;
+        REQUIRE(iter1 == iter2);
+    }
+    trie t({ "abc", "bcd", "cde", "edf" });
+    auto it = t.begin();
+    auto et = t.end();
+    SECTION("End iterator and default constructed iterator are equal") {
+        trie::const_iterator iter;
+        REQUIRE(iter == et);
+    }
+    SECTION("Prefix increment") {
+        REQUIRE(it != et);
+        REQUIRE(*it == "abc");
+        ++it;
+        REQUIRE(it != et);
+        REQUIRE(*it == "bcd");
+        ++it;
+
+        REQUIRE(it != et);
+        REQUIRE(*it == "cde");
+        ++it;
+
+        REQUIRE(it != et);
+        REQUIRE(*it == "edf");
+        ++it;
+
+        REQUIRE(it == et);
+    }
+    SECTION("Postfix increment") {
+        REQUIRE(it != et);
+        REQUIRE(*it == "abc");
+        it++;
+        REQUIRE(it != et);
+        REQUIRE(*it == "bcd");
+        it++;
+
+        REQUIRE(it != et);
+        REQUIRE(*it == "cde");
+        it++;
+
+        REQUIRE(it != et);
+        REQUIRE(*it == "edf");
+        it++;
+
+        REQUIRE(it == et);
+    }
+    SECTION("Iterator can be reused") {
+        auto it2 = it;
+        ++it;
+        REQUIRE(*it2 == "abc");
+        ++it;
+        REQUIRE(*it2 == "abc");
+        ++it;
+        REQUIRE(*it2 == "abc");
+        ++it2;
+        REQUIRE(*it2 == "bcd");
+    }
+    SECTION("Empty string handling") {
+        trie yes({ "", "a", "b", "aaa", "aab" });
+        auto it = yes.begin();
+        REQUIRE(*it == "");
+        trie no({ "a", "b", "aaa", "aab" });
+        it = no.begin();
+        REQUIRE(*it == "a");
+    }
+}
+
+TEST_CASE("Copy") {
+    SECTION("Copy constructor") {
+        SECTION("Verify that deep copy is performed") {
+            trie t1({ "a", "aa", "ab", "ad", "cd", "c", "q"});
+            trie t2(t1);
+            SECTION("Add to old trie") {
+                t1.insert("xXxXx");
+                VALIDATE_SETS(extract_all(t1), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "xXxXx" }));
+                VALIDATE_SETS(extract_all(t2), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q" }));
+            }
+            SECTION("Add to new trie") {
+                t2.insert("xXxXx");
+                VALIDATE_SETS(extract_all(t1), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q" }));
+                VALIDATE_SETS(extract_all(t2), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "xXxXx" }));
+            }
+            SECTION("Add to both tries") {
+                t1.insert("xXxXx");
+                t2.insert("YYY");
+                VALIDATE_SETS(extract_all(t1), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "xXxXx" }));
+                VALIDATE_SETS(extract_all(t2), as_vec({ "a", "aa", "ab", "ad", "cd", "c", "q", "YYY" }));
+            }
+        }
+        SECTION("Copying an empty trie must work properly") {
+            trie t1;
+            trie t2(t1);
+            REQUIRE(t1.empty());
+            REQUIRE(t2.empty());
+        }
+    }
+    SECTION("Copy assignment") {
+        trie t1({"a", "b", "c", "d"});
+        trie t2({"A", "B", "C", "D"});
+        SECTION("Simple assignment") {
+            t1 = t2;
+            VALIDATE_SETS(extract_all(t1), as_vec({ "A", "B", "C", "D" }));
+            VALIDATE_SETS(extract_all(t2), as_vec({ "A", "B", "C", "D" }));
+        }
+        SECTION("Self assignment") {
+            t1 = t1;
+            VALIDATE_SETS(extract_all(t1), as_vec({ "a", "b", "c", "d" }));
+            REQUIRE(t1.size() == 4);
+        }
+        SECTION("Repeated assignments") {
+            t2 = t1;
+            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d" }));
+            t1.insert("A");
+            t2 = t1;
+            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A" }));
+            t1.insert("B");
+            t2 = t1;
+            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A", "B" }));
+            t1.insert("C");
+            t2 = t1;
+            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A", "B", "C" }));
+            t1.insert("D");
+            t2 = t1;
+            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "A", "B", "C", "D" }));
+        }
+    }
+}
+
+TEST_CASE("Move operations") {
+    SECTION("Move constructor") {
+        SECTION("From an empty trie") {
+            trie t1;
+            trie t2(std::move(t1));
+            REQUIRE(t2.empty());
+        }
+        SECTION("From non-empty trie") {
+            trie t1({ "a", "b", "c", "d", "e" });
+            trie t2(std::move(t1));
+            VALIDATE_SETS(extract_all(t2), as_vec({ "a", "b", "c", "d", "e" }));
+        }
+    }
+    SECTION("Move assignment") {
+        SECTION("From empty trie") {
+            trie t1;
+            SECTION("To empty trie") {
+                trie t2;
+                t2 = std::move(t1);
+                REQUIRE(t2.empty());
+            }
+            SECTION("To non-empty trie") {
+                trie t2({"a", "b", "c", "d", "e"});
+                t2 = std::move(t1);
+                REQUIRE(t2.empty());
+            }
+        }
+        SECTION("From non-empty trie") {
+            trie t1({ "ab", "bc", "deg" });
+            SECTION("To empty trie") {
+                trie t2;
+                t2 = std::move(t1);
+                VALIDATE_SETS(extract_all(t2), as_vec({ "ab", "bc", "deg" }));
+            }
+            SECTION("To non-empty trie") {
+                trie t2({"kfa", "bfg", "id"});
+                t2 = std::move(t1);
+                VALIDATE_SETS(extract_all(t2), as_vec({ "ab", "bc", "deg" }));
+            }
+        }
+        SECTION("Back and forth") {
+            trie t1({ "abc", "def", "eee" });
+            trie t2({ "qwertz", "qwerty", "azerty" });
+            t1 = std::move(t2);
+            VALIDATE_SETS(extract_all(t1), as_vec({ "qwertz", "qwerty", "azerty" }));
+
+            t2 = std::move(t1);
+            VALIDATE_SETS(extract_all(t2), as_vec({ "qwertz", "qwerty", "azerty" }));
+
+            SECTION("Trie can be used after being move assigned-to") {
+                REQUIRE(t2.erase("azerty"));
+                REQUIRE(t2.insert("qzerty"));
+                VALIDATE_SETS(extract_all(t2), as_vec({ "qwertz", "qwerty", "qzerty" }));
+            }
+        }
+    }
+}
+
+TEST_CASE("member swap") {
+    SECTION("Swapping empty tries leaves both empty") {
+        trie t1, t2;
+        t1.swap(t2);
+        REQUIRE(t1.empty());
+        REQUIRE(t1.empty());
+    }
+    SECTION("Swapping tries actually swaps elements") {
+        trie t1({ "azerty", "qwerty", "qwertz" });
+        SECTION("Non-empty and empty trie") {
+            trie t2;
+            t1.swap(t2);
+            REQUIRE(t1.empty());
+            VALIDATE_SETS(extract_all(t2), as_vec({ "azerty", "qwerty", "qwertz" }));
+
+            SECTION("Roundtrip") {
+                t2.swap(t1);
+                REQUIRE(t2.empty());
+                VALIDATE_SETS(extract_all(t1), as_vec({"azerty", "qwerty", "qwertz"}));
+            }
+        }
+        SECTION("Non-empty and non-empty trie") {
+            trie t2({ "qzerty", "querty", "awerty" });
+            t1.swap(t2);
+            VALIDATE_SETS(extract_all(t1), as_vec({"qzerty", "querty", "awerty"}));
+            VALIDATE_SETS(extract_all(t2), as_vec({"azerty", "qwerty", "qwertz"}));
+
+            SECTION("Roundtrip") {
+                t1.swap(t2);
+                VALIDATE_SETS(extract_all(t1), as_vec({ "azerty", "qwerty", "qwertz" }));
+                VALIDATE_SETS(extract_all(t2), as_vec({ "qzerty", "querty", "awerty" }));
+            }
+        }
+    }
+}
+
+TEST_CASE("member swap -- complexity", "[.long]") {
+    // Swap should take constant time regardless of trie size.
+    using namespace std::chrono_literals;
+    double last_time = 0;
+    auto remove_duplicates = [] (std::vector<std::string> data) {
+        std::sort(begin(data), end(data));
+        data.erase(std::unique(begin(data), end(data)),
+                   end(data));
+        return data;
+    };
+    for (size_t i = 1'000; i <= 128'000; i *= 2) {
+        auto lhs_elems = remove_duplicates(generate_data(i));
+        trie lhs{ lhs_elems };
+        auto rhs_elems = remove_duplicates(generate_data(i));
+        trie rhs{ rhs_elems };
+        auto start_time = std::chrono::high_resolution_clock::now();
+        lhs.swap(rhs);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        // Add 0.5 ms to even out variability
+        auto time_diff = end_time - start_time + 500us;
+        auto total_time = static_cast<double>(time_diff.count());
+        VALIDATE_SETS(extract_all(lhs), rhs_elems);
+        VALIDATE_SETS(extract_all(rhs), lhs_elems);
+
+        if (last_time) {
+            // The coefficient is a rough approximation.
+            // A linear time coefficient should blow out, constant time
+            // jitter should remain inside some reasonable coefficient
+            REQUIRE(total_time / last_time <= 1.25);
+        }
+        last_time = total_time;
+        std::cout << "member swap: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
+    }
+}
+
+TEST_CASE("Trie union") {
+    trie t1, t2;
+    SECTION("Empty tries") {
+        auto res = t1 | t2;
+        CHECK(res.empty());
+        REQUIRE(res.size() == 0);
+    }
+    SECTION("One trie empty") {
+        t1 = trie({ "aa", "aab", "aabb", "zzz" });
+        SECTION("LHS trie empty") {
+            auto res = t2 | t1;
+            CHECK(res.size() == 4);
+            REQUIRE(res == t1);
+        }
+        SECTION("RHS trie empty") {
+            auto res = t1 | t2;
+            CHECK(res.size() == 4);
+            REQUIRE(res == t1);
+        }
+    }
+    SECTION("No empty tries") {
+        t1 = trie({ "queue", "quiz", "quizzical", "quilt" });
+        SECTION("Identical tries") {
+            auto res = t1 | t1;
+            CHECK(res.size() == 4);
+            REQUIRE(res == t1);
+        }
+        SECTION("Overlapping tries") {
+            t2 = trie({"quilt", "queue", "quitter"});
+            auto res = t1 | t2;
+            CHECK(res.size() == 5);
+            REQUIRE(res == trie({"queue", "quiz", "quizzical", "quilt", "quitter"}));
+        }
+        SECTION("Distinct tries") {
+            t2 = trie({"abra", "kadabra","abrakadabra"});
+            auto res = t1 | t2;
+            CHECK(res.size() == 7);
+            REQUIRE(res == trie({"queue", "quiz", "quizzical", "quilt", "abra", "kadabra", "abrakadabra"}));
+        }
+    }
+    SECTION("Chained unions") {
+        t1 = trie({"aaa", "bbb", "ccc"});
+        t2 = trie({"bbb", "ccc", "ddd"});
+        trie t3({"eee", "fff", "ggg"});
+        trie t4({"ggg", "hhh", "iii"});
+        auto res = t1 | t2 | t3 | t4;
+        CHECK(res.size() == 9);
+        REQUIRE(res == trie({"aaa", "bbb", "ccc", "ddd", "eee", "fff", "ggg", "hhh" ,"iii"}));
+    }
+}
+
+TEST_CASE("Trie intersection") {
+    trie t1, t2;
+    SECTION("Empty tries") {
+        auto res = t1 & t2;
+        CHECK(res.empty());
+        REQUIRE(res.size() == 0);
+    }
+    SECTION("One trie empty") {
+        t1 = trie({ "aa", "aab", "aabb", "zzz" });
+        SECTION("LHS trie empty") {
+            auto res = t2 & t1;
+            CHECK(res.size() == 0);
+            REQUIRE(res == t2);
+        }
+        SECTION("RHS trie empty") {
+            auto res = t1 & t2;
+            CHECK(res.size() == 0);
+            REQUIRE(res == t2);
+        }
+    }
+    SECTION("No empty tries") {
+        t1 = trie({ "queue", "quiz", "quizzical", "quilt" });
+        SECTION("Identical tries") {
+            auto res = t1 & t1;
+            CHECK(res.size() == 4);
+            REQUIRE(res == t1);
+        }
+        SECTION("Overlapping tries") {
+            t2 = trie({ "quilt", "queue", "quitter" });
+            auto res = t1 & t2;
+            CHECK(res.size() == 2);
+            REQUIRE(res == trie({ "queue", "quilt" }));
+        }
+        SECTION("Distinct tries") {
+            t2 = trie({ "abra", "kadabra","abrakadabra" });
+            auto res = t1 & t2;
+            CHECK(res.size() == 0);
+            REQUIRE(res == trie{});
+        }
+    }
+    SECTION("Chained intersections") {
+        t1 = trie({ "aaa", "bbb", "ccc", "ddd" });
+        t2 = trie({ "bbb", "ccc", "ddd", "eee" });
+        trie t3({ "ccc", "ddd", "eee", "fff" });
+        trie t4({ "ddd", "eee", "fff", "ggg" });
+        auto res = t1 & t2 & t3 & t4;
+        CHECK(res.size() == 1);
+        REQUIRE(res == trie({ "ddd" }));
+    }
+}
+
+TEST_CASE("Trie comparisons") {
+    REQUIRE(trie{} == trie{});
+    REQUIRE(trie({ "a", "ab" }) == trie({ "ab", "a" }));
+    REQUIRE(trie({ "a", "ab" }) != trie({ "a", "abc" }));
+    REQUIRE(trie({ "" }) != trie{});
+    REQUIRE(trie{} < trie({ "" }));
+    REQUIRE(trie({ "" }) < trie({ "a" }));
+    REQUIRE(trie({ "a" }) < trie({ "a", "b" }));
+    REQUIRE(trie({ "a", "c" }) > trie({ "a", "b", "c" }));
+    REQUIRE(trie({ "ab" }) < trie({ "b" }));
+    REQUIRE_FALSE(trie({ "a" }) < trie({ "a" }));
+    REQUIRE(trie({ "a" }) <= trie({ "a" }));
+
+    // compare the same way as sorted vectors of the strings do
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(0, 3);
+    auto random_words = [&] {
+        std::vector<std::string> words;
+        for (size_t i = length(gen) + length(gen); i > 0; --i) {
+            std::string word;
+            for (size_t j = length(gen); j > 0; --j) {
+                word.push_back(static_cast<char>(letter(gen)));
+            }
+            words.push_back(word);
+        }
+        return words;
+    };
+    for (int i = 0; i < 2'000; ++i) {
+        trie lhs{ random_words() };
+        trie rhs{ random_words() };
+        auto l = extract_all(lhs);
+        auto r = extract_all(rhs);
+        REQUIRE((lhs == rhs) == (l == r));
+        REQUIRE((lhs < rhs) == (l < r));
+        REQUIRE((rhs < lhs) == (r < l));
+    }
+}
+
+TEST_CASE("Set operations with rvalues") {
+    const std::vector<std::string> left = { "", "queue", "quiz", "quizzical", "quilt", "abra" };
+    const std::vector<std::string> right = { "quilt", "queue", "quitter", "kadabra", "q" };
+    const trie expected_union({ "", "queue", "quiz", "quizzical", "quilt", "abra", "quitter", "kadabra", "q" });
+    const trie expected_intersection({ "queue", "quilt" });
+    const trie t1{ left };
+    const trie t2{ right };
+
+    SECTION("Union") {
+        REQUIRE((t1 | t2) == expected_union);
+        REQUIRE((trie{ left } | t2) == expected_union);
+        REQUIRE((t1 | trie{ right }) == expected_union);
+        REQUIRE((trie{ left } | trie{ right }) == expected_union);
+        REQUIRE((trie{ left } | trie{ right }).size() == expected_union.size());
+    }
+    SECTION("Intersection") {
+        REQUIRE((t1 & t2) == expected_intersection);
+        REQUIRE((trie{ left } & t2) == expected_intersection);
+        REQUIRE((t1 & trie{ right }) == expected_intersection);
+        REQUIRE((trie{ left } & trie{ right }) == expected_intersection);
+        REQUIRE((trie{ left } & trie{ right }).size() == expected_intersection.size());
+    }
+    SECTION("Compound assignment") {
+        trie t{ left };
+        t |= t2;
+        REQUIRE(t == expected_union);
+        REQUIRE(t.size() == expected_union.size());
+        t &= t2;
+        REQUIRE(t == t2);
+        REQUIRE(t.size() == t2.size());
+        t &= trie({ "queue" });
+        REQUIRE(extract_all(t) == as_vec({ "queue" }));
+        t &= trie{};
+        REQUIRE(t.empty());
+        REQUIRE(t.memory_usage().node_count == 1);
+        REQUIRE(t2.size() == right.size());
+
+        t |= trie{ left };
+        t |= t;
+        REQUIRE(t == t1);
+        t &= t;
+        REQUIRE(t == t1);
+    }
+    SECTION("merge_from") {
+        trie t{ left };
+        trie other{ right };
+        t.merge_from(std::move(other));
+        REQUIRE(t == expected_union);
+        REQUIRE(t.size() == expected_union.size());
+        REQUIRE(other.empty());
+        REQUIRE(other.memory_usage().node_count == 1);
+        REQUIRE(extract_all(other).empty());
+        other.insert("x");
+        REQUIRE(extract_all(other) == as_vec({ "x" }));
+        t.merge_from(std::move(t));
+        REQUIRE(t == expected_union);
+    }
+    SECTION("Counts") {
+        trie lhs, rhs;
+        lhs.add("a", 2);
+        lhs.add("b", 5);
+        lhs.add("", 1);
+        rhs.add("a", 3);
+        rhs.add("b", 1);
+        rhs.add("c", 4);
+        auto both = lhs | rhs;
+        REQUIRE(both.count("a") == 5);
+        REQUIRE(both.count("c") == 4);
+        REQUIRE(both.count("") == 1);
+        auto common = lhs & rhs;
+        REQUIRE(common.count("a") == 2);
+        REQUIRE(common.count("b") == 1);
+        REQUIRE(common.count("c") == 0);
+        lhs |= rhs;
+        REQUIRE(lhs.count("b") == 6);
+        lhs &= rhs;
+        REQUIRE(lhs.count("b") == 1);
+        REQUIRE(lhs.count("a") == 3);
+    }
+    SECTION("Indexes follow in-place operations") {
+        trie t{ left };
+        t.set_index_mode(trie_index_mode::reversed);
+        t |= t2;
+        REQUIRE(t.search_by_suffix("abra") == as_vec({ "abra", "kadabra" }));
+        t &= t2;
+        REQUIRE(t.search_by_suffix("abra") == as_vec({ "kadabra" }));
+        t.merge_from(trie{ left });
+        REQUIRE(t.search_by_suffix("abra") == as_vec({ "abra", "kadabra" }));
+    }
+}
+
+TEST_CASE("Trie intersection - complexity", "[.long]") {
+    using namespace std::chrono_literals;
+    double last_time = 0;
+    auto add_prefix = [] (std::vector<std::string> const& strings, std::string const& prefix) {
+        std::vector<std::string> results;
+        for (auto const& str : strings) {
+            results.push_back(prefix + str);
+        }
+        return results;
+    };
+    // The idea:
+    // Naive implementation of intersection would be to extract all strings
+    // in the tries and then perform intersection over vector<string>.
+    // Given 2 tries, one with all words prefixed with 'a' and second
+    // with all words prefixed with 'z', this would lead to linear complexity
+    // However, proper implementation should intersect such tries in constant time
+    for (size_t i = 1'000; i <= 64'000; i *= 2) {
+        auto lhs_elems = add_prefix(generate_data(i), "aaa");
+        trie lhs{ lhs_elems };
+        auto rhs_elems = add_prefix(generate_data(i), "zzz");
+        trie rhs{ rhs_elems };
+        auto start_time = std::chrono::high_resolution_clock::now();
+        auto res = lhs & rhs;
+        auto end_time = std::chrono::high_resolution_clock::now();
+        // Add 0.5 ms to even out variability
+        auto time_diff = end_time - start_time + 500us;
+        auto total_time = static_cast<double>(time_diff.count());
+        REQUIRE(res == trie{});
+
+        if (last_time) {
+            // The coefficient is a rough approximation.
+            // A linear time coefficient should blow out, constant time
+            // jitter should remain inside some reasonable coefficient
+            REQUIRE(total_time / last_time <= 1.25);
+        }
+        last_time = total_time;
+        std::cout << "Trie intersection: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
+    }
+}
@@ -1,696 +1,2501 @@
-#include "trie.hpp"
-
-#include <utility>
-#include <algorithm>
-
-using namespace std;
-
-
-//
-// VLASTN FUNKCE A PROMNN (TRIE1)
-
-
-bool insertAsChild(trie_node *subTrie, const string &str)
-{
-	if (str.empty())
-	{
-		return false;
-	}
-	else if (str.size() == 1)
-	{
-		int i = 0;
-
-		while ((bool)subTrie->children[i] == true)
-		{
-			if (subTrie->children[i]->payload == str.at(0))
-			{
-				if (subTrie->children[i]->is_terminal)
-				{
-					return false;
-				}
-				else
-				{
-					subTrie->children[i]->is_terminal = true;
-					return true;
-				}
-			}
-			i++;
-		}
-
-		// jsme na konci a prvek jet neexistuje -> vlo ho
-		trie_node * newNode = new trie_node;
-		newNode->is_terminal = true;
-		newNode->parent = subTrie;
-		newNode->payload = str.at(0);
-		subTrie->children[i] = newNode;
-		return true;
-	}
-	else
-	{
-		int i = 0;
-
-		while ((bool)subTrie->children[i] == true)
-		{
-			if (subTrie->children[i]->payload == str.at(0))
-			{
-				return insertAsChild(subTrie->children[i], str.substr(1, str.size() - 1));
-			}
-			i++;
-		}
-
-		// chyb vtev se znakem -> vlo chybjc znak a pokrauje ve vtvi
-		trie_node * newNode = new trie_node;
-		newNode->is_terminal = false;
-		newNode->parent = subTrie;
-		newNode->payload = str.at(0);
-		subTrie->children[i] = newNode;
-
-		return insertAsChild(newNode, str.substr(1, str.size() - 1));
-	}
-}
-
-
-bool findInChildren(trie_node * subTrie, const string & str)
-{
-	if (str.size() == 0)
-	{
-		return false;
-	}
-	else if (str.size() == 1)
-	{
-		int i = 0;
-
-		while ((bool)subTrie->children[i] == true)
-		{
-			if ((subTrie->children[i]->payload == str.at(0)) && subTrie->children[i]->is_terminal)
-			{
-				return true;
-			}
-			i++;
-		}
-
-		return false;
-	}
-	else
-	{
-		int i = 0;
-
-		while ((bool)subTrie->children[i] == true)
-		{
-			if (subTrie->children[i]->payload == str.at(0))
-			{
-				return findInChildren(subTrie->children[i], str.substr(1, str.size() - 1));
-			}
-
-			i++;
-		}
-
-		return false;
-	}
-}
-
-
-bool deleteWordFromChildren(trie_node *subTrie, const string &str)
-{
-	if (str.empty())
-	{
-		return false;
-	}
-	else if (str.size() == 1)
-	{
-		int i = 0;
-
-		while (subTrie->children[i])
-		{
-			if (subTrie->children[i]->payload == str.at(0))
-			{
-				subTrie->children[i]->is_terminal = false;
-				return true;
-			}
-
-			i++;
-		}
-
-		return false;
-	}
-	else
-	{
-		int i = 0;
-
-		while (subTrie->children[i])
-		{
-			if (subTrie->children[i]->payload == str.at(0))
-			{
-				return deleteWordFromChildren(subTrie->children[i], str.substr(1, str.size() - 1));
-			}
-
-			i++;
-		}
-
-		return false;
-	}
-}
-
-
-//
-// VLASTN FUNKCE A PROMNN (TRIE2)
-
-
-vector<string> findMoreWordsByPrefix(vector<string> vector, trie_node * node, string prefix)
-{
-	if (node->is_terminal)
-	{
-		vector.push_back(prefix);
-	}
-
-	for (int i = 0; i < num_chars; i++)
-	{
-		if (node->children[i] != nullptr)
-		{
-			prefix.push_back(node->children[i]->payload);
-			vector = findMoreWordsByPrefix(vector, node->children[i], prefix);
-			prefix.pop_back();
-		}
-	}
-
-	return vector;
-}
-
-
-const trie_node * goInside(trie_node * node)
-{
-	if (node->is_terminal)
-	{
-		return node;
-	}
-
-	for (int i = 0; i < num_chars; i++)
-	{
-		if (node->children[i] != nullptr)
-		{
-			if (node->children[i]->is_terminal)
-			{
-				return node->children[i];
-			}
-
-			node = node->children[i];
-			i = -1;
-		}
-	}
-
-	return node;
-}
-
-
-const trie_node * addNextWord(const trie_node * node)
-{
-	bool next = false;
-
-	for (int i = 0; i < num_chars; i++)
-	{
-		if (node->children[i] != nullptr)
-		{
-			node = node->children[i];
-
-			if (node->is_terminal)
-			{
-				return node;
-			}
-
-			i = -1;
-		}
-	}
-
-	while (node->parent != nullptr)
-	{
-		for (int i = 0; i < num_chars; i++)
-		{
-			if (next && (node->parent->children[i] != nullptr))
-			{
-				return goInside(node->parent->children[i]);
-			}
-
-			if (node->parent->children[i] == node)
-			{
-				next = true;
-			}
-		}
-
-		node = node->parent;
-		next = false;
-	}
-
-	return nullptr;
-}
-
-
-//
-// VLASTN FUNKCE A PROMNN (TRIE3)
-
-void deleteTrie(trie_node * node)
-{
-	for (int i = 0; i < num_chars; ++i)
-	{
-		if (node->children[i])
-		{
-			deleteTrie(node->children[i]);
-		}
-	}
-
-	if (node != nullptr)
-	{
-		delete node;
-	}
-}
-
-
-trie_node * goToNodeByWord(trie_node * node, string str)
-{
-	if ((node->payload == str.at(0)) && (str.length() == 1))
-	{
-		return node;
-	}
-	
-	for (int i = 0; i < str.length(); i++)
-	{
-		for (int j = 0; j < num_chars; j++)
-		{
-			if (node->children[j] && node->children[j]->payload == str.at(i))
-			{
-				node = node->children[j];
-			}
-		}
-	}
-	
-	return node;
-}
-
-
-void cleanUpTrie(trie * t, trie_node * root, string str)
-{
-	if (t->search_by_prefix(str).size() == 0)
-	{
-		trie_node * foo = goToNodeByWord(root, str);
-		trie_node * next = foo->parent;
-		
-		for (int i = 0; i < num_chars; i++)
-		{
-			if (next->children[i] == foo)
-			{
-				next->children[i] = nullptr;
-				break;
-			}
-		}
-
-		delete foo;
-
-		str = str.substr(0, str.size() - 1);
-
-		if (str.length() > 0)
-		{
-			cleanUpTrie(t, root, str);
-		}
-	}
-}
-
-
-// 
-// FUNKCE A PROMNN PODLE "TRIE.HPP" - TRIE 3
-
-
-trie::trie()
-{
-	m_root = new trie_node();
-	m_size = 0;
-}
-
-
-trie::trie(const vector<string>& strings)
-{
-	m_root = new trie_node();
-	m_size = 0;
-	
-	for (int i = 0; i < strings.size(); i++)
-	{
-		insert(strings[i]);
-	}
-}
-
-
-trie::trie(trie&& rhs)
-{
-	m_root = new trie_node();
-	m_size = 0;
-	
-	vector<string> listOfWords = rhs.search_by_prefix("");
-
-	if (rhs.m_root->payload == ' ')
-	{
-		listOfWords.push_back("");
-	}
-
-	for (string word : listOfWords)
-	{
-		insert(word);
-	}
-}
-
-
-trie::trie(const trie& rhs)
-{
-	vector<string> listOfWords = rhs.search_by_prefix("");
-
-	if (rhs.m_root->payload == ' ')
-	{
-		listOfWords.push_back("");
-	}
-
-	m_root = new trie_node();
-	m_size = 0;
-
-	for (string word : listOfWords)
-	{
-		insert(word);
-	}
-}
-
-
-trie::~trie()
-{
-	trie_node * foo = m_root;
-	deleteTrie(foo);
-
-	m_size = 0;
-	m_root = nullptr;
-}
-
-
-bool trie::insert(const string& str)
-{
-	if (str.empty() && (m_root->payload != ' '))
-	{
-		m_root->payload = ' ';
-		m_size++;
-	}
-
-	if (insertAsChild(m_root, str))
-	{
-		m_size++;
-		return true;
-	}
-
-	return false;
-}
-
-
-bool trie::erase(const string& str)
-{
-	if (findInChildren(m_root, str) && deleteWordFromChildren(m_root, str))
-	{
-		m_size--;
-		cleanUpTrie(this, m_root, str);
-		return true;
-	}
-
-	return false;
-
-
-}
-
-
-bool trie::contains(const string& str) const
-{
-	if (str.empty() && (m_root->payload == ' '))
-	{
-		return true;
-	}
-	return findInChildren(m_root, str);
-}
-
-
-size_t trie::size() const
-{
-	return m_size;
-}
-
-
-bool trie::empty() const
-{
-	return m_size == 0;
-}
-
-
-vector<string> trie::search_by_prefix(const string& str) const
-{
-	vector<string> words = {};
-	string phrase = "";
-
-	int i = 0;
-	bool found = false;
-	trie_node * foo = m_root;
-
-	while (str[i] != '\0')
-	{
-		for (int j = 0; j < num_chars; j++)
-		{
-			if (foo->children[j] != nullptr && foo->children[j]->payload == str[i])
-			{
-				foo = foo->children[j];
-				phrase.push_back(str[i]);
-				found = true;
-				break;
-			}
-		}
-
-		if (found)
-		{
-			found = false;
-			i++;
-		}
-		else
-		{
-			return words;
-		}
-	}
-
-	return findMoreWordsByPrefix(words, foo, phrase);
-}
-
-
-vector<string> trie::get_prefixes(const string & str) const
-{
-	vector<string> prefixes;
-
-	for (int i = str.size(); i > 0; i--)
-	{
-		if (findInChildren(m_root, str.substr(0, i)))
-		{
-			prefixes.push_back(str.substr(0, i));
-		}
-	}
-
-	return prefixes;
-}
-
-
-trie::const_iterator trie::begin() const
-{
-	const trie_node * foo = m_root;
-
-	if (m_root->payload == ' ')
-	{
-		return const_iterator(m_root);
-	}
-	else
-	{
-		for (int i = 0; i < num_chars; i++)
-		{
-			if (foo->children[i] != nullptr)
-			{
-				if (foo->children[i]->is_terminal)
-				{
-					return const_iterator(foo->children[i]);
-				}
-				
-				foo = foo->children[i];
-				i = -1;
-			}
-		}
-	}
-}
-
-
-trie::const_iterator trie::end() const
-{
-    return const_iterator(nullptr);
-}
-
-
-void trie::swap(trie& rhs)
-{
-	trie_node * fooNode = m_root;
-	m_root = rhs.m_root;
-	rhs.m_root = fooNode;
-
-	size_t fooSize = m_size;
-	m_size = rhs.m_size;
-	rhs.m_size = fooSize;
-}
-
-
-void swap(trie& lhs, trie& rhs)
-{
-	lhs.swap(rhs);
-}
-
-
-trie& trie::operator=(const trie& rhs)
-{
-	vector<string> listOfWords = rhs.search_by_prefix("");
-
-	if (rhs.m_root->payload == ' ')
-	{
-		listOfWords.push_back("");
-	}
-
-	deleteTrie(m_root);
-	m_root = new trie_node();
-	m_size = 0;
-
-	for (string word : listOfWords)
-	{
-		this->insert(word);
-	}
-
-	return * this;
-}
-
-
-trie& trie::operator=(trie&& rhs)
-{
-	deleteTrie(m_root);
-	m_root = new trie_node();
-	m_size = 0;
-	
-	vector<string> listOfWords = rhs.search_by_prefix("");
-
-	if (rhs.m_root->payload == ' ')
-	{
-		listOfWords.push_back("");
-	}
-
-	for (string word : listOfWords)
-	{
-		this->insert(word);
-	}
-
-	return *this;
-}
-
-
-bool trie::operator==(const trie& rhs) const
-{
-    // TODO
-	return true;
-}
-
-
-bool trie::operator<(const trie& rhs) const
-{
-	// TODO
-	return false;
-}
-
-
-trie trie::operator&(trie const& rhs) const
-{
-	// TODO
-	return {};
-}
-
-
-trie trie::operator|(trie const& rhs) const
-{
-	// TODO
-	return {};
-}
-
-
-bool operator!=(const trie& lhs, const trie& rhs)
-{
-	return !(lhs == rhs);
-}
-
-
-bool operator>(const trie& lhs, const trie& rhs)
-{
-	return rhs < lhs;
-}
-
-
-bool operator<=(const trie& lhs, const trie& rhs)
-{
-	return !(lhs > rhs);
-}
-
-
-bool operator>=(const trie& lhs, const trie& rhs)
-{
-	return !(lhs < rhs);
-}
-
-
-ostream& operator<<(ostream& out, trie const& trie)
-{
-    return out;
-}
-
-
-//
-// CONST ITERATOR
-
-trie::const_iterator& trie::const_iterator::operator++()
-{
-	current_node = addNextWord(current_node);
-	return *this;
-}
-
-
-trie::const_iterator trie::const_iterator::operator++(int)
-{
-	operator++();
-	return *this;
-}
-
-
-trie::const_iterator::const_iterator(const trie_node* node)
-{
-	current_node = node;
-}
-
-
-bool trie::const_iterator::operator==(const trie::const_iterator& rhs) const
-{
-    return current_node == rhs.current_node;
-}
-
-
-bool trie::const_iterator::operator!=(const trie::const_iterator& rhs) const
-{
-    return current_node != rhs.current_node;
-}
-
-
-trie::const_iterator::reference trie::const_iterator::operator*() const
-{
-	const trie_node * foo = current_node;
-	string result = "";
-
-	while (foo->parent != nullptr)
-	{
-		result = foo->payload + result;
-		foo = foo->parent;
-	}
-
-	return result;
-}
+#include "trie.hpp"
+#include "trie-stats.hpp"
+#include "trie-labels.hpp"
+
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <istream>
+#include <ostream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+
+static_assert(num_chars % labels::block_size == 0, "labels of a node must be padded for vector loads");
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (TRIE1)
+
+
+// Children of every node are kept ordered by payload, so that strings
+// are iterated in lexicographical order. Compares as unsigned char,
+// same as std::string does.
+bool isAfter(char payload, char c)
+{
+	return static_cast<unsigned char>(payload) > static_cast<unsigned char>(c);
+}
+
+
+// Inserts child to given slot, children from the slot onwards are shifted one slot to the right
+void insertChildAt(trie_node * node, int slot, trie_node * child)
+{
+	for (int i = node->child_count; i > slot; i--)
+	{
+		node->children[i] = node->children[i - 1];
+		node->labels[i] = node->labels[i - 1];
+	}
+
+	node->children[slot] = child;
+	node->labels[slot] = child->payload;
+	node->child_count++;
+}
+
+
+// Removes child from its parent, following children are shifted one slot to the left
+void removeChild(trie_node * node, const trie_node * child)
+{
+	int i = labels::find(node->labels, node->child_count, child->payload);
+
+	for (; i < node->child_count - 1; i++)
+	{
+		node->children[i] = node->children[i + 1];
+		node->labels[i] = node->labels[i + 1];
+	}
+
+	node->child_count--;
+	node->children[node->child_count] = nullptr;
+	node->labels[node->child_count] = 0;
+}
+
+
+// Inserts rest of str from position pos below subTrie
+bool insertAsChild(trie_node *subTrie, const string &str, size_t pos)
+{
+	TRIE_STATS_VISIT();
+
+	if (pos == str.size())
+	{
+		return false;
+	}
+
+	int i = static_cast<int>(labels::lower_bound(subTrie->labels, subTrie->child_count, str[pos]));
+	bool exists = i < subTrie->child_count && subTrie->labels[i] == str[pos];
+
+	if (pos + 1 == str.size())
+	{
+		if (exists)
+		{
+			if (subTrie->children[i]->is_terminal)
+			{
+				return false;
+			}
+			else
+			{
+				subTrie->children[i]->is_terminal = true;
+				subTrie->children[i]->words++;
+				subTrie->children[i]->count = 1;
+				return true;
+			}
+		}
+
+		// jsme na konci a prvek ještě neexistuje -> vloží ho
+		trie_node * newNode = new trie_node;
+		TRIE_STATS_ALLOCATION();
+		newNode->is_terminal = true;
+		newNode->words = 1;
+		newNode->count = 1;
+		newNode->payload = str[pos];
+		insertChildAt(subTrie, i, newNode);
+		return true;
+	}
+	else
+	{
+		if (!exists)
+		{
+			// chybí větev se znakem -> vloží chybějící znak a pokračuje ve větvi
+			trie_node * newNode = new trie_node;
+			TRIE_STATS_ALLOCATION();
+			newNode->is_terminal = false;
+			newNode->payload = str[pos];
+			insertChildAt(subTrie, i, newNode);
+		}
+
+		if (insertAsChild(subTrie->children[i], str, pos + 1))
+		{
+			subTrie->children[i]->words++;
+			return true;
+		}
+
+		return false;
+	}
+}
+
+
+bool findInChildren(trie_node * subTrie, const string & str)
+{
+	TRIE_STATS_VISIT();
+
+	if (str.size() == 0)
+	{
+		return false;
+	}
+	else if (str.size() == 1)
+	{
+		int i = 0;
+
+		while ((bool)subTrie->children[i] == true)
+		{
+			if ((subTrie->children[i]->payload == str.at(0)) && subTrie->children[i]->is_terminal)
+			{
+				return true;
+			}
+			i++;
+		}
+
+		return false;
+	}
+	else
+	{
+		int i = 0;
+
+		while ((bool)subTrie->children[i] == true)
+		{
+			if (subTrie->children[i]->payload == str.at(0))
+			{
+				return findInChildren(subTrie->children[i], str.substr(1, str.size() - 1));
+			}
+
+			i++;
+		}
+
+		return false;
+	}
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (TRIE2)
+
+
+// Appends all words from subtree of node to words, prefix holds the word of node
+void findMoreWordsByPrefix(vector<string> & words, const trie_node * node, string & prefix)
+{
+	TRIE_STATS_VISIT();
+
+	if (node->is_terminal)
+	{
+		words.push_back(prefix);
+	}
+
+	for (size_t i = 0; i < num_chars && node->children[i]; i++)
+	{
+		prefix.push_back(node->children[i]->payload);
+		findMoreWordsByPrefix(words, node->children[i], prefix);
+		prefix.pop_back();
+	}
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (TRIE3)
+
+void deleteTrie(trie_node * node)
+{
+	for (int i = 0; i < node->child_count; ++i)
+	{
+		deleteTrie(node->children[i]);
+	}
+
+	if (node != nullptr)
+	{
+		TRIE_STATS_FREE();
+		delete node;
+	}
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (BATCH LOOKUP)
+
+// Hints the CPU to start loading given address into the cache
+inline void prefetchNode(const void * address)
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+	__builtin_prefetch(address);
+#else
+	(void)address;
+#endif
+}
+
+
+trie_node * findChild(const trie_node * node, char c)
+{
+	TRIE_STATS_VISIT();
+
+	int i = labels::find(node->labels, node->child_count, c);
+	return i < 0 ? nullptr : node->children[i];
+}
+
+
+// State of one walk through the trie inside a batch
+struct batch_walk
+{
+	const trie_node * node;
+	size_t depth;
+	size_t index;
+};
+
+
+// Walks the trie along every string from strings, batch_size strings at a time.
+// Walks of one batch advance in lock-step by one level per round, every walk
+// moves one level down and prefetches labels and first children of the node
+// it reached, so that they are already loaded by the time the walk gets its
+// turn in the next round. Calls visit(index, depth, node) for every node reached.
+template <typename Visit>
+void walkInterleaved(const trie_node * root, const vector<string> & strings, size_t batch_size, Visit visit)
+{
+	if (batch_size == 0)
+	{
+		batch_size = 1;
+	}
+
+	vector<batch_walk> walks;
+	walks.reserve(batch_size);
+
+	for (size_t first = 0; first < strings.size(); first += batch_size)
+	{
+		size_t last = min(first + batch_size, strings.size());
+		walks.clear();
+
+		for (size_t i = first; i < last; i++)
+		{
+			if (!strings[i].empty())
+			{
+				walks.push_back({ root, 0, i });
+			}
+		}
+
+		while (!walks.empty())
+		{
+			size_t alive = 0;
+
+			for (size_t i = 0; i < walks.size(); i++)
+			{
+				batch_walk walk = walks[i];
+				const string & str = strings[walk.index];
+				const trie_node * next = findChild(walk.node, str[walk.depth]);
+
+				if (next == nullptr)
+				{
+					continue;
+				}
+
+				walk.node = next;
+				walk.depth++;
+				visit(walk.index, walk.depth, next);
+
+				if (walk.depth < str.size())
+				{
+					prefetchNode(next->labels);
+					prefetchNode(next->children);
+					walks[alive++] = walk;
+				}
+			}
+
+			walks.resize(alive);
+		}
+	}
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (ORDERED QUERIES)
+
+// Empty string is kept in the root instead of a terminal node
+bool hasEmptyWord(const trie_node * root)
+{
+	return root->payload == ' ';
+}
+
+
+// Finds i-th word of the trie, appends nodes on the way to it to path and
+// its characters to word. Every child of a node knows how many words its
+// subtree holds, so the whole subtrees before the wanted word are skipped.
+void selectPath(const trie_node * root, size_t i, vector<const trie_node *> & path, string & word)
+{
+	const trie_node * node = root;
+	path.push_back(root);
+
+	if (hasEmptyWord(root))
+	{
+		if (i == 0)
+		{
+			return;
+		}
+
+		i--;
+	}
+
+	while (true)
+	{
+		int j = 0;
+
+		while (i >= node->children[j]->words)
+		{
+			i -= node->children[j]->words;
+			j++;
+		}
+
+		node = node->children[j];
+		path.push_back(node);
+		word.push_back(node->payload);
+
+		if (node->is_terminal)
+		{
+			if (i == 0)
+			{
+				return;
+			}
+
+			i--;
+		}
+	}
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (SNAPSHOT)
+
+// Snapshot layout:
+//   "TRIE", format version, varint number of words
+//   one record per node in DFS preorder, starting with the root:
+//     varint payload (missing for the root)
+//     varint (number of children << 1) | is word
+// Children records directly follow the record of their parent.
+
+static const char snapshot_magic[] = { 'T', 'R', 'I', 'E' };
+static const char snapshot_version = 1;
+
+
+// Collects output and writes it to the stream in big chunks
+class snapshot_writer
+{
+public:
+	snapshot_writer(ostream & out) : out(out) {}
+
+	~snapshot_writer()
+	{
+		flush();
+	}
+
+	void put(char c)
+	{
+		buffer.push_back(c);
+
+		if (buffer.size() >= chunk_size)
+		{
+			flush();
+		}
+	}
+
+	void putVarint(size_t value)
+	{
+		while (value >= 0x80)
+		{
+			put(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+
+		put(static_cast<char>(value));
+	}
+
+	void flush()
+	{
+		out.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+
+private:
+	static const size_t chunk_size = 1 << 16;
+	ostream & out;
+	string buffer;
+};
+
+
+// Reads directly from the stream buffer, so that nothing after the snapshot is consumed.
+// Errors are reported as coming from given function.
+class snapshot_reader
+{
+public:
+	snapshot_reader(istream & in, const char * function = "trie::load") : buffer(in.rdbuf()), function(function) {}
+
+	char get()
+	{
+		int c = buffer ? buffer->sbumpc() : char_traits<char>::eof();
+
+		if (c == char_traits<char>::eof())
+		{
+			throw invalid_argument(string(function) + ": unexpected end of input");
+		}
+
+		return static_cast<char>(c);
+	}
+
+	size_t getVarint()
+	{
+		size_t value = 0;
+
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			unsigned char c = static_cast<unsigned char>(get());
+			value |= static_cast<size_t>(c & 0x7F) << shift;
+
+			if ((c & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+
+		throw invalid_argument(string(function) + ": malformed number in input");
+	}
+
+private:
+	streambuf * buffer;
+	const char * function;
+};
+
+
+void writeSnapshot(snapshot_writer & writer, const trie_node * root, size_t words)
+{
+	writer.put(snapshot_magic[0]);
+	writer.put(snapshot_magic[1]);
+	writer.put(snapshot_magic[2]);
+	writer.put(snapshot_magic[3]);
+	writer.put(snapshot_version);
+	writer.putVarint(words);
+
+	vector<const trie_node *> stack = { root };
+
+	while (!stack.empty())
+	{
+		const trie_node * node = stack.back();
+		stack.pop_back();
+
+		size_t children = 0;
+
+		while (children < num_chars && node->children[children])
+		{
+			children++;
+		}
+
+		if (node == root)
+		{
+			writer.putVarint((children << 1) | (root->payload == ' '));
+		}
+		else
+		{
+			writer.putVarint(static_cast<unsigned char>(node->payload));
+			writer.putVarint((children << 1) | node->is_terminal);
+		}
+
+		for (size_t i = children; i > 0; i--)
+		{
+			stack.push_back(node->children[i - 1]);
+		}
+	}
+}
+
+
+// Reads snapshot into an empty root, returns number of words read
+size_t readSnapshot(snapshot_reader & reader, trie_node * root)
+{
+	for (char c : snapshot_magic)
+	{
+		if (reader.get() != c)
+		{
+			throw invalid_argument("trie::load: not a trie snapshot");
+		}
+	}
+
+	if (reader.get() != snapshot_version)
+	{
+		throw invalid_argument("trie::load: unsupported snapshot version");
+	}
+
+	size_t words = reader.getVarint();
+
+	// nodes whose children are still being read, with the number of children left
+	vector<pair<trie_node *, size_t>> stack;
+
+	size_t header = reader.getVarint();
+	if ((header >> 1) > num_chars)
+	{
+		throw invalid_argument("trie::load: malformed node in snapshot");
+	}
+
+	if (header & 1)
+	{
+		root->payload = ' ';
+		root->words = 1;
+		root->count = 1;
+	}
+
+	stack.push_back({ root, header >> 1 });
+
+	while (!stack.empty())
+	{
+		trie_node * parent = stack.back().first;
+
+		if (stack.back().second == 0)
+		{
+			// all children of the node are read, its count is final
+			stack.pop_back();
+
+			if (!stack.empty())
+			{
+				// tries never keep branches without words, erase frees them
+				if (parent->words == 0)
+				{
+					throw invalid_argument("trie::load: malformed node in snapshot");
+				}
+
+				stack.back().first->words += parent->words;
+			}
+
+			continue;
+		}
+
+		stack.back().second--;
+
+		size_t payload = reader.getVarint();
+		size_t record = reader.getVarint();
+		size_t children = record >> 1;
+
+		if (payload >= num_chars || children > num_chars)
+		{
+			throw invalid_argument("trie::load: malformed node in snapshot");
+		}
+
+		int slot = parent->child_count;
+
+		if (slot == num_chars)
+		{
+			throw invalid_argument("trie::load: malformed node in snapshot");
+		}
+
+		if (slot > 0 && !isAfter(static_cast<char>(payload), parent->labels[slot - 1]))
+		{
+			throw invalid_argument("trie::load: children in snapshot are not ordered");
+		}
+
+		trie_node * node = new trie_node;
+		TRIE_STATS_ALLOCATION();
+		node->payload = static_cast<char>(payload);
+		node->is_terminal = (record & 1) != 0;
+		node->words = node->is_terminal;
+		node->count = node->is_terminal;
+		insertChildAt(parent, slot, node);
+
+		stack.push_back({ node, children });
+	}
+
+	if (root->words != words)
+	{
+		throw invalid_argument("trie::load: snapshot is inconsistent");
+	}
+
+	return words;
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (DIFF)
+
+// Diff layout:
+//   "TDIF", format version
+//   removed strings, then added strings, each list as
+//     varint number of strings
+//     per string: varint length of prefix shared with the previous string,
+//     varint length of the rest, the rest
+
+static const char diff_magic[] = { 'T', 'D', 'I', 'F' };
+static const char diff_version = 1;
+
+
+// Walks subtrees of two nodes that stand for the same word in lock-step. Words
+// found only below from were removed, words found only below to were added.
+void diffNodes(const trie_node * from, const trie_node * to, string & word, trie_diff & diff)
+{
+	if (from->is_terminal != to->is_terminal)
+	{
+		(from->is_terminal ? diff.removed : diff.added).push_back(word);
+	}
+
+	size_t i = 0;
+	size_t j = 0;
+
+	while ((i < num_chars && from->children[i]) || (j < num_chars && to->children[j]))
+	{
+		const trie_node * lhs = i < num_chars ? from->children[i] : nullptr;
+		const trie_node * rhs = j < num_chars ? to->children[j] : nullptr;
+
+		if (rhs == nullptr || (lhs != nullptr && isAfter(rhs->payload, lhs->payload)))
+		{
+			word.push_back(lhs->payload);
+			findMoreWordsByPrefix(diff.removed, lhs, word);
+			word.pop_back();
+			i++;
+		}
+		else if (lhs == nullptr || isAfter(lhs->payload, rhs->payload))
+		{
+			word.push_back(rhs->payload);
+			findMoreWordsByPrefix(diff.added, rhs, word);
+			word.pop_back();
+			j++;
+		}
+		else
+		{
+			word.push_back(lhs->payload);
+			diffNodes(lhs, rhs, word, diff);
+			word.pop_back();
+			i++;
+			j++;
+		}
+	}
+}
+
+
+bool isStrictlySorted(const vector<string> & words)
+{
+	return adjacent_find(words.begin(), words.end(), greater_equal<string>()) == words.end();
+}
+
+
+void writeFrontCoded(snapshot_writer & writer, const vector<string> & words)
+{
+	writer.putVarint(words.size());
+
+	for (size_t i = 0; i < words.size(); i++)
+	{
+		size_t shared = 0;
+
+		if (i > 0)
+		{
+			const string & previous = words[i - 1];
+
+			while (shared < previous.size() && shared < words[i].size() && previous[shared] == words[i][shared])
+			{
+				shared++;
+			}
+		}
+
+		writer.putVarint(shared);
+		writer.putVarint(words[i].size() - shared);
+
+		for (size_t j = shared; j < words[i].size(); j++)
+		{
+			writer.put(words[i][j]);
+		}
+	}
+}
+
+
+void readFrontCoded(snapshot_reader & reader, vector<string> & words)
+{
+	size_t count = reader.getVarint();
+	string word;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		size_t shared = reader.getVarint();
+		size_t rest = reader.getVarint();
+
+		if (shared > word.size())
+		{
+			throw invalid_argument("trie_diff::load: malformed string in diff");
+		}
+
+		word.resize(shared);
+
+		for (size_t j = 0; j < rest; j++)
+		{
+			char c = reader.get();
+
+			if (static_cast<unsigned char>(c) >= num_chars)
+			{
+				throw invalid_argument("trie_diff::load: malformed string in diff");
+			}
+
+			word.push_back(c);
+		}
+
+		if (!words.empty() && !(words.back() < word))
+		{
+			throw invalid_argument("trie_diff::load: strings in diff are not ordered");
+		}
+
+		words.push_back(word);
+	}
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (SUFFIX QUERIES)
+
+// Returns all words of the trie in lexicographical order
+vector<string> allWords(const trie_node * root)
+{
+	vector<string> words;
+	string word;
+
+	if (hasEmptyWord(root))
+	{
+		words.push_back(word);
+	}
+
+	findMoreWordsByPrefix(words, root, word);
+	return words;
+}
+
+
+// Returns node at the end of the path spelled by str, or nullptr if there is no such path.
+// Branches without words are removed by erase, so the path exists iff some word starts with str.
+const trie_node * findNode(const trie_node * root, const string & str)
+{
+	const trie_node * node = root;
+
+	for (size_t i = 0; i < str.size() && node != nullptr; i++)
+	{
+		node = findChild(node, str[i]);
+	}
+
+	return node;
+}
+
+
+string reversed(const string & str)
+{
+	return string(str.rbegin(), str.rend());
+}
+
+
+bool endsWith(const string & str, const string & suffix)
+{
+	return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (WORD COUNTS)
+
+static const size_t ingest_chunk_size = 1 << 16;
+
+
+bool isTokenChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+
+// Returns child of node with given payload, adds the child first if there is none.
+// New child is not terminal and holds no words yet.
+trie_node * findOrAddChild(trie_node * node, char c)
+{
+	TRIE_STATS_VISIT();
+
+	int i = static_cast<int>(labels::lower_bound(node->labels, node->child_count, c));
+
+	if (i < node->child_count && node->labels[i] == c)
+	{
+		return node->children[i];
+	}
+
+	trie_node * child = new trie_node;
+	TRIE_STATS_ALLOCATION();
+	child->payload = c;
+	insertChildAt(node, i, child);
+	return child;
+}
+
+
+trie_node * copyTrie(const trie_node * node)
+{
+	trie_node * copy = new trie_node;
+	TRIE_STATS_ALLOCATION();
+	copy->payload = node->payload;
+	copy->is_terminal = node->is_terminal;
+	copy->words = node->words;
+	copy->count = node->count;
+
+	for (int i = 0; i < node->child_count; i++)
+	{
+		copy->children[i] = copyTrie(node->children[i]);
+		copy->labels[i] = node->labels[i];
+	}
+
+	copy->child_count = node->child_count;
+
+	return copy;
+}
+
+
+// Moves all words from subtree of from into subtree of into, adding up their counts.
+// Children missing in into are moved over with their whole subtrees, the others are
+// merged recursively and freed. Leaves from without children, returns number of words
+// that were not in the subtree of into before.
+size_t mergeNodes(trie_node * into, trie_node * from)
+{
+	size_t added = 0;
+
+	if (from->is_terminal)
+	{
+		if (!into->is_terminal)
+		{
+			into->is_terminal = true;
+			added++;
+		}
+
+		into->count += from->count;
+	}
+
+	size_t slot = 0;
+
+	for (size_t i = 0; i < num_chars && from->children[i]; i++)
+	{
+		trie_node * child = from->children[i];
+		from->children[i] = nullptr;
+
+		while (slot < num_chars && into->children[slot] && isAfter(child->payload, into->children[slot]->payload))
+		{
+			slot++;
+		}
+
+		if (slot < num_chars && into->children[slot] && into->children[slot]->payload == child->payload)
+		{
+			added += mergeNodes(into->children[slot], child);
+			TRIE_STATS_FREE();
+			delete child;
+		}
+		else
+		{
+			insertChildAt(into, static_cast<int>(slot), child);
+			added += child->words;
+		}
+
+		slot++;
+	}
+
+	from->child_count = 0;
+	into->words += added;
+	return added;
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (MEMORY)
+
+// Adds nodes of the subtree of node to usage, node lies at given depth. Counts
+// nodes that have children into parents.
+void measureNodes(const trie_node * node, size_t depth, trie_memory_usage & usage, size_t & parents)
+{
+	usage.node_count++;
+
+	if (usage.depth_histogram.size() <= depth)
+	{
+		usage.depth_histogram.resize(depth + 1);
+	}
+
+	usage.depth_histogram[depth]++;
+
+	if (node->child_count > 0)
+	{
+		parents++;
+	}
+
+	for (int i = 0; i < node->child_count; i++)
+	{
+		measureNodes(node->children[i], depth + 1, usage, parents);
+	}
+}
+
+
+// Copies subtree of node in depth-first order
+trie_node * compactTrie(const trie_node * node)
+{
+	trie_node * copy = new trie_node;
+	TRIE_STATS_ALLOCATION();
+	copy->payload = node->payload;
+	copy->is_terminal = node->is_terminal;
+	copy->words = node->words;
+	copy->count = node->count;
+
+	for (int i = 0; i < node->child_count; i++)
+	{
+		insertChildAt(copy, copy->child_count, compactTrie(node->children[i]));
+	}
+
+	return copy;
+}
+
+
+//
+// VLASTNÍ FUNKCE A PROMĚNNÉ (SET OPERATIONS)
+
+// Roots keep the empty word in payload instead of is_terminal
+bool isWord(const trie_node * node, bool is_root)
+{
+	return is_root ? hasEmptyWord(node) : node->is_terminal;
+}
+
+
+// Marks node as holding a word with given count, or as holding none if count is 0
+void setWord(trie_node * node, bool is_root, uint64_t count)
+{
+	if (is_root)
+	{
+		node->payload = count > 0 ? ' ' : 0;
+	}
+	else
+	{
+		node->is_terminal = count > 0;
+	}
+
+	node->count = count;
+}
+
+
+bool equalNodes(const trie_node * lhs, const trie_node * rhs, bool is_root)
+{
+	if (lhs->words != rhs->words || lhs->child_count != rhs->child_count || isWord(lhs, is_root) != isWord(rhs, is_root))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < lhs->child_count; i++)
+	{
+		if (lhs->labels[i] != rhs->labels[i] || !equalNodes(lhs->children[i], rhs->children[i], false))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Compares sorted words of two subtrees lexicographically, stops at the first difference.
+// Returns -2 or 2 if some word of lhs is smaller or bigger than the word of rhs at the same
+// position, -1 or 1 if lhs or rhs runs out of words first and 0 if the words are the same.
+// Running out only decides the comparison if the caller has no more words either.
+int compareNodes(const trie_node * lhs, const trie_node * rhs, bool is_root)
+{
+	bool lhs_word = isWord(lhs, is_root);
+	bool rhs_word = isWord(rhs, is_root);
+
+	// word of the node itself comes before all words below it
+	if (lhs_word && !rhs_word)
+	{
+		return rhs->words > 0 ? -2 : 1;
+	}
+
+	if (rhs_word && !lhs_word)
+	{
+		return lhs->words > 0 ? 2 : -1;
+	}
+
+	int i = 0;
+
+	for (; i < lhs->child_count && i < rhs->child_count; i++)
+	{
+		if (lhs->labels[i] != rhs->labels[i])
+		{
+			return isAfter(lhs->labels[i], rhs->labels[i]) ? 2 : -2;
+		}
+
+		int result = compareNodes(lhs->children[i], rhs->children[i], false);
+
+		if (result == -1 && i + 1 < lhs->child_count)
+		{
+			// next word of lhs starts with a bigger character than the rest of rhs
+			return 2;
+		}
+
+		if (result == 1 && i + 1 < rhs->child_count)
+		{
+			return -2;
+		}
+
+		if (result != 0)
+		{
+			return result;
+		}
+	}
+
+	if (i < lhs->child_count)
+	{
+		return 1;
+	}
+
+	return i < rhs->child_count ? -1 : 0;
+}
+
+
+// Builds union of two subtrees from new nodes, counts of common words are added up
+trie_node * unionNodes(const trie_node * lhs, const trie_node * rhs, bool is_root)
+{
+	trie_node * node = new trie_node;
+	TRIE_STATS_ALLOCATION();
+	node->payload = lhs->payload;
+	setWord(node, is_root, lhs->count + rhs->count);
+	node->words = isWord(node, is_root);
+
+	int i = 0;
+	int j = 0;
+
+	while (i < lhs->child_count || j < rhs->child_count)
+	{
+		trie_node * child;
+
+		if (j == rhs->child_count || (i < lhs->child_count && isAfter(rhs->labels[j], lhs->labels[i])))
+		{
+			child = copyTrie(lhs->children[i++]);
+		}
+		else if (i == lhs->child_count || isAfter(lhs->labels[i], rhs->labels[j]))
+		{
+			child = copyTrie(rhs->children[j++]);
+		}
+		else
+		{
+			child = unionNodes(lhs->children[i++], rhs->children[j++], false);
+		}
+
+		node->words += child->words;
+		insertChildAt(node, node->child_count, child);
+	}
+
+	return node;
+}
+
+
+// Copies words of the subtree of from that are missing in the subtree of into, adds up counts
+// of the others. Only subtrees missing in into are copied, returns number of words added.
+size_t unionInto(trie_node * into, const trie_node * from, bool is_root)
+{
+	size_t added = 0;
+
+	if (isWord(from, is_root))
+	{
+		if (!isWord(into, is_root))
+		{
+			added++;
+		}
+
+		setWord(into, is_root, into->count + from->count);
+	}
+
+	int slot = 0;
+
+	for (int i = 0; i < from->child_count; i++)
+	{
+		const trie_node * child = from->children[i];
+
+		while (slot < into->child_count && isAfter(child->payload, into->labels[slot]))
+		{
+			slot++;
+		}
+
+		if (slot < into->child_count && into->labels[slot] == child->payload)
+		{
+			added += unionInto(into->children[slot], child, false);
+		}
+		else
+		{
+			insertChildAt(into, slot, copyTrie(child));
+			added += child->words;
+		}
+
+		slot++;
+	}
+
+	into->words += added;
+	return added;
+}
+
+
+// Builds intersection of two subtrees from new nodes, returns nullptr if it holds no words.
+// Common words keep the smaller count. The root of the intersection is always built.
+trie_node * intersectNodes(const trie_node * lhs, const trie_node * rhs, bool is_root)
+{
+	bool both = isWord(lhs, is_root) && isWord(rhs, is_root);
+	trie_node * node = nullptr;
+
+	if (is_root || both)
+	{
+		node = new trie_node;
+		TRIE_STATS_ALLOCATION();
+		node->payload = lhs->payload;
+		setWord(node, is_root, both ? min(lhs->count, rhs->count) : 0);
+		node->words = both;
+	}
+
+	int i = 0;
+	int j = 0;
+
+	while (i < lhs->child_count && j < rhs->child_count)
+	{
+		if (isAfter(rhs->labels[j], lhs->labels[i]))
+		{
+			i++;
+		}
+		else if (isAfter(lhs->labels[i], rhs->labels[j]))
+		{
+			j++;
+		}
+		else
+		{
+			trie_node * child = intersectNodes(lhs->children[i++], rhs->children[j++], false);
+
+			if (child == nullptr)
+			{
+				continue;
+			}
+
+			if (node == nullptr)
+			{
+				node = new trie_node;
+				TRIE_STATS_ALLOCATION();
+				node->payload = lhs->payload;
+			}
+
+			node->words += child->words;
+			insertChildAt(node, node->child_count, child);
+		}
+	}
+
+	return node;
+}
+
+
+// Removes words of the subtree of node that are not in the subtree of other,
+// common words keep the smaller count. Frees subtrees that are left without
+// words, except for the root. Returns number of words left.
+size_t intersectInto(trie_node * node, const trie_node * other, bool is_root)
+{
+	if (isWord(node, is_root))
+	{
+		setWord(node, is_root, isWord(other, is_root) ? min(node->count, other->count) : 0);
+	}
+
+	node->words = isWord(node, is_root);
+
+	int j = 0;
+
+	for (int i = 0; i < node->child_count; )
+	{
+		trie_node * child = node->children[i];
+
+		while (j < other->child_count && isAfter(child->payload, other->labels[j]))
+		{
+			j++;
+		}
+
+		if (j < other->child_count && other->labels[j] == child->payload && intersectInto(child, other->children[j], false) > 0)
+		{
+			node->words += child->words;
+			i++;
+		}
+		else
+		{
+			removeChild(node, child);
+			deleteTrie(child);
+		}
+	}
+
+	return node->words;
+}
+
+
+// 
+// FUNKCE A PROMĚNNÉ PODLE "TRIE.HPP" - TRIE 3
+
+
+trie::trie()
+{
+	m_root = new trie_node();
+	TRIE_STATS_ALLOCATION();
+	m_size = 0;
+}
+
+
+trie::trie(const vector<string>& strings)
+{
+	m_root = new trie_node();
+	TRIE_STATS_ALLOCATION();
+	m_size = 0;
+	
+	for (int i = 0; i < strings.size(); i++)
+	{
+		insert(strings[i]);
+	}
+}
+
+
+trie::trie(trie&& rhs)
+{
+	m_root = rhs.m_root;
+	m_size = rhs.m_size;
+
+	rhs.m_root = new trie_node();
+	TRIE_STATS_ALLOCATION();
+	rhs.m_size = 0;
+
+	std::swap(m_reversed, rhs.m_reversed);
+	std::swap(m_suffixes, rhs.m_suffixes);
+}
+
+
+trie::trie(const trie& rhs)
+{
+	m_root = copyTrie(rhs.m_root);
+	m_size = rhs.m_size;
+	set_index_mode(rhs.index_mode());
+}
+
+
+trie::~trie()
+{
+	trie_node * foo = m_root;
+	deleteTrie(foo);
+
+	m_size = 0;
+	m_root = nullptr;
+
+	delete m_reversed;
+	delete m_suffixes;
+}
+
+
+bool trie::insert(const string& str)
+{
+	TRIE_STATS_TIMER(trie_operation::insert);
+	TRIE_STATS_DEPTH(str.size());
+
+	if (str.empty() && (m_root->payload != ' '))
+	{
+		m_root->payload = ' ';
+		m_root->words++;
+		m_root->count = 1;
+		m_size++;
+		index_insert(str);
+		return true;
+	}
+
+	if (insertAsChild(m_root, str, 0))
+	{
+		m_root->words++;
+		m_size++;
+		index_insert(str);
+		return true;
+	}
+
+	return false;
+}
+
+
+bool trie::erase(const string& str)
+{
+	TRIE_STATS_TIMER(trie_operation::erase);
+
+	if (str.empty())
+	{
+		if (m_root->payload != ' ')
+		{
+			return false;
+		}
+
+		m_root->payload = 0;
+		m_root->words--;
+		m_root->count = 0;
+		m_size--;
+		index_erase(str);
+		return true;
+	}
+
+	vector<trie_node *> path = { m_root };
+
+	for (char c : str)
+	{
+		trie_node * next = findChild(path.back(), c);
+
+		if (next == nullptr)
+		{
+			TRIE_STATS_DEPTH(path.size());
+			return false;
+		}
+
+		path.push_back(next);
+	}
+
+	TRIE_STATS_DEPTH(str.size());
+
+	if (!path.back()->is_terminal)
+	{
+		return false;
+	}
+
+	path.back()->is_terminal = false;
+	path.back()->count = 0;
+
+	for (trie_node * node : path)
+	{
+		node->words--;
+	}
+
+	m_size--;
+
+	// odstraní nejvyšší větev, ve které už nezůstalo žádné slovo
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		if (path[i]->words == 0)
+		{
+			removeChild(path[i - 1], path[i]);
+			deleteTrie(path[i]);
+			break;
+		}
+	}
+
+	index_erase(str);
+	return true;
+}
+
+
+bool trie::contains(const string& str) const
+{
+	TRIE_STATS_TIMER(trie_operation::contains);
+
+	if (str.empty())
+	{
+		return m_root->payload == ' ';
+	}
+
+	const trie_node * node = m_root;
+
+	for (size_t i = 0; i < str.size(); i++)
+	{
+		node = findChild(node, str[i]);
+
+		if (node == nullptr)
+		{
+			TRIE_STATS_DEPTH(i);
+			return false;
+		}
+	}
+
+	TRIE_STATS_DEPTH(str.size());
+	return node->is_terminal;
+}
+
+
+size_t trie::size() const
+{
+	return m_size;
+}
+
+
+bool trie::empty() const
+{
+	return m_size == 0;
+}
+
+
+uint64_t trie::add(const string& str, uint64_t n)
+{
+	if (n == 0)
+	{
+		return count(str);
+	}
+
+	if (str.empty())
+	{
+		if (m_root->payload != ' ')
+		{
+			m_root->payload = ' ';
+			m_root->words++;
+			m_size++;
+			index_insert(str);
+		}
+
+		m_root->count += n;
+		return m_root->count;
+	}
+
+	vector<trie_node *> path = { m_root };
+
+	for (char c : str)
+	{
+		path.push_back(findOrAddChild(path.back(), c));
+	}
+
+	count_word(path, n);
+	return path.back()->count;
+}
+
+
+uint64_t trie::count(const string& str) const
+{
+	if (str.empty())
+	{
+		return hasEmptyWord(m_root) ? m_root->count : 0;
+	}
+
+	const trie_node * node = findNode(m_root, str);
+	return node != nullptr && node->is_terminal ? node->count : 0;
+}
+
+
+size_t trie::ingest(istream& in)
+{
+	vector<char> buffer(ingest_chunk_size);
+	// nodes of the token read so far, tokens may continue in the next chunk
+	vector<trie_node *> path = { m_root };
+	size_t tokens = 0;
+
+	while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0)
+	{
+		size_t length = static_cast<size_t>(in.gcount());
+
+		for (size_t i = 0; i < length; i++)
+		{
+			if (isTokenChar(buffer[i]))
+			{
+				path.push_back(findOrAddChild(path.back(), buffer[i]));
+			}
+			else if (path.size() > 1)
+			{
+				count_word(path, 1);
+				path.resize(1);
+				tokens++;
+			}
+		}
+	}
+
+	if (path.size() > 1)
+	{
+		count_word(path, 1);
+		tokens++;
+	}
+
+	return tokens;
+}
+
+
+size_t trie::ingest_parallel(const vector<istream *>& inputs, size_t threads)
+{
+	threads = max<size_t>(1, min(threads, inputs.size()));
+
+	vector<trie> locals(threads);
+	vector<size_t> tokens(threads, 0);
+	atomic<size_t> next(0);
+	exception_ptr error;
+	mutex error_lock;
+	vector<thread> workers;
+
+	auto work = [&](size_t t) {
+		for (size_t i = next++; i < inputs.size(); i = next++)
+		{
+			try
+			{
+				tokens[t] += locals[t].ingest(*inputs[i]);
+			}
+			catch (...)
+			{
+				lock_guard<mutex> guard(error_lock);
+				if (!error)
+				{
+					error = current_exception();
+				}
+				next = inputs.size();
+			}
+		}
+	};
+
+	try
+	{
+		for (size_t t = 1; t < threads; t++)
+		{
+			workers.emplace_back(work, t);
+		}
+	}
+	catch (...)
+	{
+		// A running thread must be joined before it is destroyed
+		next = inputs.size();
+		for (thread & worker : workers)
+		{
+			worker.join();
+		}
+		throw;
+	}
+
+	work(0);
+
+	for (thread & worker : workers)
+	{
+		worker.join();
+	}
+
+	// Nothing is merged when a stream failed, this trie stays as it was
+	if (error)
+	{
+		rethrow_exception(error);
+	}
+
+	size_t total = 0;
+
+	for (size_t t = 0; t < threads; t++)
+	{
+		merge_from(move(locals[t]));
+		total += tokens[t];
+	}
+
+	return total;
+}
+
+
+// Counts n more occurrences of the word whose nodes are on path, the root first
+void trie::count_word(vector<trie_node *>& path, uint64_t n)
+{
+	trie_node * node = path.back();
+
+	if (!node->is_terminal)
+	{
+		node->is_terminal = true;
+
+		for (trie_node * step : path)
+		{
+			step->words++;
+		}
+
+		m_size++;
+
+		if (m_reversed != nullptr)
+		{
+			string word;
+
+			for (size_t i = 1; i < path.size(); i++)
+			{
+				word.push_back(path[i]->payload);
+			}
+
+			index_insert(word);
+		}
+	}
+
+	node->count += n;
+}
+
+
+void trie::refresh()
+{
+	m_size = m_root->words;
+
+	if (m_reversed != nullptr)
+	{
+		set_index_mode(index_mode());
+	}
+}
+
+
+vector<string> trie::search_by_prefix(const string& str) const
+{
+	TRIE_STATS_TIMER(trie_operation::search_by_prefix);
+
+	vector<string> words = {};
+	string phrase = "";
+
+	int i = 0;
+	bool found = false;
+	trie_node * foo = m_root;
+
+	while (str[i] != '\0')
+	{
+		trie_node * next = findChild(foo, str[i]);
+
+		if (next != nullptr)
+		{
+			foo = next;
+			phrase.push_back(str[i]);
+			found = true;
+		}
+
+		if (found)
+		{
+			found = false;
+			i++;
+		}
+		else
+		{
+			TRIE_STATS_DEPTH(i);
+			return words;
+		}
+	}
+
+	TRIE_STATS_DEPTH(i);
+	findMoreWordsByPrefix(words, foo, phrase);
+	return words;
+}
+
+
+vector<string> trie::get_prefixes(const string & str) const
+{
+	vector<string> prefixes;
+	vector<size_t> lengths;
+	get_prefix_lengths(str, lengths);
+
+	// the longest prefix goes first
+	for (size_t i = lengths.size(); i > 0; i--)
+	{
+		prefixes.push_back(str.substr(0, lengths[i - 1]));
+	}
+
+	return prefixes;
+}
+
+
+void trie::get_prefix_lengths(const string& str, vector<size_t>& lengths, size_t pos) const
+{
+	lengths.clear();
+
+	const trie_node * node = m_root;
+
+	for (size_t i = pos; i < str.size(); i++)
+	{
+		node = findChild(node, str[i]);
+
+		if (node == nullptr)
+		{
+			return;
+		}
+
+		if (node->is_terminal)
+		{
+			lengths.push_back(i - pos + 1);
+		}
+	}
+}
+
+
+size_t trie::longest_prefix(const string& str, size_t pos) const
+{
+	size_t longest = 0;
+	const trie_node * node = m_root;
+
+	for (size_t i = pos; i < str.size(); i++)
+	{
+		node = findChild(node, str[i]);
+
+		if (node == nullptr)
+		{
+			break;
+		}
+
+		if (node->is_terminal)
+		{
+			longest = i - pos + 1;
+		}
+	}
+
+	return longest;
+}
+
+
+vector<string> trie::search_by_suffix(const string& suffix) const
+{
+	vector<string> words;
+
+	if (m_reversed == nullptr)
+	{
+		for (string & word : allWords(m_root))
+		{
+			if (endsWith(word, suffix))
+			{
+				words.push_back(move(word));
+			}
+		}
+
+		return words;
+	}
+
+	words = m_reversed->search_by_prefix(reversed(suffix));
+
+	for (string & word : words)
+	{
+		word = reversed(word);
+	}
+
+	if (suffix.empty() && hasEmptyWord(m_root))
+	{
+		words.push_back("");
+	}
+
+	sort(words.begin(), words.end());
+	return words;
+}
+
+
+vector<string> trie::search_by_substring(const string& substring) const
+{
+	vector<string> words;
+
+	if (m_suffixes == nullptr || substring.empty())
+	{
+		for (string & word : allWords(m_root))
+		{
+			if (word.find(substring) != string::npos)
+			{
+				words.push_back(move(word));
+			}
+		}
+
+		return words;
+	}
+
+	// every word that contains the substring has a suffix starting with it,
+	// the reversed index then finds all words ending with that suffix
+	for (const string & suffix : m_suffixes->search_by_prefix(substring))
+	{
+		for (const string & word : m_reversed->search_by_prefix(reversed(suffix)))
+		{
+			words.push_back(reversed(word));
+		}
+	}
+
+	sort(words.begin(), words.end());
+	words.erase(unique(words.begin(), words.end()), words.end());
+	return words;
+}
+
+
+void trie::set_index_mode(trie_index_mode mode)
+{
+	delete m_reversed;
+	delete m_suffixes;
+	m_reversed = nullptr;
+	m_suffixes = nullptr;
+
+	if (mode == trie_index_mode::none)
+	{
+		return;
+	}
+
+	m_reversed = new trie();
+
+	if (mode == trie_index_mode::suffixes)
+	{
+		m_suffixes = new trie();
+	}
+
+	for (const string & word : allWords(m_root))
+	{
+		index_insert(word);
+	}
+}
+
+
+trie_index_mode trie::index_mode() const
+{
+	if (m_suffixes != nullptr)
+	{
+		return trie_index_mode::suffixes;
+	}
+
+	return m_reversed != nullptr ? trie_index_mode::reversed : trie_index_mode::none;
+}
+
+
+void trie::index_insert(const string& str)
+{
+	if (m_reversed != nullptr)
+	{
+		m_reversed->insert(reversed(str));
+	}
+
+	if (m_suffixes != nullptr)
+	{
+		for (size_t i = 0; i < str.size(); i++)
+		{
+			m_suffixes->insert(str.substr(i));
+		}
+	}
+}
+
+
+void trie::index_erase(const string& str)
+{
+	if (m_reversed != nullptr)
+	{
+		m_reversed->erase(reversed(str));
+	}
+
+	if (m_suffixes != nullptr)
+	{
+		// suffix stays as long as some other word still ends with it
+		for (size_t i = 0; i < str.size(); i++)
+		{
+			string suffix = str.substr(i);
+
+			if (findNode(m_reversed->m_root, reversed(suffix)) == nullptr)
+			{
+				m_suffixes->erase(suffix);
+			}
+		}
+	}
+}
+
+
+trie_diff trie::diff(const trie& target) const
+{
+	trie_diff result;
+	string word;
+
+	if (hasEmptyWord(m_root) != hasEmptyWord(target.m_root))
+	{
+		(hasEmptyWord(m_root) ? result.removed : result.added).push_back(word);
+	}
+
+	diffNodes(m_root, target.m_root, word, result);
+	return result;
+}
+
+
+void trie::apply_diff(const trie_diff& diff)
+{
+	if (!isStrictlySorted(diff.removed) || !isStrictlySorted(diff.added))
+	{
+		throw invalid_argument("trie::apply_diff: strings in diff are not ordered");
+	}
+
+	for (const string & word : diff.removed)
+	{
+		if (!contains(word))
+		{
+			throw invalid_argument("trie::apply_diff: removed string is not in the trie");
+		}
+	}
+
+	for (const string & word : diff.added)
+	{
+		if (contains(word))
+		{
+			throw invalid_argument("trie::apply_diff: added string is already in the trie");
+		}
+	}
+
+	for (const string & word : diff.removed)
+	{
+		erase(word);
+	}
+
+	for (const string & word : diff.added)
+	{
+		insert(word);
+	}
+}
+
+
+size_t trie::rank(const string& str) const
+{
+	size_t smaller = 0;
+	const trie_node * node = m_root;
+
+	if (!str.empty() && hasEmptyWord(m_root))
+	{
+		smaller++;
+	}
+
+	for (size_t i = 0; i < str.size(); i++)
+	{
+		size_t j = 0;
+
+		while (j < num_chars && node->children[j] && isAfter(str[i], node->children[j]->payload))
+		{
+			smaller += node->children[j]->words;
+			j++;
+		}
+
+		if (j == num_chars || node->children[j] == nullptr || node->children[j]->payload != str[i])
+		{
+			return smaller;
+		}
+
+		node = node->children[j];
+
+		// proper prefix of str
+		if (node->is_terminal && i + 1 < str.size())
+		{
+			smaller++;
+		}
+	}
+
+	return smaller;
+}
+
+
+string trie::select(size_t i) const
+{
+	if (i >= m_size)
+	{
+		throw out_of_range("trie::select: index out of range");
+	}
+
+	vector<const trie_node *> path;
+	string word;
+	selectPath(m_root, i, path, word);
+	return word;
+}
+
+
+size_t trie::count_range(const string& lo, const string& hi) const
+{
+	if (!(lo < hi))
+	{
+		return 0;
+	}
+
+	return rank(hi) - rank(lo);
+}
+
+
+trie::const_iterator trie::lower_bound(const string& str) const
+{
+	size_t i = rank(str);
+
+	if (i == m_size)
+	{
+		return end();
+	}
+
+	vector<const trie_node *> path;
+	string word;
+	selectPath(m_root, i, path, word);
+	return const_iterator(move(path), move(word));
+}
+
+
+vector<bool> trie::contains_many(const vector<string>& strings, size_t batch_size) const
+{
+	vector<bool> found(strings.size(), false);
+
+	for (size_t i = 0; i < strings.size(); i++)
+	{
+		if (strings[i].empty())
+		{
+			found[i] = (m_root->payload == ' ');
+		}
+	}
+
+	walkInterleaved(m_root, strings, batch_size, [&](size_t index, size_t depth, const trie_node * node) {
+		if (depth == strings[index].size() && node->is_terminal)
+		{
+			found[index] = true;
+		}
+	});
+
+	return found;
+}
+
+
+vector<vector<string>> trie::get_prefixes_many(const vector<string>& strings, size_t batch_size) const
+{
+	vector<vector<string>> prefixes(strings.size());
+
+	walkInterleaved(m_root, strings, batch_size, [&](size_t index, size_t depth, const trie_node * node) {
+		if (node->is_terminal)
+		{
+			prefixes[index].push_back(strings[index].substr(0, depth));
+		}
+	});
+
+	// get_prefixes returns the longest prefix first
+	for (vector<string> & list : prefixes)
+	{
+		reverse(list.begin(), list.end());
+	}
+
+	return prefixes;
+}
+
+
+trie::const_iterator trie::begin() const
+{
+	const_iterator it({ m_root }, "");
+
+	if (!hasEmptyWord(m_root))
+	{
+		it.move_to_next_word();
+	}
+
+	return it;
+}
+
+
+trie::const_iterator trie::end() const
+{
+	return const_iterator();
+}
+
+
+void trie::save(ostream& out) const
+{
+	snapshot_writer writer(out);
+	writeSnapshot(writer, m_root, m_size);
+}
+
+
+void trie::load(istream& in)
+{
+	trie_node * root = new trie_node();
+	TRIE_STATS_ALLOCATION();
+	snapshot_reader reader(in);
+	size_t words = 0;
+
+	try
+	{
+		words = readSnapshot(reader, root);
+	}
+	catch (...)
+	{
+		deleteTrie(root);
+		throw;
+	}
+
+	deleteTrie(m_root);
+	m_root = root;
+	m_size = words;
+	set_index_mode(index_mode());
+}
+
+
+trie_memory_usage trie::memory_usage() const
+{
+	trie_memory_usage usage;
+	size_t parents = 0;
+
+	measureNodes(m_root, 0, usage, parents);
+
+	usage.node_bytes = usage.node_count * sizeof(trie_node);
+	usage.side_bytes = sizeof(trie);
+
+	if (parents > 0)
+	{
+		// every node except the root is a child of some parent
+		usage.average_fan_out = static_cast<double>(usage.node_count - 1) / parents;
+	}
+
+	for (const trie * index : { m_reversed, m_suffixes })
+	{
+		if (index != nullptr)
+		{
+			usage.side_bytes += index->memory_usage().total_bytes();
+		}
+	}
+
+	return usage;
+}
+
+
+void trie::shrink_to_fit()
+{
+	trie_node * compacted = compactTrie(m_root);
+	deleteTrie(m_root);
+	m_root = compacted;
+
+	for (trie * index : { m_reversed, m_suffixes })
+	{
+		if (index != nullptr)
+		{
+			index->shrink_to_fit();
+		}
+	}
+}
+
+
+void trie::swap(trie& rhs)
+{
+	trie_node * fooNode = m_root;
+	m_root = rhs.m_root;
+	rhs.m_root = fooNode;
+
+	size_t fooSize = m_size;
+	m_size = rhs.m_size;
+	rhs.m_size = fooSize;
+
+	std::swap(m_reversed, rhs.m_reversed);
+	std::swap(m_suffixes, rhs.m_suffixes);
+}
+
+
+void swap(trie& lhs, trie& rhs)
+{
+	lhs.swap(rhs);
+}
+
+
+trie& trie::operator=(const trie& rhs)
+{
+	if (this == &rhs)
+	{
+		return *this;
+	}
+
+	deleteTrie(m_root);
+	m_root = copyTrie(rhs.m_root);
+	m_size = rhs.m_size;
+	set_index_mode(rhs.index_mode());
+	return * this;
+}
+
+
+trie& trie::operator=(trie&& rhs)
+{
+	if (this == &rhs)
+	{
+		return *this;
+	}
+
+	deleteTrie(m_root);
+	m_root = rhs.m_root;
+	m_size = rhs.m_size;
+
+	rhs.m_root = new trie_node();
+	TRIE_STATS_ALLOCATION();
+	rhs.m_size = 0;
+
+	set_index_mode(trie_index_mode::none);
+	std::swap(m_reversed, rhs.m_reversed);
+	std::swap(m_suffixes, rhs.m_suffixes);
+	return *this;
+}
+
+
+bool trie::operator==(const trie& rhs) const
+{
+	return equalNodes(m_root, rhs.m_root, true);
+}
+
+
+bool trie::operator<(const trie& rhs) const
+{
+	return compareNodes(m_root, rhs.m_root, true) < 0;
+}
+
+
+trie trie::operator&(trie const& rhs) const&
+{
+	trie result;
+	deleteTrie(result.m_root);
+	result.m_root = intersectNodes(m_root, rhs.m_root, true);
+	result.m_size = result.m_root->words;
+	return result;
+}
+
+
+trie trie::operator&(trie&& rhs) const&
+{
+	rhs &= *this;
+	return move(rhs);
+}
+
+
+trie trie::operator&(trie const& rhs) &&
+{
+	*this &= rhs;
+	return move(*this);
+}
+
+
+trie trie::operator&(trie&& rhs) &&
+{
+	*this &= rhs;
+	return move(*this);
+}
+
+
+trie trie::operator|(trie const& rhs) const&
+{
+	trie result;
+	deleteTrie(result.m_root);
+	result.m_root = unionNodes(m_root, rhs.m_root, true);
+	result.m_size = result.m_root->words;
+	return result;
+}
+
+
+trie trie::operator|(trie&& rhs) const&
+{
+	rhs |= *this;
+	return move(rhs);
+}
+
+
+trie trie::operator|(trie const& rhs) &&
+{
+	*this |= rhs;
+	return move(*this);
+}
+
+
+trie trie::operator|(trie&& rhs) &&
+{
+	merge_from(move(rhs));
+	return move(*this);
+}
+
+
+trie& trie::operator&=(const trie& rhs)
+{
+	if (this != &rhs)
+	{
+		intersectInto(m_root, rhs.m_root, true);
+		refresh();
+	}
+
+	return *this;
+}
+
+
+trie& trie::operator|=(const trie& rhs)
+{
+	if (this == &rhs)
+	{
+		trie copy(rhs);
+		return *this |= move(copy);
+	}
+
+	unionInto(m_root, rhs.m_root, true);
+	refresh();
+	return *this;
+}
+
+
+trie& trie::operator|=(trie&& rhs)
+{
+	merge_from(move(rhs));
+	return *this;
+}
+
+
+void trie::merge_from(trie&& other)
+{
+	if (this == &other)
+	{
+		return;
+	}
+
+	if (hasEmptyWord(other.m_root))
+	{
+		m_root->words += !hasEmptyWord(m_root);
+		setWord(m_root, true, m_root->count + other.m_root->count);
+	}
+
+	mergeNodes(m_root, other.m_root);
+
+	setWord(other.m_root, true, 0);
+	other.m_root->words = 0;
+	other.m_size = 0;
+	other.set_index_mode(trie_index_mode::none);
+
+	refresh();
+}
+
+
+bool operator!=(const trie& lhs, const trie& rhs)
+{
+	return !(lhs == rhs);
+}
+
+
+bool operator>(const trie& lhs, const trie& rhs)
+{
+	return rhs < lhs;
+}
+
+
+bool operator<=(const trie& lhs, const trie& rhs)
+{
+	return !(lhs > rhs);
+}
+
+
+bool operator>=(const trie& lhs, const trie& rhs)
+{
+	return !(lhs < rhs);
+}
+
+
+ostream& operator<<(ostream& out, trie const& trie)
+{
+	for (const auto & word : trie)
+	{
+		out << word << '\n';
+	}
+
+	return out;
+}
+
+
+//
+// TRIE MEMORY USAGE
+
+size_t trie_memory_usage::total_bytes() const
+{
+	return node_bytes + side_bytes;
+}
+
+
+//
+// TRIE DIFF
+
+bool trie_diff::empty() const
+{
+	return added.empty() && removed.empty();
+}
+
+
+void trie_diff::save(ostream& out) const
+{
+	snapshot_writer writer(out);
+
+	for (char c : diff_magic)
+	{
+		writer.put(c);
+	}
+
+	writer.put(diff_version);
+	writeFrontCoded(writer, removed);
+	writeFrontCoded(writer, added);
+}
+
+
+void trie_diff::load(istream& in)
+{
+	snapshot_reader reader(in, "trie_diff::load");
+
+	for (char c : diff_magic)
+	{
+		if (reader.get() != c)
+		{
+			throw invalid_argument("trie_diff::load: not a trie diff");
+		}
+	}
+
+	if (reader.get() != diff_version)
+	{
+		throw invalid_argument("trie_diff::load: unsupported diff version");
+	}
+
+	trie_diff loaded;
+	readFrontCoded(reader, loaded.removed);
+	readFrontCoded(reader, loaded.added);
+
+	removed.swap(loaded.removed);
+	added.swap(loaded.added);
+}
+
+
+//
+// CONST ITERATOR
+
+trie::const_iterator::const_iterator(vector<const trie_node *> path, string word)
+	:path(move(path)), word(move(word))
+{
+}
+
+
+// Moves to the next terminal node in preorder: the first one below the current
+// node, or else below the nearest following sibling of the current node or of
+// one of its ancestors. Every leaf is terminal, erase removes branches without words.
+void trie::const_iterator::move_to_next_word()
+{
+	const trie_node * node = path.back();
+
+	if (node->children[0] == nullptr)
+	{
+		node = nullptr;
+
+		while (node == nullptr && path.size() > 1)
+		{
+			const trie_node * child = path.back();
+			path.pop_back();
+			word.pop_back();
+
+			// Siblings have distinct payloads, so the label search finds the slot of child
+			const trie_node * parent = path.back();
+			size_t slot = static_cast<size_t>(labels::find(parent->labels, parent->child_count, child->payload));
+
+			if (slot + 1 < parent->child_count)
+			{
+				node = parent->children[slot + 1];
+			}
+		}
+
+		if (node == nullptr)
+		{
+			path.clear();
+			return;
+		}
+	}
+	else
+	{
+		node = node->children[0];
+	}
+
+	path.push_back(node);
+	word.push_back(node->payload);
+
+	while (!node->is_terminal)
+	{
+		node = node->children[0];
+		path.push_back(node);
+		word.push_back(node->payload);
+	}
+}
+
+
+trie::const_iterator& trie::const_iterator::operator++()
+{
+	move_to_next_word();
+	return *this;
+}
+
+
+trie::const_iterator trie::const_iterator::operator++(int)
+{
+	const_iterator old = *this;
+	operator++();
+	return old;
+}
+
+
+bool trie::const_iterator::operator==(const trie::const_iterator& rhs) const
+{
+	if (path.empty() || rhs.path.empty())
+	{
+		return path.empty() == rhs.path.empty();
+	}
+
+	return path.back() == rhs.path.back();
+}
+
+
+bool trie::const_iterator::operator!=(const trie::const_iterator& rhs) const
+{
+	return !(*this == rhs);
+}
+
+
+trie::const_iterator::reference trie::const_iterator::operator*() const
+{
+	return word;
+}
@@ -1,133 +1,430 @@
-#include <vector>
-#include <string>
-#include <iterator>
-#include <iosfwd>
-
-// Assume only basic ASCII characters
-static const size_t num_chars = 128;
-
-struct trie_node {
-    trie_node* children[num_chars] = {};
-    trie_node* parent = nullptr;
-    char payload = 0;
-    bool is_terminal = false;
-};
-
-class trie {
-public:
-
-    class const_iterator {
-        const trie_node* current_node = nullptr;
-    public:
-        using iterator_category = std::forward_iterator_tag;
-        using value_type = std::string;
-        using reference = std::string;
-        using pointer = std::string;
-        using difference_type = std::ptrdiff_t;
-
-        const_iterator() = default;
-        const_iterator(const trie_node* node);
-
-        const_iterator& operator++();
-        const_iterator operator++(int);
-
-        reference operator*() const;
-        bool operator==(const const_iterator& rhs) const;
-        bool operator!=(const const_iterator& rhs) const;
-    };
-
-    /**
-     * Constructs trie containing all strings from provided vector
-     */
-    trie(const std::vector<std::string>& strings);
-
-    trie();
-    trie(const trie& rhs);
-    trie& operator=(const trie& rhs);
-    trie(trie&& rhs);
-    trie& operator=(trie&& rhs);
-    ~trie();
-
-    /**
-     * Removes given string from the trie
-     * Returns true iff string was removed (it was present in the trie).
-     */
-    bool erase(const std::string& str);
-
-    /**
-     * Inserts given string to the trie.
-     * Returns true iff string was successfully inserted (it was not present before).
-     */
-    bool insert(const std::string& str);
-
-    /**
-     * Returns true iff given string is in the trie
-     */
-    bool contains(const std::string& str) const;
-
-    /**
-     * Returns how many unique strings are in the trie
-     */
-    size_t size() const;
-
-    /**
-     * Returns whether given trie is empty (contains no strings)
-     */
-    bool empty() const;
-
-    /**
-     * Returns all strings from trie that contain given prefix.
-     *
-     * Prefix can be inclusive, meaning that a prefix of "abc" should return
-     * "abc" amongst results, if it is in the trie.
-     */
-    std::vector<std::string> search_by_prefix(const std::string& prefix) const;
-
-    /**
-     * Returns all strings from trie that are prefixes of given string.
-     *
-     * Prefixes are inclusive, meaning that a string of "abc" should return
-     * "abc" amongst results, if it is in the trie.
-     */
-    std::vector<std::string> get_prefixes(const std::string& str) const;
-
-    const_iterator begin() const;
-    const_iterator end() const;
-
-    void swap(trie& rhs);
-
-	// Relops
-
-	// 2 tries are equal iff they contain the same strings
-	bool operator==(const trie& rhs) const;
-	/**
-	 * Tries are compared by taking lexicographically sorted strings contained within and then lexicographically comparing these.
-	 */
-	bool operator<(const trie& rhs) const;
-
-    /**
-     * Returns new trie that contains the intersection (strings that are present in both) of the two provided tries.
-     */
-    trie operator&(trie const& rhs) const;
-
-    /**
-     * Returns new trie that contains the union (strings are present in at least one) of the two provided tries.
-     */
-    trie operator|(trie const& rhs) const;
-
-private:
-    trie_node* m_root = nullptr;
-    size_t m_size = 0;
-};
-
-// 2 tries are unequal iff they contain different strings
-bool operator!=(const trie& lhs, const trie& rhs);
-// Lexicographical ordering, see operator< for details
-bool operator<=(const trie& lhs, const trie& rhs);
-// Lexicographical ordering, see operator< for details
-bool operator>(const trie& lhs, const trie& rhs);
-// Lexicographical ordering, see operator< for details
-bool operator>=(const trie& lhs, const trie& rhs);
-void swap(trie& lhs, trie& rhs);
-
-std::ostream& operator<<(std::ostream& out, trie const& trie);
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iterator>
+#include <iosfwd>
+#include <cstdint>
+
+// Assume only basic ASCII characters
+static const size_t num_chars = 128;
+
+// Fields a lookup reads come first, so that they take two cache lines
+// together with the first children
+struct trie_node {
+    // Payloads of children, in the same order, so that a child is found without visiting the others
+    char labels[num_chars] = {};
+    // How many words are in the subtree of this node, including the node itself
+    size_t words = 0;
+    // How many times the word ending in this node was added, 0 for non-terminal nodes
+    std::uint64_t count = 0;
+    // How many children the node has, children are packed from slot 0
+    std::uint8_t child_count = 0;
+    char payload = 0;
+    bool is_terminal = false;
+    trie_node* children[num_chars] = {};
+};
+
+/**
+ * Companion indexes a trie can keep in sync with its strings.
+ *
+ * reversed keeps reversed copy of every string, so that search_by_suffix
+ * does not have to scan all strings. suffixes additionally keeps every
+ * suffix of every string, so that search_by_substring does not either.
+ * The suffix index needs a node per distinct substring, so it is only
+ * affordable for small tries.
+ */
+enum class trie_index_mode {
+    none,
+    reversed,
+    suffixes,
+};
+
+/**
+ * Changes that turn one trie into another, see trie::diff.
+ *
+ * Both vectors are sorted lexicographically and contain no duplicates.
+ */
+struct trie_diff {
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+
+    /**
+     * Returns whether the diff contains no changes
+     */
+    bool empty() const;
+
+    /**
+     * Writes the diff to given stream in a compact binary format.
+     *
+     * Every string only stores the part it does not share with the previous one.
+     */
+    void save(std::ostream& out) const;
+
+    /**
+     * Replaces contents of the diff with diff previously written by save.
+     *
+     * Throws std::invalid_argument if the stream does not contain a valid
+     * diff, the diff is left unchanged in that case.
+     */
+    void load(std::istream& in);
+};
+
+/**
+ * Memory held by a trie, see trie::memory_usage.
+ */
+struct trie_memory_usage {
+    size_t node_count = 0;
+    // Bytes in nodes, node_count * sizeof(trie_node)
+    size_t node_bytes = 0;
+    // Bytes in everything else: the trie object itself and its companion indexes
+    size_t side_bytes = 0;
+    // Average number of children of nodes that have any, 0 if there are none
+    double average_fan_out = 0;
+    // depth_histogram[d] is how many nodes lie at depth d, the root is at depth 0
+    std::vector<size_t> depth_histogram;
+
+    /**
+     * Returns node_bytes + side_bytes
+     */
+    size_t total_bytes() const;
+};
+
+class trie {
+public:
+
+    class const_iterator {
+        friend class trie;
+
+        // Nodes on the way from the root to the current word, empty for the end iterator
+        std::vector<const trie_node*> path;
+        std::string word;
+
+        const_iterator(std::vector<const trie_node*> path, std::string word);
+        void move_to_next_word();
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string;
+        using reference = std::string;
+        using pointer = std::string;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() = default;
+
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        reference operator*() const;
+        bool operator==(const const_iterator& rhs) const;
+        bool operator!=(const const_iterator& rhs) const;
+    };
+
+    /**
+     * Constructs trie containing all strings from provided vector
+     */
+    trie(const std::vector<std::string>& strings);
+
+    trie();
+    trie(const trie& rhs);
+    trie& operator=(const trie& rhs);
+    trie(trie&& rhs);
+    trie& operator=(trie&& rhs);
+    ~trie();
+
+    /**
+     * Removes given string from the trie
+     * Returns true iff string was removed (it was present in the trie).
+     */
+    bool erase(const std::string& str);
+
+    /**
+     * Inserts given string to the trie.
+     * Returns true iff string was successfully inserted (it was not present before).
+     */
+    bool insert(const std::string& str);
+
+    /**
+     * Returns true iff given string is in the trie
+     */
+    bool contains(const std::string& str) const;
+
+    /**
+     * Returns how many unique strings are in the trie
+     */
+    size_t size() const;
+
+    /**
+     * Adds n occurrences of given string, inserting it first if it is not in the trie.
+     * Returns how many occurrences of the string the trie holds afterwards.
+     *
+     * A string inserted by insert holds 1 occurrence. Snapshots and diffs
+     * only keep strings, so strings loaded from them hold 1 occurrence too.
+     */
+    std::uint64_t add(const std::string& str, std::uint64_t n = 1);
+
+    /**
+     * Returns how many occurrences of given string the trie holds, 0 if it is not in the trie.
+     */
+    std::uint64_t count(const std::string& str) const;
+
+    /**
+     * Reads the whole stream and adds an occurrence of every token in it.
+     * Returns how many tokens were read.
+     *
+     * Tokens are maximal runs of ASCII letters and digits, everything else
+     * separates them. The stream is read in big chunks and every token is
+     * added straight from the chunk, without being copied into a string.
+     */
+    size_t ingest(std::istream& in);
+
+    /**
+     * Does the same as calling ingest for every stream, using given number of threads.
+     *
+     * Every thread ingests streams into its own trie, those are merged
+     * into this trie once all streams are read. If reading any stream throws,
+     * the first exception is rethrown once all threads finish and this trie
+     * is left unchanged.
+     */
+    size_t ingest_parallel(const std::vector<std::istream*>& inputs, size_t threads);
+
+    /**
+     * Returns whether given trie is empty (contains no strings)
+     */
+    bool empty() const;
+
+    /**
+     * Returns all strings from trie that contain given prefix.
+     *
+     * Prefix can be inclusive, meaning that a prefix of "abc" should return
+     * "abc" amongst results, if it is in the trie.
+     */
+    std::vector<std::string> search_by_prefix(const std::string& prefix) const;
+
+    /**
+     * Returns all strings from trie that are prefixes of given string.
+     *
+     * Prefixes are inclusive, meaning that a string of "abc" should return
+     * "abc" amongst results, if it is in the trie.
+     */
+    std::vector<std::string> get_prefixes(const std::string& str) const;
+
+    /**
+     * Stores lengths of all strings from trie that are prefixes of str.substr(pos)
+     * into lengths, in increasing order.
+     *
+     * Same strings as in get_prefixes are reported, but nothing is copied:
+     * lengths is cleared and refilled, so a reused vector does not allocate.
+     */
+    void get_prefix_lengths(const std::string& str, std::vector<size_t>& lengths, size_t pos = 0) const;
+
+    /**
+     * Returns length of the longest string from trie that is a prefix of
+     * str.substr(pos), or 0 if there is none.
+     */
+    size_t longest_prefix(const std::string& str, size_t pos = 0) const;
+
+    /**
+     * Returns all strings from trie that end with given suffix, in lexicographical order.
+     *
+     * Suffix is inclusive, same as prefix in search_by_prefix. Scans all
+     * strings unless the reversed index is maintained (see set_index_mode).
+     */
+    std::vector<std::string> search_by_suffix(const std::string& suffix) const;
+
+    /**
+     * Returns all strings from trie that contain given substring, in lexicographical order.
+     *
+     * Scans all strings unless the suffix index is maintained (see set_index_mode).
+     */
+    std::vector<std::string> search_by_substring(const std::string& substring) const;
+
+    /**
+     * Starts maintaining given companion indexes (and stops maintaining the others).
+     *
+     * Indexes are built from the current strings and then kept in sync by
+     * insert and erase. Copies of the trie maintain the same indexes.
+     */
+    void set_index_mode(trie_index_mode mode);
+    trie_index_mode index_mode() const;
+
+    /**
+     * Returns for every string from given vector whether it is in the trie.
+     *
+     * Lookups are done in groups of batch_size strings whose walks through
+     * the trie are interleaved, so that the nodes needed by one walk are
+     * prefetched while the other walks of the group advance.
+     */
+    std::vector<bool> contains_many(const std::vector<std::string>& strings, size_t batch_size = 32) const;
+
+    /**
+     * Returns get_prefixes(str) for every string from given vector.
+     *
+     * Uses the same interleaved walks as contains_many.
+     */
+    std::vector<std::vector<std::string>> get_prefixes_many(const std::vector<std::string>& strings, size_t batch_size = 32) const;
+
+    /**
+     * Returns how many strings in the trie are lexicographically smaller than given string.
+     */
+    size_t rank(const std::string& str) const;
+
+    /**
+     * Returns i-th string of the trie in lexicographical order, counting from 0.
+     *
+     * Throws std::out_of_range if i is not less than size().
+     */
+    std::string select(size_t i) const;
+
+    /**
+     * Returns how many strings in the trie lie in the half-open range [lo, hi).
+     */
+    size_t count_range(const std::string& lo, const std::string& hi) const;
+
+    /**
+     * Returns iterator to the first string that is not less than given string,
+     * or end iterator if there is no such string.
+     */
+    const_iterator lower_bound(const std::string& str) const;
+
+    /**
+     * Strings are iterated in lexicographical order.
+     */
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * Writes the trie to given stream in a compact binary format.
+     */
+    void save(std::ostream& out) const;
+
+    /**
+     * Replaces contents of the trie with trie previously written by save.
+     *
+     * Reads exactly one snapshot from the stream, in a single pass.
+     * Throws std::invalid_argument if the stream does not contain a valid
+     * snapshot, the trie is left unchanged in that case.
+     */
+    void load(std::istream& in);
+
+    /**
+     * Returns strings that have to be added to and removed from this trie
+     * to make it contain the same strings as given trie.
+     *
+     * Both tries are walked in lock-step, subtrees present in only one of
+     * them are not compared any further.
+     */
+    trie_diff diff(const trie& target) const;
+
+    /**
+     * Removes and adds strings listed in given diff.
+     *
+     * Throws std::invalid_argument if the diff does not apply to this trie
+     * (a removed string is missing or an added string is already present),
+     * the trie is left unchanged in that case.
+     */
+    void apply_diff(const trie_diff& diff);
+
+    /**
+     * Returns how many nodes the trie has and how much memory they and the rest of the trie hold.
+     *
+     * Visits every node, takes time proportional to the number of nodes.
+     * Overhead of the memory allocator is not included.
+     */
+    trie_memory_usage memory_usage() const;
+
+    /**
+     * Reallocates nodes in depth-first order, so that nodes walked one after
+     * another lie close to each other in memory. Does the same for companion
+     * indexes. Only compacts storage, there are no empty branches to free:
+     * erase frees nodes as soon as no strings are left below them.
+     *
+     * Copies every node once, iterators to the trie are invalidated.
+     */
+    void shrink_to_fit();
+
+    void swap(trie& rhs);
+
+	// Relops
+
+	// 2 tries are equal iff they contain the same strings
+	bool operator==(const trie& rhs) const;
+	/**
+	 * Tries are compared by taking lexicographically sorted strings contained within and then lexicographically comparing these.
+	 */
+	bool operator<(const trie& rhs) const;
+
+    /**
+     * Returns new trie that contains the intersection (strings that are present in both) of the two provided tries.
+     *
+     * Only subtrees present in both tries are visited. A string keeps the
+     * smaller of its two counts. When either operand is an rvalue, the
+     * result is made from its nodes instead of new ones.
+     */
+    trie operator&(trie const& rhs) const&;
+    trie operator&(trie&& rhs) const&;
+    trie operator&(trie const& rhs) &&;
+    trie operator&(trie&& rhs) &&;
+
+    /**
+     * Returns new trie that contains the union (strings are present in at least one) of the two provided tries.
+     *
+     * Counts of strings present in both tries are added up. When either
+     * operand is an rvalue, the result is made from its nodes and only
+     * subtrees missing in it are copied (or moved) from the other operand.
+     */
+    trie operator|(trie const& rhs) const&;
+    trie operator|(trie&& rhs) const&;
+    trie operator|(trie const& rhs) &&;
+    trie operator|(trie&& rhs) &&;
+
+    /**
+     * Removes strings that are not in given trie, same as *this = *this & rhs without building a new trie.
+     */
+    trie& operator&=(const trie& rhs);
+
+    /**
+     * Adds strings of given trie, same as *this = *this | rhs without building a new trie.
+     * Subtrees missing in this trie are copied, or moved if rhs is an rvalue.
+     */
+    trie& operator|=(const trie& rhs);
+    trie& operator|=(trie&& rhs);
+
+    /**
+     * Moves all strings of given trie into this one, adding up counts of strings present in both.
+     *
+     * Subtrees missing in this trie are spliced in whole, only nodes
+     * present in both tries are visited. Leaves the other trie empty.
+     */
+    void merge_from(trie&& other);
+
+private:
+    // Builds itself directly from the nodes
+    friend class dawg;
+
+    trie_node* m_root = nullptr;
+    size_t m_size = 0;
+
+    // Companion indexes, see trie_index_mode
+    trie* m_reversed = nullptr;
+    trie* m_suffixes = nullptr;
+
+    void index_insert(const std::string& str);
+    void index_erase(const std::string& str);
+
+    void count_word(std::vector<trie_node*>& path, std::uint64_t n);
+    // Brings size and companion indexes up to date after nodes were changed directly
+    void refresh();
+};
+
+// 2 tries are unequal iff they contain different strings
+bool operator!=(const trie& lhs, const trie& rhs);
+// Lexicographical ordering, see operator< for details
+bool operator<=(const trie& lhs, const trie& rhs);
+// Lexicographical ordering, see operator< for details
+bool operator>(const trie& lhs, const trie& rhs);
+// Lexicographical ordering, see operator< for details
+bool operator>=(const trie& lhs, const trie& rhs);
+void swap(trie& lhs, trie& rhs);
+
+// Writes strings of the trie in lexicographical order, each on its own line, see save for a binary format
+std::ostream& operator<<(std::ostream& out, trie const& trie);
@@ -0,0 +1,515 @@
+#include "flatset.hpp"
+#include "tests-helpers.hpp"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Benchmarks are hidden test cases tagged [.bench], run them with
+ *
+ *     flatset.exe [.bench]
+ *
+ * Every line reports the fastest of several runs:
+ *
+ *     <operation>/<variant>/<set size>   <ns per op>   <runs>
+ */
+namespace {
+    // Runs shorter than this are repeated, the fastest run is reported
+    const double min_total_seconds = 0.5;
+    const size_t min_runs = 3;
+    const size_t max_runs = 20;
+
+    std::vector<unsigned> random_values(size_t count, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::vector<unsigned> values(count);
+        for (auto& v : values) {
+            v = gen();
+        }
+        return values;
+    }
+
+    template <typename Function>
+    double time_it(Function f) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        f();
+        auto end_time = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end_time - start_time).count();
+    }
+
+    // Keeps the compiler from optimizing away results of benchmarked calls
+    void do_not_optimize(size_t value) {
+        static volatile size_t sink;
+        sink = value;
+        (void)sink;
+    }
+
+    /*
+     * Calls measure repeatedly and prints the fastest time per operation.
+     * measure performs ops operations and returns how many seconds they took.
+     */
+    template <typename Run>
+    void run(const std::string& name, size_t ops, Run measure) {
+        double best = 0;
+        double total = 0;
+        size_t runs = 0;
+        while (runs < min_runs || (total < min_total_seconds && runs < max_runs)) {
+            double seconds = measure();
+            best = runs ? std::min(best, seconds) : seconds;
+            total += seconds;
+            ++runs;
+        }
+        std::printf("%-40s %12.1f ns/op %6zu runs\n", name.c_str(), best * 1e9 / ops, runs);
+        std::fflush(stdout);
+    }
+
+    std::string name(const char* operation, const char* variant, size_t size) {
+        return std::string(operation) + '/' + variant + '/' + std::to_string(size);
+    }
+}
+
+TEST_CASE("Benchmark: find", "[.bench]") {
+    // The largest set takes about 800 MB with its Eytzinger copy
+    const size_t queries = 1'000'000;
+    for (size_t size : { 1'000, 1'000'000, 100'000'000 }) {
+        flat_set<unsigned> fs;
+        {
+            auto values = random_values(size, 42);
+            fs.insert(values.begin(), values.end());
+        }
+
+        // Half of the queries are present, in random order
+        auto lookups = random_values(queries, 1234);
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<size_t> index(0, fs.size() - 1);
+        for (size_t i = 0; i < queries; i += 2) {
+            lookups[i] = *(fs.begin() + index(gen));
+        }
+
+        auto measure = [&] {
+            return time_it([&] {
+                size_t found = 0;
+                for (unsigned v : lookups) {
+                    found += fs.find(v) != fs.end();
+                }
+                do_not_optimize(found);
+            });
+        };
+
+        run(name("find", "std::lower_bound", size), queries, [&] {
+            return time_it([&] {
+                size_t found = 0;
+                for (unsigned v : lookups) {
+                    auto i = std::lower_bound(fs.begin(), fs.end(), v);
+                    found += i != fs.end() && *i == v;
+                }
+                do_not_optimize(found);
+            });
+        });
+        run(name("find", "branchless", size), queries, measure);
+        fs.build_eytzinger();
+        run(name("find", "eytzinger", size), queries, measure);
+    }
+}
+
+TEST_CASE("Benchmark: range insert", "[.bench]") {
+    // Batches of random values into a set of 10M, per inserted element
+    const size_t size = 10'000'000;
+    flat_set<unsigned> base;
+    {
+        auto values = random_values(size, 42);
+        base.insert(values.begin(), values.end());
+    }
+
+    for (size_t batch_size : { 1'000, 100'000, 1'000'000 }) {
+        auto batch = random_values(batch_size, 1234);
+
+        if (batch_size <= 1'000) {
+            run(name("range insert", "one by one", batch_size), batch_size, [&] {
+                flat_set<unsigned> fs(base);
+                return time_it([&] {
+                    for (unsigned v : batch) {
+                        fs.insert(v);
+                    }
+                });
+            });
+        }
+        run(name("range insert", "rebuild", batch_size), batch_size, [&] {
+            std::vector<unsigned> all(base.begin(), base.end());
+            all.reserve(size + batch_size);
+            return time_it([&] {
+                all.insert(all.end(), batch.begin(), batch.end());
+                flat_set<unsigned> fs(all.begin(), all.end());
+                do_not_optimize(fs.size());
+            });
+        });
+        run(name("range insert", "merge", batch_size), batch_size, [&] {
+            // Built from a range, so there is no spare capacity
+            flat_set<unsigned> fs(base.begin(), base.end());
+            return time_it([&] {
+                fs.insert(batch.begin(), batch.end());
+            });
+        });
+        run(name("range insert", "merge in place", batch_size), batch_size, [&] {
+            flat_set<unsigned> fs(base);
+            fs.reserve(size + batch_size);
+            return time_it([&] {
+                fs.insert(batch.begin(), batch.end());
+            });
+        });
+    }
+}
+
+TEST_CASE("Benchmark: sorted construction", "[.bench]") {
+    // 10M values that are sorted and unique already, per element
+    const size_t size = 10'000'000;
+    std::vector<unsigned> sorted = random_values(size, 42);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    run(name("sorted construction", "range", size), size, [&] {
+        return time_it([&] {
+            flat_set<unsigned> fs(sorted.begin(), sorted.end());
+            do_not_optimize(fs.size());
+        });
+    });
+    run(name("sorted construction", "sorted_unique", size), size, [&] {
+        return time_it([&] {
+            flat_set<unsigned> fs(sorted_unique, sorted.begin(), sorted.end());
+            do_not_optimize(fs.size());
+        });
+    });
+    run(name("sorted construction", "adopt", size), size, [&] {
+        std::vector<unsigned> copy = sorted;
+        return time_it([&] {
+            flat_set<unsigned> fs;
+            fs.adopt(sorted_unique, std::move(copy));
+            do_not_optimize(fs.size());
+        });
+    });
+}
+
+TEST_CASE("Benchmark: parallel construction", "[.bench]") {
+    // Random values, per element. Speed-up over the serial constructor is
+    // bounded by the cores the machine has, extra threads only add overhead.
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    for (size_t size : { 1'000'000, 16'000'000 }) {
+        auto values = random_values(size, 42);
+
+        run(name("parallel construction", "serial", size), size, [&] {
+            return time_it([&] {
+                flat_set<unsigned> fs(values.begin(), values.end());
+                do_not_optimize(fs.size());
+            });
+        });
+        for (unsigned threads : { 1, 2, 4, 8, 16 }) {
+            auto variant = std::to_string(threads) + " threads";
+            run(name("parallel construction", variant.c_str(), size), size, [&] {
+                return time_it([&] {
+                    flat_set<unsigned> fs(parallel_t(threads), values.begin(), values.end());
+                    do_not_optimize(fs.size());
+                });
+            });
+        }
+    }
+}
+
+TEST_CASE("Benchmark: move", "[.bench]") {
+    // Moving must not depend on the size, nor touch elements or the allocator
+    const size_t moves = 1'000'000;
+    for (size_t size : { 1'000, 1'000'000, 10'000'000 }) {
+        flat_set<tracker> fs;
+        {
+            std::vector<tracker> elements;
+            elements.reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                elements.emplace_back(static_cast<double>(i));
+            }
+            fs.adopt(sorted_unique, std::move(elements));
+        }
+
+        // One move constructor and one move assignment per op
+        auto label = name("move", "there and back", size);
+        auto oldt = tracker::cnt;
+        auto old_allocations = allocation_count();
+        run(label, moves, [&] {
+            return time_it([&] {
+                for (size_t i = 0; i < moves; ++i) {
+                    flat_set<tracker> other(std::move(fs));
+                    do_not_optimize(other.size());
+                    fs = std::move(other);
+                }
+            });
+        });
+        REQUIRE(tracker::cnt - oldt == counter{});
+        REQUIRE(allocation_count() == old_allocations);
+        REQUIRE(fs.size() == size);
+    }
+}
+
+TEST_CASE("Benchmark: bulk load", "[.bench]") {
+    // Random values one at a time, per element. Inserting them into the set
+    // directly shifts the half of it on average, so that is only measured up to 100K.
+    for (size_t count : { 10'000, 100'000, 1'000'000, 10'000'000 }) {
+        auto values = random_values(count, 42);
+
+        if (count <= 100'000) {
+            run(name("bulk load", "insert", count), count, [&] {
+                return time_it([&] {
+                    flat_set<unsigned> fs;
+                    for (unsigned v : values) {
+                        fs.insert(v);
+                    }
+                    do_not_optimize(fs.size());
+                });
+            });
+        }
+        run(name("bulk load", "batch_inserter", count), count, [&] {
+            return time_it([&] {
+                flat_set<unsigned> fs;
+                {
+                    auto batch = fs.batch_insert();
+                    for (unsigned v : values) {
+                        batch.insert(v);
+                    }
+                    batch.commit();
+                }
+                do_not_optimize(fs.size());
+            });
+        });
+    }
+}
+
+TEST_CASE("Benchmark: hinted insert", "[.bench]") {
+    // Sorted values appended one at a time, per element
+    for (size_t count : { 10'000, 1'000'000, 10'000'000 }) {
+        auto values = random_values(count, 42);
+        std::sort(values.begin(), values.end());
+
+        run(name("hinted insert", "insert", count), count, [&] {
+            return time_it([&] {
+                flat_set<unsigned> fs;
+                for (unsigned v : values) {
+                    fs.insert(v);
+                }
+                do_not_optimize(fs.size());
+            });
+        });
+        run(name("hinted insert", "insert at end", count), count, [&] {
+            return time_it([&] {
+                flat_set<unsigned> fs;
+                for (unsigned v : values) {
+                    fs.insert(fs.end(), v);
+                }
+                do_not_optimize(fs.size());
+            });
+        });
+        run(name("hinted insert", "emplace_hint at end", count), count, [&] {
+            return time_it([&] {
+                flat_set<unsigned> fs;
+                for (unsigned v : values) {
+                    fs.emplace_hint(fs.end(), v);
+                }
+                do_not_optimize(fs.size());
+            });
+        });
+    }
+}
+
+TEST_CASE("Benchmark: bulk erase", "[.bench]") {
+    // Deleting from a set of 10M, per deleted element. Deleting elements one at
+    // a time shifts the rest of the set each time, so it is only measured for few.
+    const size_t size = 10'000'000;
+    flat_set<unsigned> base;
+    {
+        auto values = random_values(size, 42);
+        base.insert(values.begin(), values.end());
+    }
+
+    auto measure_erase = [&] (const char* variant, size_t count, auto erase) {
+        run(name("bulk erase", variant, count), count, [&] {
+            flat_set<unsigned> fs(base);
+            return time_it([&] {
+                erase(fs);
+            });
+        });
+    };
+
+    for (size_t count : { 1'000, 100'000, 1'000'000 }) {
+        // Every (size / count)-th element, so that keys are spread over the set
+        std::vector<unsigned> keys;
+        for (size_t i = 0; i < count; ++i) {
+            keys.push_back(*(base.begin() + i * (base.size() / count)));
+        }
+
+        if (count <= 1'000) {
+            measure_erase("erase(key)", count, [&] (flat_set<unsigned>& fs) {
+                for (unsigned key : keys) {
+                    fs.erase(key);
+                }
+            });
+        }
+        measure_erase("erase_sorted", count, [&] (flat_set<unsigned>& fs) {
+            fs.erase_sorted(keys.begin(), keys.end());
+        });
+        measure_erase("erase_if", count, [&] (flat_set<unsigned>& fs) {
+            // Same elements, found by binary search in the keys
+            fs.erase_if([&] (unsigned v) { return std::binary_search(keys.begin(), keys.end(), v); });
+        });
+    }
+
+    measure_erase("erase(first_key, last_key)", size / 2, [&] (flat_set<unsigned>& fs) {
+        fs.erase(0u, 1u << 31);
+    });
+}
+
+TEST_CASE("Benchmark: set algebra", "[.bench]") {
+    // A set of 10M with sets from as large to 10000 times smaller, half of whose
+    // elements are in the large one. Reported per element of the large set.
+    const size_t size = 10'000'000;
+    flat_set<unsigned> large;
+    {
+        auto values = random_values(size, 42);
+        large.insert(values.begin(), values.end());
+    }
+
+    using sets = flat_set<unsigned>;
+    using std_algorithm = std::back_insert_iterator<std::vector<unsigned>> (*)(sets::const_iterator, sets::const_iterator, sets::const_iterator, sets::const_iterator, std::back_insert_iterator<std::vector<unsigned>>);
+    struct operation {
+        const char* name;
+        std_algorithm std_version;
+        sets (*flat_set_version)(sets const&, sets const&);
+    };
+    const operation operations[] = {
+        { "union", std::set_union, set_union },
+        { "intersection", std::set_intersection, set_intersection },
+        { "difference", std::set_difference, set_difference },
+        { "symmetric difference", std::set_symmetric_difference, set_symmetric_difference },
+    };
+
+    for (size_t ratio : { 1, 10, 100, 1'000, 10'000 }) {
+        flat_set<unsigned> small;
+        {
+            auto values = random_values(size / ratio / 2, 1234);
+            for (size_t i = 0; i < size / ratio / 2; ++i) {
+                values.push_back(*(large.begin() + i * 2 * ratio));
+            }
+            small.insert(values.begin(), values.end());
+        }
+
+        for (const auto& op : operations) {
+            std::string label = std::string(op.name) + " 1:" + std::to_string(ratio);
+            run(name("set algebra", (label + "/std + construct").c_str(), size), size, [&] {
+                return time_it([&] {
+                    std::vector<unsigned> out;
+                    op.std_version(large.begin(), large.end(), small.begin(), small.end(), std::back_inserter(out));
+                    flat_set<unsigned> result(out.begin(), out.end());
+                    do_not_optimize(result.size());
+                });
+            });
+            run(name("set algebra", (label + "/flat_set").c_str(), size), size, [&] {
+                return time_it([&] {
+                    do_not_optimize(op.flat_set_version(large, small).size());
+                });
+            });
+        }
+    }
+}
+
+namespace {
+    template <typename T>
+    using intersection_kernel = size_t (*)(const T*, size_t, const T*, size_t, T*);
+
+    // The SSE version for integers of the size of T, null if this target has none
+    template <typename T>
+    intersection_kernel<T> sse_kernel(std::integral_constant<size_t, 4>) {
+#ifdef FLATSET_SIMD_SSE2
+        return flatset_simd::intersect_sse2<T>;
+#else
+        return nullptr;
+#endif
+    }
+
+    template <typename T>
+    intersection_kernel<T> sse_kernel(std::integral_constant<size_t, 8>) {
+#ifdef FLATSET_SIMD_SSE4
+        return flatset_simd::intersect_sse4<T>;
+#else
+        return nullptr;
+#endif
+    }
+
+    // Sorted unique values below range, like document ids in posting lists
+    template <typename T>
+    std::vector<T> posting_list(size_t count, size_t range, unsigned seed) {
+        std::mt19937_64 gen(seed);
+        std::uniform_int_distribution<T> id(0, static_cast<T>(range - 1));
+        std::vector<T> ids(count);
+        for (auto& v : ids) {
+            v = id(gen);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+    template <typename T>
+    void benchmark_integer_intersection(const char* type) {
+        // Lists of 10M and 10M / ratio ids out of 40M, reported per id of the longer list
+        const size_t size = 10'000'000;
+        auto a = posting_list<T>(size, 4 * size, 1);
+        flat_set<T> fa(sorted_unique, a.begin(), a.end());
+
+        for (size_t ratio : { 1, 4, 16 }) {
+            auto b = posting_list<T>(size / ratio, 4 * size, 2);
+            flat_set<T> fb(sorted_unique, b.begin(), b.end());
+            std::vector<T> out(b.size());
+
+            auto label = [&] (const char* variant) {
+                return name("intersection", (std::string(type) + " 1:" + std::to_string(ratio) + "/" + variant).c_str(), size);
+            };
+            auto measure_kernel = [&] (const char* variant, intersection_kernel<T> kernel) {
+                run(label(variant), a.size(), [&] {
+                    return time_it([&] {
+                        do_not_optimize(kernel(a.data(), a.size(), b.data(), b.size(), out.data()));
+                    });
+                });
+            };
+
+            run(label("std::set_intersection"), a.size(), [&] {
+                return time_it([&] {
+                    std::vector<T> result;
+                    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+                    do_not_optimize(result.size());
+                });
+            });
+            measure_kernel("scalar", flatset_simd::intersect_scalar<T>);
+            if (auto kernel = sse_kernel<T>(std::integral_constant<size_t, sizeof(T)>())) {
+                measure_kernel(sizeof(T) == 4 ? "sse2" : "sse4.1", kernel);
+            }
+#ifdef FLATSET_SIMD_AVX2
+            measure_kernel("avx2", flatset_simd::intersect_avx2<T>);
+#endif
+            run(label("operator&"), a.size(), [&] {
+                return time_it([&] {
+                    do_not_optimize((fa & fb).size());
+                });
+            });
+            run(label("intersection_size"), a.size(), [&] {
+                return time_it([&] {
+                    do_not_optimize(fa.intersection_size(fb));
+                });
+            });
+        }
+    }
+}
+
+TEST_CASE("Benchmark: integer intersection", "[.bench]") {
+    benchmark_integer_intersection<std::uint32_t>("uint32");
+    benchmark_integer_intersection<std::uint64_t>("uint64");
+}
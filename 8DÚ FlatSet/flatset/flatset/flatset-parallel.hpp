@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Helpers for sorting on several threads, used by the parallel_t constructors of flat_set.
+*
+* C++14 has no parallel algorithms, so work is split into tasks of about equal size
+* and plain std::threads pick them up. Threads are started for every call and
+* joined before it returns, there is no pool kept between calls.
+*/
+namespace flatset_parallel
+{
+	// Below this many elements per thread, starting the thread costs more than it saves
+	const size_t min_elements_per_thread = 1 << 15;
+
+	// Returns how many threads to use for count elements when threads were requested,
+	// zero meaning as many as the machine runs at once
+	inline unsigned thread_count(unsigned threads, size_t count)
+	{
+		if (threads == 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		size_t useful = std::max<size_t>(1, count / min_elements_per_thread);
+		return static_cast<unsigned>(std::min<size_t>(threads, useful));
+	}
+
+	/*
+	* Calls task(0), ..., task(count - 1) on up to threads threads, the calling one included.
+	* If a task throws, the tasks not yet started are skipped and the first exception
+	* is rethrown once all threads finish. If a thread cannot be started, the ones
+	* already running are stopped after their current task and joined before the
+	* std::system_error is rethrown.
+	*/
+	template <typename Task>
+	void for_each_task(unsigned threads, size_t count, Task const& task)
+	{
+		std::atomic<size_t> next(0);
+		std::exception_ptr error;
+		std::mutex error_lock;
+
+		auto work = [&]() {
+			for (size_t i = next++; i < count; i = next++)
+			{
+				try
+				{
+					task(i);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> guard(error_lock);
+					if (!error)
+					{
+						error = std::current_exception();
+					}
+					next = count;
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(threads > 1 ? threads - 1 : 0);
+		try
+		{
+			for (unsigned t = 1; t < threads && t < count; t++)
+			{
+				workers.emplace_back(work);
+			}
+		}
+		catch (...)
+		{
+			// A running std::thread must be joined before it is destroyed
+			next = count;
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+			throw;
+		}
+		work();
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	/*
+	* Returns how many of the first diagonal elements of the stable merge of sorted
+	* ranges a and b come from a, so that a merge can be split into independent parts
+	* at any output position. Equivalent elements of a go first, like in std::merge.
+	*/
+	template <typename RandomIt, typename Comparator>
+	size_t merge_split(RandomIt a, size_t n, RandomIt b, size_t m, size_t diagonal, Comparator const& comp)
+	{
+		size_t low = diagonal > m ? diagonal - m : 0;
+		size_t high = std::min(diagonal, n);
+		while (low < high)
+		{
+			size_t i = low + (high - low) / 2;
+			size_t j = diagonal - i;
+			if (j > 0 && i < n && !comp(b[j - 1], a[i]))
+			{
+				low = i + 1;
+			}
+			else
+			{
+				high = i;
+			}
+		}
+		return low;
+	}
+}
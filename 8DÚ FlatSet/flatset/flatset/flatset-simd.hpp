@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FLATSET_SIMD_AVX2
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#include <smmintrin.h>
+#define FLATSET_SIMD_SSE4
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLATSET_SIMD_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+* Intersection of sorted arrays of 32 and 64 bit integers.
+*
+* Takes a block of each array and compares every element of one block to every
+* element of the other with a few vector comparisons (the second block is rotated
+* between them), then moves past the block with the smaller last element, or both.
+* The ends of the arrays that do not fill a block are merged one by one.
+*
+* 32 bit integers use SSE2 (always there on x64). 64 bit integers use AVX2 when the
+* compiler targets it (/arch:AVX2, -mavx2), else SSE4.1, else plain merge. The AVX2
+* version for 32 bit integers only wins when the arrays are of similar length, as
+* blocks of 8 move past fewer elements when the other array is sparse, so it is
+* not used. Define FLATSET_SCALAR to force the plain merge. Every version the
+* compiler can target is declared regardless, so that benchmarks can compare them.
+*/
+namespace flatset_simd
+{
+	inline unsigned lowest_bit(unsigned mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	/*
+	* Writes elements that are in both a and b to out and returns how many there are.
+	* out may be null, then they are only counted.
+	*/
+	template <typename T>
+	size_t intersect_scalar(const T* a, size_t n, const T* b, size_t m, T* out)
+	{
+		size_t i = 0;
+		size_t j = 0;
+		size_t count = 0;
+		while (i < n && j < m)
+		{
+			if (a[i] < b[j])
+			{
+				i++;
+			}
+			else if (b[j] < a[i])
+			{
+				j++;
+			}
+			else
+			{
+				if (out != nullptr)
+				{
+					out[count] = a[i];
+				}
+				count++;
+				i++;
+				j++;
+			}
+		}
+		return count;
+	}
+
+	// The block loop shared by the vector versions, Block::equal_lanes returns
+	// a bit for every element of the block of a that is in the block of b
+	template <typename Block, typename T>
+	size_t intersect_blocks(const T* a, size_t n, const T* b, size_t m, T* out)
+	{
+		const size_t width = Block::width;
+		size_t i = 0;
+		size_t j = 0;
+		size_t count = 0;
+		while (i + width <= n && j + width <= m)
+		{
+			unsigned mask = Block::equal_lanes(a + i, b + j);
+			if (out == nullptr)
+			{
+				for (; mask; mask &= mask - 1)
+				{
+					count++;
+				}
+			}
+			else
+			{
+				for (; mask; mask &= mask - 1)
+				{
+					out[count++] = a[i + lowest_bit(mask)];
+				}
+			}
+
+			const T a_last = a[i + width - 1];
+			const T b_last = b[j + width - 1];
+			if (a_last <= b_last)
+			{
+				i += width;
+			}
+			if (b_last <= a_last)
+			{
+				j += width;
+			}
+		}
+
+		return count + intersect_scalar(a + i, n - i, b + j, m - j, out == nullptr ? nullptr : out + count);
+	}
+
+#ifdef FLATSET_SIMD_SSE2
+	struct sse2_block32
+	{
+		static const size_t width = 4;
+
+		static unsigned equal_lanes(const void* a, const void* b)
+		{
+			__m128i va = _mm_loadu_si128(static_cast<const __m128i*>(a));
+			__m128i vb = _mm_loadu_si128(static_cast<const __m128i*>(b));
+			__m128i eq = _mm_cmpeq_epi32(va, vb);
+			vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+			vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+			vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+			return _mm_movemask_ps(_mm_castsi128_ps(eq));
+		}
+	};
+
+	template <typename T>
+	size_t intersect_sse2(const T* a, size_t n, const T* b, size_t m, T* out)
+	{
+		static_assert(sizeof(T) == 4, "SSE2 version is for 32 bit integers only");
+		return intersect_blocks<sse2_block32>(a, n, b, m, out);
+	}
+#endif
+
+#ifdef FLATSET_SIMD_SSE4
+	struct sse4_block64
+	{
+		static const size_t width = 2;
+
+		static unsigned equal_lanes(const void* a, const void* b)
+		{
+			__m128i va = _mm_loadu_si128(static_cast<const __m128i*>(a));
+			__m128i vb = _mm_loadu_si128(static_cast<const __m128i*>(b));
+			__m128i eq = _mm_cmpeq_epi64(va, vb);
+			vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2));
+			eq = _mm_or_si128(eq, _mm_cmpeq_epi64(va, vb));
+			return _mm_movemask_pd(_mm_castsi128_pd(eq));
+		}
+	};
+
+	template <typename T>
+	size_t intersect_sse4(const T* a, size_t n, const T* b, size_t m, T* out)
+	{
+		static_assert(sizeof(T) == 8, "SSE4.1 version is for 64 bit integers only");
+		return intersect_blocks<sse4_block64>(a, n, b, m, out);
+	}
+#endif
+
+#ifdef FLATSET_SIMD_AVX2
+	struct avx2_block32
+	{
+		static const size_t width = 8;
+
+		static unsigned equal_lanes(const void* a, const void* b)
+		{
+			// Every rotation is made from the loaded block, so they do not wait for each other
+			const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+			const __m256i mask = _mm256_set1_epi32(7);
+			__m256i va = _mm256_loadu_si256(static_cast<const __m256i*>(a));
+			__m256i vb = _mm256_loadu_si256(static_cast<const __m256i*>(b));
+			__m256i eq = _mm256_cmpeq_epi32(va, vb);
+			for (int r = 1; r < 8; r++)
+			{
+				__m256i rotate = _mm256_and_si256(_mm256_add_epi32(lanes, _mm256_set1_epi32(r)), mask);
+				eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, _mm256_permutevar8x32_epi32(vb, rotate)));
+			}
+			return _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+		}
+	};
+
+	struct avx2_block64
+	{
+		static const size_t width = 4;
+
+		static unsigned equal_lanes(const void* a, const void* b)
+		{
+			__m256i va = _mm256_loadu_si256(static_cast<const __m256i*>(a));
+			__m256i vb = _mm256_loadu_si256(static_cast<const __m256i*>(b));
+			__m256i eq = _mm256_cmpeq_epi64(va, vb);
+			for (int r = 1; r < 4; r++)
+			{
+				vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+				eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+			}
+			return _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+		}
+	};
+
+	template <typename T>
+	size_t intersect_avx2(const T* a, size_t n, const T* b, size_t m, T* out)
+	{
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8, "AVX2 version is for 32 and 64 bit integers only");
+		typedef typename std::conditional<sizeof(T) == 4, avx2_block32, avx2_block64>::type block;
+		return intersect_blocks<block>(a, n, b, m, out);
+	}
+#endif
+
+	// Whether the vector versions can search elements of size bytes on this target
+	template <size_t size>
+	struct has_kernel : std::false_type {};
+
+#if !defined(FLATSET_SCALAR) && defined(FLATSET_SIMD_SSE2)
+	template <>
+	struct has_kernel<4> : std::true_type {};
+#endif
+
+#if !defined(FLATSET_SCALAR) && (defined(FLATSET_SIMD_AVX2) || defined(FLATSET_SIMD_SSE4))
+	template <>
+	struct has_kernel<8> : std::true_type {};
+#endif
+
+	/*
+	* Whether flat_set<T, Comparator> intersects by the vector versions: T is an integer
+	* of 32 or 64 bits ordered by std::less, so that equivalent means equal bits.
+	*/
+	template <typename T, typename Comparator>
+	struct accelerated : std::integral_constant<bool,
+		std::is_integral<T>::value &&
+		(std::is_same<Comparator, std::less<T>>::value || std::is_same<Comparator, std::less<>>::value) &&
+		has_kernel<sizeof(T)>::value>
+	{
+	};
+
+	template <typename T>
+	size_t intersect(const T* a, size_t n, const T* b, size_t m, T* out, std::integral_constant<size_t, 4>)
+	{
+#if defined(FLATSET_SCALAR)
+		return intersect_scalar(a, n, b, m, out);
+#elif defined(FLATSET_SIMD_SSE2)
+		return intersect_sse2(a, n, b, m, out);
+#else
+		return intersect_scalar(a, n, b, m, out);
+#endif
+	}
+
+	template <typename T>
+	size_t intersect(const T* a, size_t n, const T* b, size_t m, T* out, std::integral_constant<size_t, 8>)
+	{
+#if defined(FLATSET_SCALAR)
+		return intersect_scalar(a, n, b, m, out);
+#elif defined(FLATSET_SIMD_AVX2)
+		return intersect_avx2(a, n, b, m, out);
+#elif defined(FLATSET_SIMD_SSE4)
+		return intersect_sse4(a, n, b, m, out);
+#else
+		return intersect_scalar(a, n, b, m, out);
+#endif
+	}
+
+	/*
+	* Intersects sorted arrays of unique integers, see intersect_scalar.
+	*/
+	template <typename T>
+	size_t intersect(const T* a, size_t n, const T* b, size_t m, T* out)
+	{
+		return intersect(a, n, b, m, out, std::integral_constant<size_t, sizeof(T)>());
+	}
+}
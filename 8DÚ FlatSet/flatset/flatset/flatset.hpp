@@ -1,345 +1,1367 @@
-#pragma once
-
-#include <vector>
-#include <iostream>
-#include <algorithm>
-
-using namespace std;
-/**
-* Note that when the value of an element is changed so that the comparator orders it differently, the behavior is undefined.
-*/
-
-template <typename T, typename Comparator = std::less<T>>
-class flat_set {
-private:
-	vector<T> set;
-	Comparator comp;
-
-public:
-	// These types need to be accesible from the outside:
-	// iterator
-	// const_iterator
-	// size_type
-	// value_type
-	
-	typedef typename vector<T>::const_iterator const_iterator;
-	typedef typename vector<T>::iterator iterator;
-	typedef typename vector<T>::size_type size_type;
-	typedef typename vector<T>::value_type value_type;
-
-	// Special member functions
-	flat_set()
-	{
-		set = {};
-	}
-
-	flat_set(Comparator const& cmp)
-	{
-		set = {};
-		comp = cmp;
-	}
-
-	flat_set(flat_set const& rhs)
-		:flat_set()
-	{
-		for (int i = 0; i < rhs.size(); i++)
-		{
-			set.push_back(rhs.set[i]);
-		}
-	}
-
-	flat_set(flat_set && rhs)
-	{
-		for (int i = 0; i < rhs.size(); i++)
-		{
-			set.push_back(move(rhs.set[i]));
-		}
-
-		std::sort(set.begin(), set.end(), comp);
-	}
-
-	flat_set& operator=(flat_set const& rhs)
-	{
-		flat_set(rhs).swap(*this);
-		return *this;
-	}
-	
-	flat_set& operator=(flat_set && rhs)
-	{
-		flat_set(std::move(rhs)).swap(*this);
-		return *this;
-	}
-
-	~flat_set() {}
-
-
-	// Constructs flat_set from elements in range [first, last)
-	template <typename InputIterator>
-	flat_set(InputIterator first, InputIterator last)
-	{
-		set = vector<T>(first, last);
-		std::sort(set.begin(), set.end(), comp);
-		
-		set.erase(std::unique(
-			set.begin(),
-			set.end(),
-			[this](T const &a, T const &b) {
-				return !comp(b, a) && !comp(a, b);
-			}),
-			set.end());
-	}
-
-	template <typename InputIterator>
-	flat_set(InputIterator first, InputIterator last, Comparator const& cmp)
-	{
-		comp = cmp;
-		insert(first, last, comp);
-	}
-
-
-	// Insert overloads
-	pair<iterator, bool> insert(T const& v)
-	{
-		using std::begin;
-		using std::end;
-		auto i = std::lower_bound(set.begin(), set.end(), v, comp);
-		if (i != set.end() && !comp(v, *i))
-		{
-			return std::make_pair(i, false);
-		}
-		else
-		{
-			auto foo = this->set.insert(i, v);
-			return std::make_pair(foo, true);
-		}
-	}
-
-	pair<iterator, bool> insert(T&& v)
-	{
-		using std::begin;
-		using std::end;
-		auto i = std::lower_bound(set.begin(), set.end(), v, comp);
-		if ((i != set.end()) && !comp(v, *i))
-		{
-			return std::make_pair(i, false);
-		}
-		else
-		{
-			auto foo = this->set.insert(i, std::forward<T>(v));
-			return std::make_pair(foo, true);
-		}
-	}
-
-	// Inserts [first, last) range of elements
-	template <typename InputIterator>
-	void insert(InputIterator first, InputIterator last)
-	{
-		set = vector<T>(first, last);
-		std::sort(set.begin(), set.end(), comp);
-		set.erase(std::unique(
-			set.begin(),
-			set.end(),
-			[this](T const &a, T const &b) {
-				return !comp(b, a) && !comp(a, b);
-			}),
-			set.end());
-	}
-
-	// Erase overloads
-	// Deletes element pointed-to by i, returns iterator to the next element
-	iterator erase(const_iterator i)
-	{
-		return set.erase(i);
-	}
-
-	// Deletes elements in range [first, last), returns iterator to the next element
-	iterator erase(const_iterator first, const_iterator last)
-	{
-		return set.erase(first, last);
-	}
-
-	// Deletes element equal to key if it is present, returns how many elements were deleted
-	size_type erase(value_type const& key)
-	{
-		size_type i = 0;
-		auto foo = std::equal_range(set.begin(), set.end(), key);
-		iterator first = foo.first;
-		iterator second = foo.second;
-
-		while (first != second)
-		{
-			erase(first++);
-			i++;
-		}
-
-		return i;
-	}
-
-	// Iterator member functions
-	iterator begin() noexcept
-	{
-		return set.begin();
-	}
-
-	iterator end() noexcept
-	{
-		return set.end();
-	}
-
-	const_iterator begin() const noexcept
-	{
-		return set.begin();
-	}
-
-	const_iterator end() const noexcept
-	{
-		return set.end();
-	}
-
-	const_iterator cbegin() const noexcept
-	{
-		return set.begin();
-	}
-
-	const_iterator cend() const noexcept
-	{
-		return set.end();
-	}
-
-	// The usual queries
-	bool empty() const
-	{
-		return set.empty();
-	}
-
-	size_type size() const
-	{
-		return set.size();
-	}
-
-	size_type capacity() const
-	{
-		return set.capacity();
-	}
-
-	void reserve(size_type c)
-	{
-		set.reserve(c);
-	}
-
-	void clear()
-	{
-		set.clear();
-	}
-
-	// Lookup member functions
-	// Returns iterator to element equivalent to v, or an end iterator if such element is not present
-	iterator find(T const& v)
-	{
-		iterator i = set.begin();
-		iterator end = set.end();
-		while (i != end) {
-			if (equals(*i, v))
-			{
-				return i;
-			}
-
-			i++;
-		}
-
-		return i;
-	}
-
-	const_iterator find(T const& v) const
-	{
-		auto foo = [v, this](T const& foo) {
-			return (!comp(v, foo) && !comp(foo, v));
-		};
-
-		return find_if(set.begin(), set.end(), foo);
-	}
-
-	// Returns iterator to first element that is not less than t, end iterator if no such element is present
-	iterator lower_bound(T const& t)
-	{
-		return std::lower_bound(std::begin(set), std::end(set), t, comp);
-	}
-
-	const_iterator lower_bound(T const& t) const
-	{
-		return std::lower_bound(std::begin(set), std::end(set), t, comp);
-	}
-
-	// Returns iterator to first element that is greater than t, end iterator if no such element is present
-	iterator upper_bound(T const& t)
-	{
-		return std::upper_bound(std::begin(set), std::end(set), t, comp);
-	}
-
-	const_iterator upper_bound(T const& t) const
-	{
-		return std::upper_bound(std::begin(set), std::end(set), t, comp);
-	}
-
-	void swap(flat_set& o)
-	{
-		std::swap(comp, o.comp);
-		std::swap(set, o.set);
-	}
-
-	// Lexicographical comparisons
-	bool operator==(flat_set const &a) const&
-	{
-		return this->set == a.set;
-	}
-
-	bool operator!=(flat_set const &a) const&
-	{
-		return this->set != a.set;
-	}
-
-	bool operator<(flat_set const &a) const&
-	{
-		return lexicographical_compare(this->begin(), this->end(), a.begin(), a.end(), comp);
-	}
-
-	bool operator<=(flat_set const &a) const&
-	{
-		return lexicographical_compare(this->begin(), this->end(), a.begin(), a.end(), comp) || set == a.set;
-	}
-
-	bool operator>=(flat_set const &a) const&
-	{
-		return !lexicographical_compare(this->begin(), this->end(), a.begin(), a.end(), comp) || set == a.set;
-	}
-
-	bool operator>(flat_set const &a) const&
-	{
-		return lexicographical_compare(a.begin(), a.end(), this->begin(), this->end(), comp);
-	}
-
-	//
-	// Moje funkce
-
-	bool equals(T const& a, T const& b)
-	{
-		return !comp(a, b) && !comp(b, a);
-	}
-
-	template<typename InputIterator>
-	void insert(InputIterator first, InputIterator last, Comparator cmp)
-	{
-		set = vector<T>(first, last);
-		std::sort(set.begin(), set.end(), cmp);
-		set.erase(std::unique(
-			set.begin(),
-			set.end(),
-			[this](T const &a, T const &b) {
-				return !comp(b, a) && !comp(a, b);
-			}),
-			set.end());
-	}
-};
-
-template <typename T>
-void swap(flat_set<T> const& a, flat_set<T> const& b);
\ No newline at end of file
+#pragma once
+
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "flatset-parallel.hpp"
+#include "flatset-simd.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+
+/**
+* Tag for overloads that take elements already sorted by the comparator of the set
+* and without equivalent ones, e.g. flat_set<int> fs(sorted_unique, v.begin(), v.end()).
+* Such input is not sorted again, debug builds check it.
+*/
+struct sorted_unique_t
+{
+	explicit sorted_unique_t() = default;
+};
+
+constexpr sorted_unique_t sorted_unique{};
+
+/**
+* Tag for overloads that sort and deduplicate the elements on several threads,
+* e.g. flat_set<int> fs(parallel_t(8), v.begin(), v.end()). Zero threads (the default,
+* also flat_set<int> fs(parallel, ...)) means as many as the machine runs at once.
+* Sorting takes an extra buffer as large as the input, so T must be default constructible.
+*/
+struct parallel_t
+{
+	constexpr explicit parallel_t(unsigned threads = 0)
+		:threads(threads)
+	{
+	}
+
+	unsigned threads;
+};
+
+constexpr parallel_t parallel{};
+
+template <typename...>
+struct flat_set_void
+{
+	typedef void type;
+};
+
+/**
+* Whether flat_set<T, Comparator> can look Key up without constructing T from it first:
+* Key is T, or Comparator is transparent (like std::less<>) and compares Key with T.
+*/
+template <typename T, typename Comparator, typename Key, typename = void>
+struct flat_set_key : std::is_same<Key, T>
+{
+};
+
+template <typename T, typename Comparator, typename Key>
+struct flat_set_key<T, Comparator, Key, typename flat_set_void<
+	typename Comparator::is_transparent,
+	decltype(std::declval<Comparator const&>()(std::declval<T const&>(), std::declval<Key const&>())),
+	decltype(std::declval<Comparator const&>()(std::declval<Key const&>(), std::declval<T const&>()))>::type>
+	: std::true_type
+{
+};
+
+/**
+* Note that when the value of an element is changed so that the comparator orders it differently, the behavior is undefined.
+*/
+
+template <typename T, typename Comparator = std::less<T>>
+class flat_set {
+private:
+	vector<T> set;
+	Comparator comp;
+
+	// Optional copy of the elements in Eytzinger (breadth-first) order. Empty
+	// unless build_eytzinger() was called, every modification drops it.
+	vector<T> eytzinger;
+
+public:
+	// These types need to be accesible from the outside:
+	// iterator
+	// const_iterator
+	// size_type
+	// value_type
+	
+	typedef typename vector<T>::const_iterator const_iterator;
+	typedef typename vector<T>::iterator iterator;
+	typedef typename vector<T>::size_type size_type;
+	typedef typename vector<T>::value_type value_type;
+
+	// Special member functions
+	flat_set()
+	{
+		set = {};
+	}
+
+	flat_set(Comparator const& cmp)
+	{
+		set = {};
+		comp = cmp;
+	}
+
+	flat_set(flat_set const& rhs)
+		:set(rhs.set), comp(rhs.comp), eytzinger(rhs.eytzinger) {}
+
+	// Takes over the storage of rhs, rhs is left empty
+	flat_set(flat_set && rhs) noexcept(std::is_nothrow_move_constructible<Comparator>::value)
+		:set(std::move(rhs.set)), comp(std::move(rhs.comp)), eytzinger(std::move(rhs.eytzinger))
+	{
+		rhs.set.clear();
+		rhs.eytzinger.clear();
+	}
+
+	flat_set& operator=(flat_set const& rhs)
+	{
+		flat_set(rhs).swap(*this);
+		return *this;
+	}
+	
+	flat_set& operator=(flat_set && rhs) noexcept(
+		std::is_nothrow_move_constructible<Comparator>::value && std::is_nothrow_move_assignable<Comparator>::value)
+	{
+		flat_set(std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	~flat_set() {}
+
+
+	// Constructs flat_set from elements in range [first, last)
+	template <typename InputIterator>
+	flat_set(InputIterator first, InputIterator last)
+	{
+		insert(first, last);
+	}
+
+	template <typename InputIterator>
+	flat_set(InputIterator first, InputIterator last, Comparator const& cmp)
+	{
+		comp = cmp;
+		insert(first, last);
+	}
+
+	// Constructs flat_set from range [first, last) that is sorted and unique already
+	template <typename InputIterator>
+	flat_set(sorted_unique_t, InputIterator first, InputIterator last)
+	{
+		insert(sorted_unique, first, last);
+	}
+
+	template <typename InputIterator>
+	flat_set(sorted_unique_t, InputIterator first, InputIterator last, Comparator const& cmp)
+	{
+		comp = cmp;
+		insert(sorted_unique, first, last);
+	}
+
+	// Constructs flat_set from elements in range [first, last), sorted on several threads
+	template <typename InputIterator>
+	flat_set(parallel_t how, InputIterator first, InputIterator last)
+	{
+		adopt(how, vector<T>(first, last));
+	}
+
+	template <typename InputIterator>
+	flat_set(parallel_t how, InputIterator first, InputIterator last, Comparator const& cmp)
+	{
+		comp = cmp;
+		adopt(how, vector<T>(first, last));
+	}
+
+
+	// Insert overloads
+	pair<iterator, bool> insert(T const& v)
+	{
+		auto i = lower_bound(v);
+		if (i != set.end() && !comp(v, *i))
+		{
+			return std::make_pair(i, false);
+		}
+		else
+		{
+			drop_eytzinger();
+			auto foo = this->set.insert(i, v);
+			return std::make_pair(foo, true);
+		}
+	}
+
+	pair<iterator, bool> insert(T&& v)
+	{
+		auto i = lower_bound(v);
+		if ((i != set.end()) && !comp(v, *i))
+		{
+			return std::make_pair(i, false);
+		}
+		else
+		{
+			drop_eytzinger();
+			auto foo = this->set.insert(i, std::forward<T>(v));
+			return std::make_pair(foo, true);
+		}
+	}
+
+	// Inserts v unless an equivalent element is present, returns iterator to the element.
+	// hint is checked first: when v belongs right before it, no search is done, so
+	// inserting elements in order with end() as the hint takes one comparison each.
+	iterator insert(const_iterator hint, T const& v)
+	{
+		return emplace_hint(hint, v);
+	}
+
+	iterator insert(const_iterator hint, T&& v)
+	{
+		return emplace_hint(hint, std::move(v));
+	}
+
+	// Inserts element constructed from args unless an equivalent one is present. A single
+	// argument that is T, or that the comparator compares with T, is looked up as it is
+	// and the element is only constructed once it is going to be inserted; otherwise
+	// the element is constructed first to be looked up, and moved into the set.
+	template <typename... Args>
+	pair<iterator, bool> emplace(Args&&... args)
+	{
+		auto locate = [this](auto const& key) { return place_of(key); };
+		return emplace_at(locate, is_key<Args...>(), std::forward<Args>(args)...);
+	}
+
+	// Like emplace, but checks hint first, the same as insert(hint, v)
+	template <typename... Args>
+	iterator emplace_hint(const_iterator hint, Args&&... args)
+	{
+		const size_type h = hint - set.begin();
+		auto locate = [this, h](auto const& key) { return hinted_place_of(h, key); };
+		return emplace_at(locate, is_key<Args...>(), std::forward<Args>(args)...).first;
+	}
+
+	// Inserts [first, last) range of elements. Only the new elements are sorted,
+	// then they are merged with the present ones in a single linear pass.
+	template <typename InputIterator>
+	void insert(InputIterator first, InputIterator last)
+	{
+		vector<T> batch(first, last);
+		sort_unique(batch);
+		merge_sorted(std::move(batch));
+	}
+
+	// Inserts [first, last) range of elements that is sorted and unique already
+	template <typename InputIterator>
+	void insert(sorted_unique_t, InputIterator first, InputIterator last)
+	{
+		vector<T> batch(first, last);
+		assert(is_sorted_unique(batch));
+		merge_sorted(std::move(batch));
+	}
+
+	// Collects elements for a set and adds them all at once in commit(). Adding
+	// one element only appends it to a buffer, so loading many elements costs one
+	// sort of the buffer and one merge, instead of shifting the set for every
+	// element. Elements added since the last commit are not visible in the set yet.
+	// The destructor commits them, unless an exception is unwinding the stack. An
+	// exception thrown by that commit is swallowed and the elements are dropped,
+	// call commit() explicitly to see it.
+	class batch_inserter
+	{
+	public:
+		explicit batch_inserter(flat_set& target)
+			:target(&target)
+		{
+		}
+
+		batch_inserter(batch_inserter&& rhs) noexcept
+			:target(rhs.target), pending(std::move(rhs.pending))
+		{
+			rhs.target = nullptr;
+			rhs.pending.clear();
+		}
+
+		batch_inserter(batch_inserter const&) = delete;
+		batch_inserter& operator=(batch_inserter const&) = delete;
+		batch_inserter& operator=(batch_inserter&&) = delete;
+
+		~batch_inserter()
+		{
+			if (pending.empty() || unwinding())
+			{
+				return;
+			}
+
+			try
+			{
+				commit();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		void insert(T const& v)
+		{
+			pending.push_back(v);
+		}
+
+		void insert(T&& v)
+		{
+			pending.push_back(std::move(v));
+		}
+
+		void reserve(size_type c)
+		{
+			pending.reserve(c);
+		}
+
+		// Returns how many elements wait for commit, including duplicates
+		size_type pending_size() const
+		{
+			return pending.size();
+		}
+
+		void commit()
+		{
+			if (target == nullptr || pending.empty())
+			{
+				return;
+			}
+
+			target->sort_unique(pending);
+			target->merge_sorted(std::move(pending));
+			pending.clear();
+		}
+
+	private:
+		flat_set* target;
+		vector<T> pending;
+
+		// std::uncaught_exception is deprecated since C++17, prefer its replacement where available
+		static bool unwinding() noexcept
+		{
+#if defined(__cpp_lib_uncaught_exceptions)
+			return std::uncaught_exceptions() > 0;
+#else
+			return std::uncaught_exception();
+#endif
+		}
+	};
+
+	batch_inserter batch_insert()
+	{
+		return batch_inserter(*this);
+	}
+
+	// Erase overloads
+	// Deletes element pointed-to by i, returns iterator to the next element
+	iterator erase(const_iterator i)
+	{
+		drop_eytzinger();
+		return set.erase(i);
+	}
+
+	// Deletes elements in range [first, last), returns iterator to the next element
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		drop_eytzinger();
+		return set.erase(first, last);
+	}
+
+	// Deletes element equal to key if it is present, returns how many elements were deleted
+	size_type erase(value_type const& key)
+	{
+		const_iterator i = find(key);
+		if (i == set.end())
+		{
+			return 0;
+		}
+
+		erase(i);
+		return 1;
+	}
+
+	// Deletes elements in range [first_key, last_key) of values, returns how many were deleted
+	size_type erase(value_type const& first_key, value_type const& last_key)
+	{
+		const_iterator first = lower_bound(first_key);
+		const_iterator last = lower_bound(last_key);
+		if (first >= last)
+		{
+			return 0;
+		}
+
+		size_type count = last - first;
+		erase(first, last);
+		return count;
+	}
+
+	// Deletes elements for which pred returns true in one pass, returns how many were deleted
+	template <typename Predicate>
+	size_type erase_if(Predicate pred)
+	{
+		auto last = std::remove_if(set.begin(), set.end(), pred);
+		size_type count = set.end() - last;
+		if (count != 0)
+		{
+			drop_eytzinger();
+			set.erase(last, set.end());
+		}
+
+		return count;
+	}
+
+	// Deletes elements equal to any in range [first, last), which must be sorted by the
+	// comparator of the set, returns how many were deleted. Elements that are kept are
+	// moved once at most, runs of them as blocks.
+	template <typename InputIterator>
+	size_type erase_sorted(InputIterator first, InputIterator last)
+	{
+		iterator out = set.begin();
+		iterator in = set.begin();
+		for (; first != last && in != set.end(); ++first)
+		{
+			iterator found = gallop_lower_bound(in, set.end(), *first);
+			out = (out == in) ? found : std::move(in, found, out);
+			in = found;
+			if (in != set.end() && !comp(*first, *in))
+			{
+				++in;
+			}
+		}
+
+		if (out == in)
+		{
+			return 0;
+		}
+
+		out = std::move(in, set.end(), out);
+		size_type count = set.end() - out;
+		drop_eytzinger();
+		set.erase(out, set.end());
+		return count;
+	}
+
+	// Iterator member functions
+	iterator begin() noexcept
+	{
+		return set.begin();
+	}
+
+	iterator end() noexcept
+	{
+		return set.end();
+	}
+
+	const_iterator begin() const noexcept
+	{
+		return set.begin();
+	}
+
+	const_iterator end() const noexcept
+	{
+		return set.end();
+	}
+
+	const_iterator cbegin() const noexcept
+	{
+		return set.begin();
+	}
+
+	const_iterator cend() const noexcept
+	{
+		return set.end();
+	}
+
+	// The usual queries
+	bool empty() const
+	{
+		return set.empty();
+	}
+
+	size_type size() const
+	{
+		return set.size();
+	}
+
+	size_type capacity() const
+	{
+		return set.capacity();
+	}
+
+	void reserve(size_type c)
+	{
+		set.reserve(c);
+	}
+
+	void clear()
+	{
+		drop_eytzinger();
+		set.clear();
+	}
+
+	// Lookup member functions
+	// Returns iterator to element equivalent to v, or an end iterator if such element is not present
+	iterator find(T const& v)
+	{
+		return set.begin() + find_index(v);
+	}
+
+	const_iterator find(T const& v) const
+	{
+		return set.begin() + find_index(v);
+	}
+
+	// Returns iterator to first element that is not less than t, end iterator if no such element is present
+	iterator lower_bound(T const& t)
+	{
+		return set.begin() + lower_bound_index(t);
+	}
+
+	const_iterator lower_bound(T const& t) const
+	{
+		return set.begin() + lower_bound_index(t);
+	}
+
+	// Returns iterator to first element that is greater than t, end iterator if no such element is present
+	iterator upper_bound(T const& t)
+	{
+		return set.begin() + partition_index([&](T const& e) { return !comp(t, e); });
+	}
+
+	const_iterator upper_bound(T const& t) const
+	{
+		return set.begin() + partition_index([&](T const& e) { return !comp(t, e); });
+	}
+
+	// Keeps a second copy of the elements laid out as an implicit binary tree in
+	// breadth-first order, top levels of the tree then share few cache lines and
+	// lookups can prefetch several levels ahead. Worth it for large sets that are
+	// searched much more often than modified, any modification drops the copy.
+	void build_eytzinger()
+	{
+		eytzinger = set;
+
+		// Nodes are numbered from 1, children of node k are 2k and 2k + 1
+		size_t next = 0;
+		fill_eytzinger(1, next);
+	}
+
+	bool has_eytzinger() const
+	{
+		return !set.empty() && eytzinger.size() == set.size();
+	}
+
+	void drop_eytzinger()
+	{
+		eytzinger.clear();
+		eytzinger.shrink_to_fit();
+	}
+
+	// Replaces the elements by those of v, without copying them. v is sorted and
+	// deduplicated in place, unless it is tagged as sorted_unique already.
+	void adopt(vector<T>&& v)
+	{
+		drop_eytzinger();
+		set = std::move(v);
+		sort_unique(set);
+	}
+
+	void adopt(sorted_unique_t, vector<T>&& v)
+	{
+		assert(is_sorted_unique(v));
+		drop_eytzinger();
+		set = std::move(v);
+	}
+
+	void adopt(parallel_t how, vector<T>&& v)
+	{
+		drop_eytzinger();
+		set = std::move(v);
+		parallel_sort_unique(set, how.threads);
+	}
+
+	// Gives away the sorted vector of the elements, leaves the set empty
+	vector<T> extract()
+	{
+		drop_eytzinger();
+		vector<T> elements = std::move(set);
+		set.clear();
+		return elements;
+	}
+
+	// std::swap of the comparators move constructs one and move assigns both
+	void swap(flat_set& o) noexcept(
+		std::is_nothrow_move_constructible<Comparator>::value && std::is_nothrow_move_assignable<Comparator>::value)
+	{
+		std::swap(comp, o.comp);
+		std::swap(set, o.set);
+		std::swap(eytzinger, o.eytzinger);
+	}
+
+	// Lexicographical comparisons
+	bool operator==(flat_set const &a) const&
+	{
+		return this->set == a.set;
+	}
+
+	bool operator!=(flat_set const &a) const&
+	{
+		return this->set != a.set;
+	}
+
+	bool operator<(flat_set const &a) const&
+	{
+		return lexicographical_compare(this->begin(), this->end(), a.begin(), a.end(), comp);
+	}
+
+	bool operator<=(flat_set const &a) const&
+	{
+		return lexicographical_compare(this->begin(), this->end(), a.begin(), a.end(), comp) || set == a.set;
+	}
+
+	bool operator>=(flat_set const &a) const&
+	{
+		return !lexicographical_compare(this->begin(), this->end(), a.begin(), a.end(), comp) || set == a.set;
+	}
+
+	bool operator>(flat_set const &a) const&
+	{
+		return lexicographical_compare(a.begin(), a.end(), this->begin(), this->end(), comp);
+	}
+
+	// Set algebra, results use the comparator of the left operand and take equivalent
+	// elements from it. Each is a single merge of both sets; when one is much smaller,
+	// its elements are looked up in the larger one by galloping instead, and runs of
+	// the larger set between them are copied as blocks.
+	flat_set operator|(flat_set const& o) const&
+	{
+		vector<T> out;
+		out.reserve(size() + o.size());
+		if (is_skewed(o))
+		{
+			bool left_small = size() < o.size();
+			merge_skewed(left_small ? *this : o, left_small ? o : *this, out, [&](T const& small, T const* big) {
+				out.push_back(big == nullptr || left_small ? small : *big);
+			});
+		}
+		else
+		{
+			std::set_union(set.begin(), set.end(), o.set.begin(), o.set.end(), std::back_inserter(out), comp);
+		}
+		return with_elements(std::move(out));
+	}
+
+	flat_set operator&(flat_set const& o) const&
+	{
+		vector<T> out;
+		out.reserve(std::min(size(), o.size()));
+		if (is_skewed(o))
+		{
+			bool left_small = size() < o.size();
+			for_each_in_skewed(left_small ? *this : o, left_small ? o : *this, [&](T const& small, T const* big) {
+				if (big != nullptr)
+				{
+					out.push_back(left_small ? small : *big);
+				}
+			});
+		}
+		else
+		{
+			intersect_merge(o, out, flatset_simd::accelerated<T, Comparator>());
+		}
+		return with_elements(std::move(out));
+	}
+
+	// Returns how many elements are in both sets, without building their intersection
+	size_type intersection_size(flat_set const& o) const
+	{
+		if (is_skewed(o))
+		{
+			size_type count = 0;
+			bool left_small = size() < o.size();
+			for_each_in_skewed(left_small ? *this : o, left_small ? o : *this, [&](T const&, T const* big) {
+				count += big != nullptr;
+			});
+			return count;
+		}
+
+		return count_common(o, flatset_simd::accelerated<T, Comparator>());
+	}
+
+	flat_set operator-(flat_set const& o) const&
+	{
+		vector<T> out;
+		if (is_skewed(o) && size() < o.size())
+		{
+			for_each_in_skewed(*this, o, [&](T const& small, T const* big) {
+				if (big == nullptr)
+				{
+					out.push_back(small);
+				}
+			});
+		}
+		else if (is_skewed(o))
+		{
+			out.reserve(size());
+			merge_skewed(o, *this, out, [&](T const&, T const*) {});
+		}
+		else
+		{
+			out.reserve(size());
+			std::set_difference(set.begin(), set.end(), o.set.begin(), o.set.end(), std::back_inserter(out), comp);
+		}
+		return with_elements(std::move(out));
+	}
+
+	flat_set operator^(flat_set const& o) const&
+	{
+		vector<T> out;
+		out.reserve(size() + o.size());
+		if (is_skewed(o))
+		{
+			bool left_small = size() < o.size();
+			merge_skewed(left_small ? *this : o, left_small ? o : *this, out, [&](T const& small, T const* big) {
+				if (big == nullptr)
+				{
+					out.push_back(small);
+				}
+			});
+		}
+		else
+		{
+			std::set_symmetric_difference(set.begin(), set.end(), o.set.begin(), o.set.end(), std::back_inserter(out), comp);
+		}
+		return with_elements(std::move(out));
+	}
+
+	Comparator key_comp() const
+	{
+		return comp;
+	}
+
+	//
+	// Moje funkce
+
+	bool equals(T const& a, T const& b)
+	{
+		return !comp(a, b) && !comp(b, a);
+	}
+
+private:
+	// Sorts v and keeps one element of every group of equivalent ones
+	void sort_unique(vector<T>& v) const
+	{
+		std::sort(v.begin(), v.end(), comp);
+		v.erase(std::unique(
+			v.begin(),
+			v.end(),
+			[this](T const &a, T const &b) {
+				return !comp(a, b);
+			}),
+			v.end());
+	}
+
+	/*
+	* Does the same as sort_unique on several threads. Every thread sorts a chunk of v,
+	* then the chunks are merged pairwise in rounds between v and a buffer, with every
+	* merge split between the threads at equal output positions. Last, every thread
+	* copies one element of each group of equivalent ones from its chunk, skipping
+	* those equivalent to the last element of the chunk before it, at the position
+	* that the counts of the chunks before it give.
+	*/
+	void parallel_sort_unique(vector<T>& v, unsigned threads) const
+	{
+		const size_t n = v.size();
+		threads = flatset_parallel::thread_count(threads, n);
+		if (threads <= 1)
+		{
+			sort_unique(v);
+			return;
+		}
+
+		// Chunk k is [chunks[k], chunks[k + 1])
+		vector<size_t> chunks;
+		for (size_t t = 0; t <= threads; t++)
+		{
+			chunks.push_back(n * t / threads);
+		}
+
+		flatset_parallel::for_each_task(threads, threads, [&](size_t k) {
+			std::sort(v.begin() + chunks[k], v.begin() + chunks[k + 1], comp);
+		});
+
+		vector<T> buffer(n);
+		vector<T>* from = &v;
+		vector<T>* to = &buffer;
+		vector<size_t> runs = chunks;
+		while (runs.size() > 2)
+		{
+			merge_runs(*from, *to, runs, threads);
+			std::swap(from, to);
+		}
+
+		// Counts are taken before any element is moved, as the first kept
+		// element of a chunk depends on the last one of the chunk before it
+		vector<T>& source = *from;
+		vector<T>& target = *to;
+		vector<size_t> starts(threads);
+		vector<size_t> kept(threads + 1, 0);
+		flatset_parallel::for_each_task(threads, threads, [&](size_t chunk) {
+			size_t i = chunks[chunk];
+			const size_t end = chunks[chunk + 1];
+			while (i > 0 && i < end && !comp(source[chunks[chunk] - 1], source[i]))
+			{
+				i++;
+			}
+			starts[chunk] = i;
+
+			size_t count = 0;
+			for (; i < end; i++)
+			{
+				if (count == 0 || comp(source[i - 1], source[i]))
+				{
+					count++;
+				}
+			}
+			kept[chunk + 1] = count;
+		});
+
+		for (size_t t = 0; t < threads; t++)
+		{
+			kept[t + 1] += kept[t];
+		}
+
+		flatset_parallel::for_each_task(threads, threads, [&](size_t chunk) {
+			const size_t first = kept[chunk];
+			size_t out = first;
+			for (size_t i = starts[chunk], end = chunks[chunk + 1]; i < end; i++)
+			{
+				if (out == first || comp(target[out - 1], source[i]))
+				{
+					target[out++] = std::move(source[i]);
+				}
+			}
+		});
+
+		if (to != &v)
+		{
+			v.swap(buffer);
+		}
+		v.erase(v.begin() + kept[threads], v.end());
+	}
+
+	// Merges pairs of neighbouring runs of from to the same positions of to, the last
+	// run is moved as it is when their number is odd. runs then bounds the merged ones.
+	void merge_runs(vector<T>& from, vector<T>& to, vector<size_t>& runs, unsigned threads) const
+	{
+		struct part
+		{
+			size_t first;
+			size_t middle;
+			size_t last;
+			size_t begin;
+			size_t end;
+		};
+
+		// Splits every merge into parts of about n / threads elements
+		const size_t n = from.size();
+		const size_t part_size = std::max<size_t>(1, (n + threads - 1) / threads);
+		vector<part> parts;
+		vector<size_t> merged;
+		for (size_t k = 0; k + 1 < runs.size(); k += 2)
+		{
+			size_t first = runs[k];
+			size_t middle = runs[k + 1];
+			size_t last = k + 2 < runs.size() ? runs[k + 2] : middle;
+			for (size_t begin = 0; begin < last - first; begin += part_size)
+			{
+				parts.push_back({ first, middle, last, begin, std::min(begin + part_size, last - first) });
+			}
+			merged.push_back(first);
+		}
+		merged.push_back(n);
+
+		flatset_parallel::for_each_task(threads, parts.size(), [&](size_t k) {
+			part const& p = parts[k];
+			auto a = from.begin() + p.first;
+			auto b = from.begin() + p.middle;
+			size_t a_size = p.middle - p.first;
+			size_t b_size = p.last - p.middle;
+			size_t a_begin = flatset_parallel::merge_split(a, a_size, b, b_size, p.begin, comp);
+			size_t a_end = flatset_parallel::merge_split(a, a_size, b, b_size, p.end, comp);
+			std::merge(
+				std::make_move_iterator(a + a_begin),
+				std::make_move_iterator(a + a_end),
+				std::make_move_iterator(b + (p.begin - a_begin)),
+				std::make_move_iterator(b + (p.end - a_end)),
+				to.begin() + p.first + p.begin,
+				comp);
+		});
+
+		runs.swap(merged);
+	}
+
+	bool is_sorted_unique(vector<T> const& v) const
+	{
+		return std::adjacent_find(v.begin(), v.end(), [this](T const& a, T const& b) { return !comp(a, b); }) == v.end();
+	}
+
+	// Adds elements of batch, which must be sorted and unique, to set
+	void merge_sorted(vector<T>&& batch)
+	{
+		if (batch.empty())
+		{
+			return;
+		}
+
+		drop_eytzinger();
+		if (set.empty())
+		{
+			set = std::move(batch);
+			return;
+		}
+
+		// Leave out elements that are present already. Every search starts where
+		// the previous one ended, which takes O(m log(n / m)) for m new elements.
+		auto hint = set.begin();
+		size_t kept = 0;
+		for (size_t i = 0; i < batch.size(); i++)
+		{
+			hint = gallop_lower_bound(hint, set.end(), batch[i]);
+			if (hint == set.end() || comp(batch[i], *hint))
+			{
+				if (kept != i)
+				{
+					batch[kept] = std::move(batch[i]);
+				}
+				kept++;
+			}
+		}
+		batch.erase(batch.begin() + kept, batch.end());
+
+		const size_t n = set.size();
+		const size_t m = batch.size();
+
+		if (set.capacity() < n + m)
+		{
+			vector<T> merged;
+			merged.reserve(std::max(n + m, 2 * set.capacity()));
+			std::merge(
+				std::make_move_iterator(set.begin()),
+				std::make_move_iterator(set.end()),
+				std::make_move_iterator(batch.begin()),
+				std::make_move_iterator(batch.end()),
+				std::back_inserter(merged),
+				comp);
+			set.swap(merged);
+			return;
+		}
+
+		// Merges in place from the back. The m largest elements go past the end,
+		// where they have to be appended in increasing order, so first find out
+		// how many of them come from set and how many from batch.
+		size_t from_set = 0;
+		size_t from_batch = 0;
+		while (from_set + from_batch < m)
+		{
+			if (from_set < n && comp(batch[m - 1 - from_batch], set[n - 1 - from_set]))
+			{
+				from_set++;
+			}
+			else
+			{
+				from_batch++;
+			}
+		}
+
+		// Capacity is enough, so appending does not invalidate references into set
+		size_t i = n - from_set;
+		size_t j = m - from_batch;
+		while (i < n || j < m)
+		{
+			if (j == m || (i < n && comp(set[i], batch[j])))
+			{
+				set.push_back(std::move(set[i++]));
+			}
+			else
+			{
+				set.push_back(std::move(batch[j++]));
+			}
+		}
+
+		// The rest fills [0, n), writing never overtakes reading from set. Elements
+		// of set that go between two elements of batch are moved as one block.
+		size_t out = n;
+		i = n - from_set;
+		j = m - from_batch;
+		while (j > 0)
+		{
+			T const& v = batch[j - 1];
+			size_t step = 1;
+			while (step <= i && comp(v, set[i - step]))
+			{
+				step *= 2;
+			}
+
+			size_t greater = std::upper_bound(set.begin() + (i - std::min(step, i)), set.begin() + (i - step / 2), v, comp) - set.begin();
+			std::move_backward(set.begin() + greater, set.begin() + i, set.begin() + out);
+			out -= i - greater;
+			i = greater;
+			set[--out] = std::move(batch[--j]);
+		}
+	}
+
+	// Galloping costs about 2 log(large / small) comparisons per element of the smaller
+	// set, a linear merge about 1 + large / small, with more predictable branches
+	static const size_t gallop_ratio = 32;
+
+	bool is_skewed(flat_set const& o) const
+	{
+		return std::min(size(), o.size()) * gallop_ratio < std::max(size(), o.size());
+	}
+
+	// Calls f(element, equal) for every element of small in order, equal points to the
+	// equivalent element of big or is null if there is none
+	template <typename Function>
+	void for_each_in_skewed(flat_set const& small, flat_set const& big, Function f) const
+	{
+		auto from = big.set.begin();
+		for (T const& v : small.set)
+		{
+			from = gallop_lower_bound(from, big.set.end(), v);
+			f(v, (from != big.set.end() && !comp(v, *from)) ? &*from : nullptr);
+		}
+	}
+
+	// Like for_each_in_skewed, but first appends the elements of big that precede
+	// the element of small to out, and the rest of big at the end. Elements of big
+	// equivalent to one of small are left to f.
+	template <typename Function>
+	void merge_skewed(flat_set const& small, flat_set const& big, vector<T>& out, Function f) const
+	{
+		auto from = big.set.begin();
+		for (T const& v : small.set)
+		{
+			auto found = gallop_lower_bound(from, big.set.end(), v);
+			out.insert(out.end(), from, found);
+			from = found;
+			if (from != big.set.end() && !comp(v, *from))
+			{
+				f(v, &*from);
+				++from;
+			}
+			else
+			{
+				f(v, nullptr);
+			}
+		}
+		out.insert(out.end(), from, big.set.end());
+	}
+
+	// Integers ordered by std::less are intersected by vector comparisons of blocks
+	void intersect_merge(flat_set const& o, vector<T>& out, std::true_type) const
+	{
+		out.resize(std::min(size(), o.size()));
+		out.resize(flatset_simd::intersect(set.data(), size(), o.set.data(), o.size(), out.data()));
+	}
+
+	void intersect_merge(flat_set const& o, vector<T>& out, std::false_type) const
+	{
+		std::set_intersection(set.begin(), set.end(), o.set.begin(), o.set.end(), std::back_inserter(out), comp);
+	}
+
+	size_type count_common(flat_set const& o, std::true_type) const
+	{
+		return flatset_simd::intersect(set.data(), size(), o.set.data(), o.size(), static_cast<T*>(nullptr));
+	}
+
+	size_type count_common(flat_set const& o, std::false_type) const
+	{
+		size_type count = 0;
+		auto i = set.begin();
+		auto j = o.set.begin();
+		while (i != set.end() && j != o.set.end())
+		{
+			if (comp(*i, *j))
+			{
+				++i;
+			}
+			else if (comp(*j, *i))
+			{
+				++j;
+			}
+			else
+			{
+				count++;
+				++i;
+				++j;
+			}
+		}
+		return count;
+	}
+
+	flat_set with_elements(vector<T>&& elements) const
+	{
+		flat_set result(comp);
+		result.set = std::move(elements);
+		return result;
+	}
+
+	// Returns the first element in [first, last) not less than v, like std::lower_bound,
+	// in O(log d) steps for the answer d elements from first
+	template <typename Iterator>
+	Iterator gallop_lower_bound(Iterator first, Iterator last, T const& v) const
+	{
+		const size_t length = last - first;
+		size_t bound = 1;
+		while (bound <= length && comp(first[bound - 1], v))
+		{
+			bound *= 2;
+		}
+
+		return std::lower_bound(first + bound / 2, first + std::min(bound, length), v, comp);
+	}
+
+	template <typename... Args>
+	struct is_key : std::false_type
+	{
+	};
+
+	template <typename Arg>
+	struct is_key<Arg> : flat_set_key<T, Comparator, typename std::decay<Arg>::type>
+	{
+	};
+
+	// Returns index of the first element not less than key and whether it is equivalent to key
+	template <typename Key>
+	pair<size_type, bool> place_of(Key const& key) const
+	{
+		size_type i = partition_index([&](T const& e) { return comp(e, key); });
+		return std::make_pair(i, i != set.size() && !comp(key, set[i]));
+	}
+
+	// Same as place_of, but first checks whether key belongs right before index hint,
+	// or is equivalent to the element at hint or the one before it
+	template <typename Key>
+	pair<size_type, bool> hinted_place_of(size_type hint, Key const& key) const
+	{
+		if (hint == set.size() || comp(key, set[hint]))
+		{
+			if (hint == 0 || comp(set[hint - 1], key))
+			{
+				return std::make_pair(hint, false);
+			}
+			if (!comp(key, set[hint - 1]))
+			{
+				return std::make_pair(hint - 1, true);
+			}
+		}
+		else if (!comp(set[hint], key))
+		{
+			return std::make_pair(hint, true);
+		}
+
+		return place_of(key);
+	}
+
+	template <typename Locate, typename Key>
+	pair<iterator, bool> emplace_at(Locate locate, std::true_type, Key&& key)
+	{
+		pair<size_type, bool> place = locate(key);
+		if (place.second)
+		{
+			return std::make_pair(set.begin() + place.first, false);
+		}
+
+		drop_eytzinger();
+		return std::make_pair(set.emplace(set.begin() + place.first, std::forward<Key>(key)), true);
+	}
+
+	template <typename Locate, typename... Args>
+	pair<iterator, bool> emplace_at(Locate locate, std::false_type, Args&&... args)
+	{
+		T value(std::forward<Args>(args)...);
+		return emplace_at(locate, std::true_type(), std::move(value));
+	}
+
+	size_type lower_bound_index(T const& v) const
+	{
+		return partition_index([&](T const& e) { return comp(e, v); });
+	}
+
+	size_type find_index(T const& v) const
+	{
+		if (has_eytzinger())
+		{
+			// The node was just read, unlike its place in set
+			size_t k = eytzinger_lower_node([&](T const& e) { return comp(e, v); });
+			return (k == 0 || comp(v, eytzinger[k - 1])) ? set.size() : eytzinger_index(k);
+		}
+
+		size_type i = lower_bound_index(v);
+		return (i != set.size() && comp(v, set[i])) ? set.size() : i;
+	}
+
+	// Returns index of the first element for which below is false, all elements
+	// for which it is true come before it (below is comp(e, v) or !comp(v, e)).
+	template <typename Predicate>
+	size_type partition_index(Predicate below) const
+	{
+		if (has_eytzinger())
+		{
+			size_t k = eytzinger_lower_node(below);
+			return k == 0 ? set.size() : eytzinger_index(k);
+		}
+
+		size_type n = set.size();
+		if (n == 0)
+		{
+			return 0;
+		}
+
+		// Halves the range with a conditional move instead of a branch, which
+		// the CPU could only guess, so the loop runs the same for every key.
+		// Without speculation nothing loads ahead, so both of the possible next
+		// middles are prefetched.
+		const T* base = set.data();
+		while (n > 1)
+		{
+			size_type half = n / 2;
+			prefetch(base + half / 2);
+			prefetch(base + half + half / 2);
+			base = below(base[half]) ? base + half : base;
+			n -= half;
+		}
+
+		return (base - set.data()) + (below(*base) ? 1 : 0);
+	}
+
+	// Returns the node of the first element for which below is false, 0 if there is none
+	template <typename Predicate>
+	size_t eytzinger_lower_node(Predicate below) const
+	{
+		// Descendants of node k four levels down are the 16 nodes from 16k,
+		// they are adjacent and (for small elements) share a cache line
+		const size_type n = eytzinger.size();
+		size_type k = 1;
+		while (k <= n)
+		{
+			prefetch(&eytzinger[std::min(16 * k, n) - 1]);
+			k = 2 * k + (below(eytzinger[k - 1]) ? 1 : 0);
+		}
+
+		// Every step to the right added a 1 bit, the lower bound is the node where
+		// the search went left for the last time, i.e. k without the trailing
+		// ones and the zero above them. Node 0 means all elements are below.
+		return k >> (trailing_ones(k) + 1);
+	}
+
+	// Returns index in set of the element at node k, computed instead of stored.
+	// The tree is a perfect tree with its last level cut short. In the perfect
+	// tree, node k is preceded by (2 * (k - 2^depth) + 1) * 2^(levels - depth - 1) - 1
+	// nodes in order; the nodes missing from the last level are subtracted, the
+	// last level takes every even position of the perfect order.
+	size_t eytzinger_index(size_t k) const
+	{
+		const size_t n = eytzinger.size();
+		const unsigned levels = highest_bit(n) + 1;
+		const unsigned depth = highest_bit(k);
+
+		size_t perfect = ((2 * (k - (size_t(1) << depth)) + 1) << (levels - depth - 1)) - 1;
+		size_t present_in_last = n - (size_t(1) << (levels - 1)) + 1;
+		size_t last_before = (perfect + 1) / 2;
+		return perfect - (last_before > present_in_last ? last_before - present_in_last : 0);
+	}
+
+	// Copies elements from set in sorted order to the subtree of node k
+	void fill_eytzinger(size_t k, size_t& next)
+	{
+		if (k <= set.size())
+		{
+			fill_eytzinger(2 * k, next);
+			eytzinger[k - 1] = set[next++];
+			fill_eytzinger(2 * k + 1, next);
+		}
+	}
+
+	static unsigned trailing_ones(size_t k)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctzll(~static_cast<unsigned long long>(k));
+#else
+		unsigned ones = 0;
+		for (; k & 1; k >>= 1)
+		{
+			ones++;
+		}
+		return ones;
+#endif
+	}
+
+	static unsigned highest_bit(size_t k)
+	{
+#if defined(__GNUC__)
+		return 63 - __builtin_clzll(static_cast<unsigned long long>(k));
+#else
+		unsigned bit = 0;
+		while (k >>= 1)
+		{
+			bit++;
+		}
+		return bit;
+#endif
+	}
+
+	static void prefetch(T const* p)
+	{
+#if defined(__GNUC__)
+		__builtin_prefetch(p);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0);
+#else
+		(void)p;
+#endif
+	}
+};
+
+template <typename T, typename Comparator>
+flat_set<T, Comparator> set_union(flat_set<T, Comparator> const& a, flat_set<T, Comparator> const& b)
+{
+	return a | b;
+}
+
+template <typename T, typename Comparator>
+flat_set<T, Comparator> set_intersection(flat_set<T, Comparator> const& a, flat_set<T, Comparator> const& b)
+{
+	return a & b;
+}
+
+template <typename T, typename Comparator>
+flat_set<T, Comparator> set_difference(flat_set<T, Comparator> const& a, flat_set<T, Comparator> const& b)
+{
+	return a - b;
+}
+
+template <typename T, typename Comparator>
+flat_set<T, Comparator> set_symmetric_difference(flat_set<T, Comparator> const& a, flat_set<T, Comparator> const& b)
+{
+	return a ^ b;
+}
+
+template <typename T, typename Comparator, typename Predicate>
+typename flat_set<T, Comparator>::size_type erase_if(flat_set<T, Comparator>& s, Predicate pred)
+{
+	return s.erase_if(pred);
+}
+
+template <typename T, typename Comparator>
+void swap(flat_set<T, Comparator>& a, flat_set<T, Comparator>& b) noexcept(noexcept(a.swap(b)))
+{
+	a.swap(b);
+}
\ No newline at end of file
@@ -1,946 +1,1739 @@
-#include "flatset.hpp"
-#include "tests-helpers.hpp"
-#include "catch.hpp"
-
-#include <forward_list>
-#include <type_traits>
-#include <algorithm>
-#include <vector>
-#include <set>
-#include <iterator>
-#include <random>
-#include <chrono>
-#include <climits>
-#include <type_traits>
-#include <cmath>
-#include <iostream>
-#include <functional>
-#include <numeric>
-
-namespace {
-    template <typename T> struct is_flat_set : std::false_type {};
-    template <typename T> struct is_flat_set<flat_set<T>> : std::true_type {};
-
-    template <typename T, typename = is_flat_set<T>>
-    bool reports_as_empty(const T& s) {
-        return s.empty() && (s.size() == 0);
-    }
-    template <typename T, typename = is_flat_set<T>>
-    bool set_equal(const T &a, const std::set<typename T::value_type> &b) {
-        return std::equal(a.begin(), a.end(), b.begin(), b.end());
-    }
-    template <typename T, typename = is_flat_set<T>>
-    bool set_equal(const T &a, std::initializer_list<typename T::value_type> &&b) {
-        return set_equal(a, std::set<typename T::value_type>(std::move(b)));
-    }
-    template <typename T, typename = is_flat_set<T>>
-    bool set_equal(const T &a, const std::vector<typename T::value_type> &vb) {
-        std::set<typename T::value_type> b(vb.begin(), vb.end());
-        return std::equal(a.begin(), a.end(), b.begin(), b.end());
-    }
-    template <typename T>
-    flat_set<T> make_flat_set(std::vector<T> const &v) {
-        return flat_set<T>(v.begin(), v.end());
-    }
-    class MyKey {
-        friend struct MyKeyComparator;
-        int i;
-        static unsigned s_nconstructs;
-        operator int() const {return i;}
-    public:
-        static unsigned nconstructs() {return s_nconstructs;}
-
-        explicit MyKey(int i = 0) : i(i) {s_nconstructs++;}
-        MyKey(const MyKey &o) : i(o.i) {s_nconstructs++;}
-        MyKey& operator=(const MyKey &o) {i = o.i; s_nconstructs++; return *this;}
-        MyKey(MyKey &&o) = default;
-        MyKey& operator=(MyKey &&o) = default;
-    };
-    struct MyKeyComparator {
-        bool operator()(MyKey const &a, MyKey const &b) const {
-            return a.i < b.i;
-        }
-    };
-    template <typename C, typename T, typename U>
-    bool equals(T &&a, U &&b, C &&cmp = C()) {
-        return !cmp(a, b) && !cmp(b, a);
-    }
-
-    unsigned MyKey::s_nconstructs = 0;
-
-
-    std::mt19937 mt{ std::random_device{}() };
-    std::uniform_int_distribution<> dist(INT_MIN, INT_MAX);
-
-    std::vector<int> generate(size_t N) {
-        std::vector<int> res;
-        res.reserve(N);
-
-        for (size_t i=0; i<N; ++i) {
-            res.push_back(dist(mt));
-        }
-        return res;
-    }
-    static int randint() {
-        return dist(mt);
-    }
-}
-
-TEST_CASE("Compilation tests") {
-    auto l = make_flat_set<int>({ 1, 2 });
-    const auto& const_l = l;
-    REQUIRE(!const_l.empty());
-    REQUIRE(const_l.size() == 2);
-    flat_set<int>::iterator it = l.begin();
-    flat_set<int>::const_iterator cit = it;
-    static_cast<void>(cit); // silence unused variable warning
-}
-
-TEST_CASE("compile-time tests") {
-    using namespace std;
-
-    // nice idea, but ...
-    static_assert(!is_convertible<flat_set<int>*, std::set<int>*>::value, "do not derive drom std::set :)");
-
-    using my_set = flat_set<int>;
-    my_set fs;
-    my_set::iterator i = fs.begin();
-    my_set::const_iterator ci = const_cast<const my_set&>(fs).begin();
-
-    static_assert(is_convertible<my_set::iterator, my_set::const_iterator>::value, "An iterator has to be convertible to const iterator");
-    // either const_iterator is not convertible to iterator or even iterator is const, so that it does not matter
-    static_assert(!is_convertible<my_set::const_iterator, my_set::iterator>::value || is_const<remove_reference_t<iterator_traits<my_set::iterator>::reference>>::value, "");
-    // iterators are random access; this also prevents using std::set
-    static_assert(is_same<iterator_traits<my_set::iterator>::iterator_category, random_access_iterator_tag>::value, "");
-}
-
-TEST_CASE("Anticheat tests") {
-    // Don't implement flat_set via set ... not even by composition
-    SECTION("The underlying storage is contiguous") {
-        auto fs = make_flat_set<int>({1,2,3,4,5});
-        int *expected = &*fs.begin();
-
-        for (auto i = fs.begin(), e = fs.end(); i != e; ++i) {
-            REQUIRE(expected == &*i);
-            expected++;
-        }
-    }
-}
-
-// Because the basic impl is super easy, all non-optimized funcitonality is rolled into one
-TEST_CASE("Basic functionality -- constructors, {pop, push}_{front, back}, size, empty") {
-    SECTION("Range constructor") {
-        SECTION("Empty range -> empty set") {
-            std::vector<int> v;
-            REQUIRE(reports_as_empty(flat_set<int>(v.begin(), v.end())));
-        }
-        SECTION("Singular range -> singular set") {
-            auto fs2 = make_flat_set<int>({1});
-            REQUIRE(!fs2.empty());
-            REQUIRE(fs2.size() == 1);
-            REQUIRE(*fs2.begin() == 1);
-        }
-        SECTION("Multiple elements in order") {
-            std::vector<int> elems({ 1, 2, 3, 56, 78, 86 });
-            flat_set<int> s3(elems.begin(), elems.end());
-            REQUIRE(!s3.empty());
-            REQUIRE(s3.size() == 6);
-            REQUIRE(set_equal(s3, elems));
-        }
-        SECTION("Multiple elements out of order") {
-            std::vector<int> elems({ 1, 86, 2, 56, 78, 3 });
-            flat_set<int> s3(elems.begin(), elems.end());
-            REQUIRE(!s3.empty());
-            REQUIRE(s3.size() == 6);
-            REQUIRE(set_equal(s3, {1,2,3,56,78,86}));
-        }
-        SECTION("Multiple elements with duplicates") {
-            std::vector<int> elems({ 1, 2, 3, 56, 2, 78, 78, 86, 1 });
-            flat_set<int> s3(elems.begin(), elems.end());
-            REQUIRE(!s3.empty());
-            REQUIRE(s3.size() == 6);
-            REQUIRE(set_equal(s3, {1,2,3,56,78,86}));
-        }
-    }
-    SECTION("Series of inserts in order") {
-        flat_set<int> fs;
-        for (int i : {-9, 0, 2000, 543210123}) {
-            fs.insert(i);
-            REQUIRE(*(--fs.end()) == i);
-        }
-        REQUIRE(fs.size() == 4);
-        REQUIRE(set_equal(fs, { -9, 0, 2000, 543210123 }));
-    }
-    SECTION("Series of inserts out of order") {
-        flat_set<int> fs;
-        std::vector<int> elems = {5, 0, 1, 2, 9};
-        for (int i : elems) {
-            fs.insert(i);
-            REQUIRE(std::is_sorted(fs.begin(), fs.end()));
-        }
-        REQUIRE(fs.size() == 5);
-        REQUIRE(set_equal(fs, { 0, 1, 2, 5, 9 }));
-    }
-    SECTION("Range insert") {
-        flat_set<int> fs;
-        std::vector<int> elems = {5, 0, 0, 1, 9, 2};
-        fs.insert(elems.begin(), elems.end());
-        REQUIRE(fs.size() == 5);
-        REQUIRE(set_equal(fs, { 0, 1, 2, 5, 9 }));
-    }
-    SECTION("insert return value") {
-        flat_set<int> fs;
-        std::pair<flat_set<int>::iterator, bool> ret;
-        ret = fs.insert(1);
-        REQUIRE(ret.second == true);
-        REQUIRE(ret.first == fs.begin());
-        ret = fs.insert(2);
-        REQUIRE(ret.second == true);
-        REQUIRE(ret.first == ++fs.begin());
-        ret = fs.insert(1);
-        REQUIRE(ret.second == false);
-        REQUIRE(ret.first == fs.begin());
-    }
-    SECTION("erase") {
-        flat_set<int> fs;
-        std::vector<int> elems = {0,1,2,5,9};
-        flat_set<int>::iterator i;
-        flat_set<int>::size_type ret;
-        fs.insert(elems.begin(), elems.end());
-        REQUIRE(set_equal(fs, {0,1,2,5,9}));
-
-        i = fs.erase(fs.begin());
-        REQUIRE(i == fs.begin());
-        REQUIRE(set_equal(fs, {1,2,5,9}));
-
-        i = fs.find(5);
-        i = fs.erase(i);
-        REQUIRE(*i == 9);
-        REQUIRE(set_equal(fs, {1,2,9}));
-
-        ret = fs.erase(123);
-        REQUIRE(ret == 0);
-        ret = fs.erase(2);
-        REQUIRE(ret == 1);
-        REQUIRE(set_equal(fs, { 1, 9 }));
-
-        i = fs.erase(fs.begin(), fs.end());
-        REQUIRE(reports_as_empty(fs));
-        REQUIRE(i == fs.end());
-    }
-    SECTION("find") {
-        auto fs2 = make_flat_set<int>({5, 0, 0, 1, 9, 2});
-        REQUIRE(fs2.find(0) == fs2.begin()+0);
-        REQUIRE(fs2.find(9) == fs2.begin()+4);
-        REQUIRE(fs2.find(42) == fs2.end()); // greater than max
-        REQUIRE(fs2.find(-1) == fs2.end()); // lesser than min
-        REQUIRE(fs2.find(3) == fs2.end());  // in range, but not present
-    }
-    SECTION("find in empty set") {
-        flat_set<int> fs2;
-        REQUIRE(fs2.find(42) == fs2.end()); // should not crash on *0
-    }
-    SECTION("lower_bound") {
-        auto fs2 = make_flat_set<int>({5, 0, 0, 1, 9, 2});
-        REQUIRE(fs2.lower_bound(0) == fs2.begin());
-        REQUIRE(fs2.lower_bound(9) == fs2.begin()+4);
-        REQUIRE(fs2.lower_bound(42) == fs2.end()); // greater than max
-        REQUIRE(fs2.lower_bound(-1) == fs2.begin()); // lesser than min
-        REQUIRE(fs2.lower_bound(3) == fs2.begin()+3);  // in range, but not present
-    }
-    SECTION("upper_bound") {
-        auto fs2 = make_flat_set<int>({ 5, 0, 0, 1, 9, 2 });
-        REQUIRE(fs2.upper_bound(0) == fs2.begin() + 1);
-        REQUIRE(fs2.upper_bound(9) == fs2.end());
-        REQUIRE(fs2.lower_bound(42) == fs2.end()); // greater than max
-        REQUIRE(fs2.upper_bound(-1) == fs2.begin()); // lesser than min
-        REQUIRE(fs2.upper_bound(3) == fs2.begin() + 3);  // in range, but not present
-    }
-    SECTION("size, clear, capacity, reserve") {
-        flat_set<int> fs2;
-        REQUIRE(fs2.size() == 0);
-
-        fs2.insert(42);
-        REQUIRE(fs2.size() == 1);
-        REQUIRE(fs2.capacity() >= fs2.size());
-
-        fs2.clear();
-        REQUIRE(fs2.size() == 0);
-
-        fs2.reserve(1024);
-        REQUIRE(fs2.capacity() >= 1024);
-    }
-}
-
-TEST_CASE("Iterators") {
-    SECTION("Empty flat_set's iterators should be equal.") {
-        flat_set<int> l;
-        REQUIRE(l.begin() == l.end());
-    }
-    SECTION("Non empty flat_set") {
-        auto l1 = make_flat_set<int>({ 1, 2, 3 });
-        SECTION("Moving through the flat_set") {
-            auto sit = l1.begin();
-            auto eit = l1.end();
-            REQUIRE(sit != eit);
-            SECTION("Forward") {
-                ++sit;
-                REQUIRE(sit != eit);
-                ++sit;
-                REQUIRE(sit != eit);
-                ++sit;
-                REQUIRE(sit == eit);
-            }
-            SECTION("Backward") {
-                --eit;
-                REQUIRE(sit != eit);
-                --eit;
-                REQUIRE(sit != eit);
-                --eit;
-                REQUIRE(sit == eit);
-            }
-            SECTION("Forward - postincr") {
-                REQUIRE(sit++ != eit);
-                REQUIRE(sit++ != eit);
-                REQUIRE(sit++ != eit);
-                REQUIRE(sit   == eit);
-            }
-            SECTION("Backward - postdecr") {
-                REQUIRE(sit != eit--);
-                REQUIRE(sit != eit--);
-                REQUIRE(sit != eit--);
-                REQUIRE(sit == eit);
-            }
-        }
-        SECTION("Dereferencing iterators") {
-            auto sit = l1.begin();
-            for (int i = 1; i <= 3; ++i) {
-                REQUIRE(*sit == i);
-                ++sit;
-            }
-            REQUIRE(sit == l1.end());
-        }
-    }
-    SECTION("Constructors") {
-        SECTION("Default inited iterators should be equal") {
-            flat_set<int>::iterator it, it2;
-            REQUIRE(it == it2);
-        }
-        SECTION("Iterator's copy is equal") {
-            flat_set<int> l = make_flat_set<int>({ 1, 2, 3 });
-            auto it = l.begin();
-            auto it2(it);
-            REQUIRE(it2 == it);
-            REQUIRE(*it2 == *it);
-            SECTION("And can be used to iterate") {
-                for (int i = 1; i <= 3; ++i) {
-                    REQUIRE(*it2 == i);
-                    ++it2;
-                }
-                REQUIRE(it2 == l.end());
-            }
-            SECTION("And so is copy assigned") {
-                it2 = it;
-                REQUIRE(it2 == it);
-                for (int i = 1; i <= 3; ++i) {
-                    REQUIRE(*it2 == i);
-                    ++it2;
-                }
-                REQUIRE(it2 == l.end());
-            }
-        }
-    }
-}
-
-TEST_CASE("Constant Iterators") {
-    SECTION("Empty flat_set's iterators should be equal.") {
-        flat_set<int> l;
-        REQUIRE(l.cbegin() == l.cend());
-    }
-    SECTION("Non empty flat_set") {
-        flat_set<int> l1 = make_flat_set<int>({ 1, 2, 3 });
-        SECTION("Moving through the flat_set") {
-            auto sit = l1.cbegin();
-            auto eit = l1.cend();
-            REQUIRE(sit != eit);
-            SECTION("Forward") {
-                ++sit;
-                REQUIRE(sit != eit);
-                ++sit;
-                REQUIRE(sit != eit);
-                ++sit;
-                REQUIRE(sit == eit);
-            }
-            SECTION("Backward") {
-                --eit;
-                REQUIRE(sit != eit);
-                --eit;
-                REQUIRE(sit != eit);
-                --eit;
-                REQUIRE(sit == eit);
-            }
-            SECTION("Forward - postincr") {
-                REQUIRE(sit++ != eit);
-                REQUIRE(sit++ != eit);
-                REQUIRE(sit++ != eit);
-                REQUIRE(sit == eit);
-            }
-            SECTION("Backward - postdecr") {
-                REQUIRE(sit != eit--);
-                REQUIRE(sit != eit--);
-                REQUIRE(sit != eit--);
-                REQUIRE(sit == eit);
-            }
-        }
-        SECTION("Dereferencing iterators") {
-            auto sit = l1.cbegin();
-            for (int i = 1; i <= 3; ++i) {
-                REQUIRE(*sit == i);
-                ++sit;
-            }
-            REQUIRE(sit == l1.cend());
-        }
-    }
-    SECTION("Constructors") {
-        SECTION("Default inited iterators should be equal") {
-            flat_set<int>::const_iterator it, it2;
-            REQUIRE(it == it2);
-        }
-        SECTION("Iterator's copy is equal") {
-            flat_set<int> l = make_flat_set<int>({ 1, 2, 3 });
-            auto it = l.cbegin();
-            auto it2(it);
-            REQUIRE(it2 == it);
-            REQUIRE(*it2 == *it);
-            SECTION("And can be used to iterate") {
-                for (int i = 1; i <= 3; ++i) {
-                    REQUIRE(*it2 == i);
-                    ++it2;
-                }
-                REQUIRE(it2 == l.cend());
-            }
-            SECTION("And so is copy assigned") {
-                it2 = it;
-                REQUIRE(it2 == it);
-                for (int i = 1; i <= 3; ++i) {
-                    REQUIRE(*it2 == i);
-                    ++it2;
-                }
-                REQUIRE(it2 == l.cend());
-            }
-        }
-    }
-}
-
-TEST_CASE("Explicit comparator") {
-    SECTION("Function object") {
-        flat_set<int, std::greater<int>> fs;
-        std::vector<int> elements{ 1,2,3,4,5 };
-        fs.insert(elements.begin(), elements.end());
-        REQUIRE(std::equal(fs.begin(), fs.end(), elements.rbegin(), elements.rend()));
-    }
-    SECTION("Function") {
-        flat_set<int, bool(*)(int, int)> fs([] (int a, int b) {return a > b; });
-        std::vector<int> elements{ 1,2,3,4,5 };
-        fs.insert(elements.begin(), elements.end());
-        REQUIRE(std::equal(fs.begin(), fs.end(), elements.rbegin(), elements.rend()));
-    }
-    SECTION("Swapping swaps comparators") {
-        auto my_lesser = [] (int a, int b) {return a < b; };
-        auto my_greater = [] (int a, int b) {return a > b; };
-        std::vector<int> e{ 0,1,2,3 };
-        flat_set<int, bool(*)(int, int)> l1(e.begin(), e.end(), my_lesser);
-        flat_set<int, bool(*)(int, int)> l2(e.begin(), e.end(), my_greater);
-        l1.swap(l2);
-        l1.insert(100);
-        REQUIRE(l1.find(100) == l1.begin());
-        l2.insert(-100);
-        REQUIRE(l2.find(-100) == l2.begin());
-    }
-    SECTION("Custom key") {
-        std::vector<MyKey> e{ MyKey(1), MyKey(2), MyKey(3), MyKey(4), MyKey(100) };
-
-        SECTION("Compare using same type") {
-            using flat_set_k_t = flat_set<MyKey, MyKeyComparator>;
-            flat_set_k_t fs(e.begin(), e.end());
-
-            auto off = MyKey::nconstructs();
-            REQUIRE(equals<MyKeyComparator>(*fs.find(MyKey{ 3 }), e[2]));
-            REQUIRE(MyKey::nconstructs() - off == 1); // implicit conversion from 3 to MyKey(3)
-
-            REQUIRE(fs.find(MyKey{ 42 }) == fs.end());
-        }
-    }
-}
-
-TEST_CASE("operator==, !=") {
-    SECTION("Empty flat_sets are equal") {
-        REQUIRE(flat_set<int>{} == flat_set<int>{});
-        REQUIRE(flat_set<int>{} == flat_set<int>{});
-    }
-    SECTION("empty and non empty flat_sets") {
-        flat_set<int> l1 = make_flat_set<int>({ 1, 2, 3 });
-        REQUIRE(l1 != flat_set<int>{});
-        REQUIRE(flat_set<int>{} != l1);
-    }
-    SECTION("Two non-equal non-empty flat_sets") {
-        flat_set<int> l1 = make_flat_set<int>({ 1, 2, 3 });
-        flat_set<int> l2 = make_flat_set<int>({ 4, 5, 6 });
-        REQUIRE(l1 != l2);
-    }
-    SECTION("Two equal non-empty flat_sets") {
-        flat_set<int> l1 = make_flat_set<int>({ 4, 5, 6});
-        flat_set<int> l2 = make_flat_set<int>({ 4, 5, 6 });
-        REQUIRE(l1 == l2);
-    }
-    SECTION("A flat_set is equal to itself") {
-        flat_set<int> l1 = make_flat_set<int>({12, 32, 43, 54, 765, 123, 43, 1, 1, 1});
-        REQUIRE(l1 == l1);
-    }
-}
-
-TEST_CASE("Relational operators (<, <=, >, >=)"){
-    SECTION("One empty flat_set is not smaller than another") {
-        REQUIRE_FALSE(flat_set<int>{} < flat_set<int>{});
-    }
-    SECTION("Empty flat_set should be smaller than non-empty flat_set") {
-        REQUIRE(flat_set<int>{} < make_flat_set<int>({ 1, 2, 3 }));
-    }
-    SECTION("lhs is a subset") {
-        auto l1 = make_flat_set<int>({1, 2, 3});
-        auto l2 = make_flat_set<int>({ 1, 2, 3, 4 });
-        REQUIRE(l1 < l2);
-    }
-    SECTION("rhs is a subset") {
-        auto l1 = make_flat_set<int>({ 1, 2, 3 });
-        auto l2 = make_flat_set<int>({ 1, 2 });
-        REQUIRE(l1 > l2);
-    }
-    SECTION("flat_sets are equal") {
-        auto l1 = make_flat_set<int>({ 3, 2, 1 });
-        flat_set<int> l2(l1);
-        REQUIRE(l1 <= l2);
-        REQUIRE(l1 >= l2);
-    }
-    SECTION("Just diff flat_sets") {
-        auto l1 = make_flat_set<int>({ 1, 3, 5 });
-        auto l2 = make_flat_set<int>({ 1, 4, 5 });
-        REQUIRE(l1 < l2);
-    }
-    SECTION("Just a mismatch 2") {
-        auto l1 = make_flat_set<int>({ 1, 2, 3, 4, 5, 6 });
-        auto l2 = make_flat_set<int>({ 1, 2, 3, 4, 5 });
-        REQUIRE(l1 > l2);
-    }
-    SECTION("Different types") {
-        SECTION("Same length") {
-            auto l1 = make_flat_set<std::string>({ "abc", "def", "ghi" });
-            auto l2 = make_flat_set<std::string>({ "abc", "def", "ghj" });
-            REQUIRE(l1 < l2);
-        }
-        SECTION("Shorter is later") {
-            auto l1 = make_flat_set<std::string>({ "qqq" });
-            auto l2 = make_flat_set<std::string>({ "a", "b", "c" });
-            REQUIRE(l2 < l1);
-        }
-    }
-}
-
-TEST_CASE("Copy operations") {
-    SECTION("Move insert moves") {
-        flat_set<tracker> fs;
-        tracker t(1);
-        auto start = tracker::cnt;
-        fs.insert(std::move(t));
-        auto t1 = tracker::cnt;
-        t1.move_constructors = start.move_constructors;
-        t1.move_assignments = start.move_assignments;
-        REQUIRE(start == t1);
-    }
-    SECTION("Value insert performs 1 copy") {
-        flat_set<tracker> fs;
-        tracker t(1);
-        auto start = tracker::cnt;
-        fs.insert(t);
-        auto t1 = tracker::cnt;
-        t1.move_constructors = start.move_constructors;
-        t1.move_assignments = start.move_assignments;
-        t1.copy_constructors -= 1;
-        REQUIRE(start == t1);
-    }
-    SECTION("Range constructor only performs n copies") {
-        std::vector<tracker> elems{ 1, 9, 2, 4, 3, 8 };
-        auto start = tracker::cnt;
-        flat_set<tracker> fs(elems.begin(), elems.end());
-        auto t1 = tracker::cnt;
-        t1.destructors -= t1.move_constructors - start.move_constructors;
-        t1.move_constructors = start.move_constructors;
-        t1.move_assignments = start.move_assignments;
-        t1.copy_constructors -= 6;
-        REQUIRE(start == t1);
-    }
-
-    SECTION("Copy constructor") {
-        SECTION("Make sure flat_sets are disconnected") {
-            auto l1 = make_flat_set<int>({ 1, 2, 3 });
-            flat_set<int> l2(l1);
-            SECTION("Simple copy") {
-                REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            }
-            SECTION("Add to old flat_set") {
-                l1.insert(4);
-                REQUIRE(set_equal(l1, { 1, 2, 3, 4 }));
-                REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            }
-            SECTION("Add to new flat_set") {
-                l2.insert(4);
-                REQUIRE(set_equal(l1, { 1, 2, 3 }));
-                REQUIRE(set_equal(l2, { 1, 2, 3, 4 }));
-            }
-            SECTION("Add to both flat_sets") {
-                l1.insert(4);
-                l2.insert(5);
-                REQUIRE(set_equal(l1, { 1, 2, 3, 4 }));
-                REQUIRE(set_equal(l2, { 1, 2, 3, 5 }));
-            }
-        }
-        SECTION("Copying an empty flat_set") {
-            flat_set<int> l1;
-            flat_set<int> l2(l1);
-            REQUIRE(reports_as_empty(l1));
-            REQUIRE(reports_as_empty(l2));
-        }
-    }
-    SECTION("Copy assignment") {
-        auto l1 = make_flat_set<int>({ 1, 2, 3 });
-        auto l2 = make_flat_set<int>({ 4, 5, 6, 7 });
-        SECTION("Simple assignment") {
-            l2 = l1;
-            REQUIRE(set_equal(l1, { 1, 2, 3 }));
-            REQUIRE(set_equal(l2, { 1, 2, 3 }));
-        }
-        SECTION("Self assignment") {
-            l2 = l2;
-            REQUIRE(!l2.empty());
-            REQUIRE(set_equal(l2, { 4, 5, 6, 7 }));
-        }
-        SECTION("Repeated assignments") {
-            l2 = l1;
-            REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            l1.insert(4);
-            l2 = l1;
-            REQUIRE(set_equal(l2, { 1, 2, 3, 4 }));
-            l1.insert(5);
-            l2 = l1;
-            REQUIRE(set_equal(l2, { 1, 2, 3, 4, 5 }));
-            l1.insert(6);
-            l2 = l1;
-            REQUIRE(set_equal(l2, { 1, 2, 3, 4, 5, 6 }));
-        }
-    }
-}
-
-TEST_CASE("Move operations") {
-    SECTION("Move constructor") {
-        SECTION("From empty flat_set") {
-            flat_set<int> l1;
-            flat_set<int> l2(std::move(l1));
-            REQUIRE(reports_as_empty(l2));
-        }
-        SECTION("From full flat_set") {
-            auto elems = std::vector<int>({ 1, 2, 3, 4, 5, 6, 7, 8 });
-            flat_set<int> l1(elems.begin(), elems.end());
-            flat_set<int> l2(std::move(l1));
-            REQUIRE(set_equal(l2, elems));
-        }
-    }
-    SECTION("Move assignment") {
-        SECTION("From empty flat_set") {
-            flat_set<int> l1;
-            SECTION("To empty flat_set") {
-                flat_set<int> l2;
-                l2 = std::move(l1);
-                REQUIRE(reports_as_empty(l2));
-            }
-            SECTION("To full flat_set") {
-                auto l2 = make_flat_set<int>({ 1, 2, 3, 4, 5, 6 });
-                l2 = std::move(l1);
-                REQUIRE(reports_as_empty(l2));
-            }
-        }
-        SECTION("From full flat_set") {
-            auto l1 = make_flat_set<int>({ 5, 4, 3, 2, 1 });
-            SECTION("to empty flat_set") {
-                flat_set<int> l2;
-                l2 = std::move(l1);
-                REQUIRE(set_equal(l2, { 5, 4, 3, 2, 1 }));
-            }
-            SECTION("To full flat_set") {
-                auto l2 = make_flat_set<int>({ 4, 2, 3 });
-                l2 = std::move(l1);
-                REQUIRE(set_equal(l2, { 5, 4, 3, 2, 1 }));
-            }
-        }
-        SECTION("Back and forth") {
-            auto l1 = make_flat_set<int>({ 44, 2, 4 });
-            auto l2 = make_flat_set<int>({ 1, 2, 3, 4, 5, 6 });
-            l1 = std::move(l2);
-            REQUIRE(set_equal(l1, { 1, 2, 3, 4, 5, 6 }));
-            l2 = std::move(l1);
-            REQUIRE(set_equal(l2, { 1, 2, 3, 4, 5, 6 }));
-
-            l2.clear();
-            SECTION("Sets can be used after being move assigned") {
-                l2.insert(7);
-                l2.erase(l2.begin());
-                l2.insert(0);
-                REQUIRE(set_equal(l2, { 0 }));
-            }
-        }
-    }
-}
-
-TEST_CASE("member swap") {
-    SECTION("Swapping empty flat_sets leaves both empty") {
-        flat_set<int> l1, l2;
-        l1.swap(l2);
-        REQUIRE(reports_as_empty(l1));
-        REQUIRE(reports_as_empty(l2));
-    }
-    SECTION("Swapping elements actually swaps them") {
-        auto l1 = make_flat_set<int>({ 1, 2, 3 });
-        SECTION("empty and full") {
-            flat_set<int> l2;
-            l1.swap(l2);
-            REQUIRE(reports_as_empty(l1));
-            REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            SECTION("Roundtrip") {
-                l1.swap(l2);
-                REQUIRE(set_equal(l1, { 1, 2, 3 }));
-                REQUIRE(reports_as_empty(l2));
-            }
-        }
-        SECTION("full and full") {
-            auto l2 = make_flat_set<int>({ 4, 5, 6, 7 });
-            l1.swap(l2);
-            REQUIRE(set_equal(l1, { 4, 5, 6, 7 }));
-            REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            SECTION("Roundtrip") {
-                l1.swap(l2);
-                REQUIRE(set_equal(l1, { 1, 2, 3 }));
-                REQUIRE(set_equal(l2, { 4, 5, 6, 7 }));
-            }
-        }
-    }
-}
-
-TEST_CASE("member swap - complexity", "[.long]") {
-    // Swap should take constant time regardless of flat_set size.
-    using namespace std::chrono_literals;
-    double last_time = 0;
-    for (int i = 1'000; i <= 1'500'000; i *= 4) {
-        auto lhs_elems = generate(i);
-        flat_set<int> lhs{ lhs_elems.begin(), lhs_elems.end() };
-        auto rhs_elems = generate(i);
-        flat_set<int> rhs{ rhs_elems.begin(), rhs_elems.end() };
-        auto start_time = std::chrono::high_resolution_clock::now();
-        lhs.swap(rhs);
-        auto end_time = std::chrono::high_resolution_clock::now();
-        // Add 0.5 ms to even out variability
-        auto time_diff = end_time - start_time + 500us;
-        auto total_time = static_cast<double>(time_diff.count());
-        lhs.swap(rhs);
-        REQUIRE(set_equal(lhs, lhs_elems));
-        if (last_time != 0) {
-            // The coefficient is a rough approximation.
-            // A linear time coefficient should blow out, constant time
-            // jitter should remain inside some reasonable coefficient
-            REQUIRE(total_time / last_time <= 1.25);
-        }
-        last_time = total_time;
-        std::cout << "member swap: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
-    }
-}
-
-TEST_CASE("swap overload") {
-    SECTION("Swapping empty flat_sets leaves both empty") {
-        flat_set<int> l1, l2;
-        swap(l1, l2);
-        REQUIRE(reports_as_empty(l1));
-        REQUIRE(reports_as_empty(l2));
-    }
-    SECTION("Swapping elements actually swaps them") {
-        auto l1 = make_flat_set<int>({ 1, 2, 3 });
-        SECTION("empty and full") {
-            flat_set<int> l2;
-            swap(l1, l2);
-            REQUIRE(reports_as_empty(l1));
-            REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            SECTION("Roundtrip") {
-                swap(l1, l2);
-                REQUIRE(set_equal(l1, { 1, 2, 3 }));
-                REQUIRE(reports_as_empty(l2));
-            }
-        }
-        SECTION("full and full") {
-            auto l2 = make_flat_set<int>({ 4, 5, 6, 7 });
-            swap(l1, l2);
-            REQUIRE(set_equal(l1, { 4, 5, 6, 7 }));
-            REQUIRE(set_equal(l2, { 1, 2, 3 }));
-            SECTION("Roundtrip") {
-                swap(l1, l2);
-                REQUIRE(set_equal(l1, { 1, 2, 3 }));
-                REQUIRE(set_equal(l2, { 4, 5, 6, 7 }));
-            }
-        }
-    }
-}
-
-TEST_CASE("swap overload - complexity", "[.long]") {
-    // Swap should take constant time regardless of flat_set size.
-    using namespace std::chrono_literals;
-    double last_time = 0;
-    for (int i = 1'000; i <= 1'500'000; i *= 4) {
-        auto lhs_elems = generate(i);
-        auto lhs = make_flat_set<int>(lhs_elems);
-        auto rhs_elems = generate(i);
-        auto rhs = make_flat_set<int>(rhs_elems);
-        auto start_time = std::chrono::high_resolution_clock::now();
-        swap(lhs, rhs);
-        auto end_time = std::chrono::high_resolution_clock::now();
-        // Add 0.5 ms to even out variability
-        auto time_diff = end_time - start_time + 500us;
-        auto total_time = static_cast<double>(time_diff.count());
-        swap(lhs, rhs);
-        REQUIRE(set_equal(lhs, lhs_elems));
-        if (last_time != 0) {
-            // The coefficient is a rough approximation.
-            // A linear time coefficient should blow out, constant time
-            // jitter should remain inside some reasonable coefficient
-            REQUIRE(total_time / last_time <= 1.25);
-        }
-        last_time = total_time;
-        std::cout << "swap overload: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
-    }
-}
-
-// End of basic functionality
-
-TEST_CASE("Reserve should not construct any elements") {
-    flat_set<tracker> set;
-    auto old = tracker::cnt;
-    set.reserve(100);
-    REQUIRE(old == tracker::cnt);
-}
-
-TEST_CASE("Proper reference handling") {
-    flat_set<tracker> set;
-    set.reserve(100);
-    SECTION("Insert as a copy") {
-        tracker t;
-        auto oldt = tracker::cnt;
-        set.insert(t);
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors == newt.copy_constructors - 1);
-    }
-    SECTION("Insert as a move") {
-        auto oldt = tracker::cnt;
-        set.insert(tracker{});
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.move_constructors == newt.move_constructors - 1);
-    }
-    SECTION("Range insert copies") {
-        std::vector<tracker> vec{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
-        auto oldt = tracker::cnt;
-        set.insert(begin(vec), end(vec));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors == newt.copy_constructors - 9);
-    }
-}
-
-TEST_CASE("Proper iterator tag handling") {
-    using input_iter = fake_input_iterator<std::vector<tracker>::iterator, false>;
-    const size_t num_elems = 1000;
-    std::vector<tracker> elems; elems.reserve(num_elems);
-    std::generate_n(std::back_inserter(elems), num_elems, [] () {
-        static int i = 0;
-        return i++;
-    });
-    SECTION("RandomAccessIterator range constructor") {
-        auto oldt = tracker::cnt;
-        flat_set<tracker> fs(begin(elems), end(elems));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
-        REQUIRE(fs == make_flat_set(elems));
-    }
-    SECTION("ForwardIterator range constructor") {
-        std::forward_list<tracker> slist(begin(elems), end(elems));
-        auto oldt = tracker::cnt;
-        flat_set<tracker> fs(begin(slist), end(slist));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
-        REQUIRE(fs == make_flat_set(elems));
-    }
-    SECTION("InputIterator range constructor") {
-        auto oldt = tracker::cnt;
-        flat_set<tracker> fs(input_iter(begin(elems)),
-                             input_iter(end(elems)));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors < newt.copy_constructors - num_elems);
-        REQUIRE(fs == make_flat_set(elems));
-    }
-    SECTION("RandomAccessIterator range insert") {
-        flat_set<tracker> fs;
-        auto oldt = tracker::cnt;
-        fs.insert(begin(elems), end(elems));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
-        REQUIRE(fs == make_flat_set(elems));
-    }
-    SECTION("ForwardIterator range insert") {
-        std::forward_list<tracker> slist(begin(elems), end(elems));
-        flat_set<tracker> fs;
-        auto oldt = tracker::cnt;
-        fs.insert(begin(slist), end(slist));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
-        REQUIRE(fs == make_flat_set(elems));
-    }
-    SECTION("InputIterator range insert") {
-        flat_set<tracker> fs;
-        auto oldt = tracker::cnt;
-        fs.insert(input_iter(begin(elems)),
-                  input_iter(end(elems)));
-        auto newt = tracker::cnt;
-        REQUIRE(oldt.copy_constructors < newt.copy_constructors - num_elems);
-        REQUIRE(fs == make_flat_set(elems));
-    }
-}
-
-TEST_CASE("Range constructor complexity", "[.long]") {
-    // We check the number of allocations in a different test
-    // So we only deal with time-complexity
-    // Good implementation should just copy the elements over and sort them
-    // leaving it with complexity of O(N log N)
-    using namespace std::chrono_literals;
-    double last_time = 0;
-    for (int i = 1'000'000; i <= 16'000'000; i *= 4) {
-        auto data = generate(i);
-        auto start_time = std::chrono::high_resolution_clock::now();
-        flat_set<int> fs(begin(data), end(data));
-        auto end_time = std::chrono::high_resolution_clock::now();
-        // Add 0.5 ms to even out variability
-        auto time_diff = end_time - start_time;
-        auto total_time = static_cast<double>(time_diff.count());
-        auto time_per_item = time_diff.count() / static_cast<double>(i);
-        REQUIRE(set_equal(fs, data));
-        if (last_time != 0) {
-            // The coefficient is a rough approximation.
-            // A linear time coefficient should blow out, constant time
-            // jitter should remain inside some reasonable coefficient
-            CHECK(time_per_item / last_time <= 1.55);
-        }
-        std::cout << "range constructor: i = " << i << " time per item = " << time_per_item << '\n';
-        last_time = time_per_item;
-    }
-}
+#include "flatset.hpp"
+#include "tests-helpers.hpp"
+#include "catch.hpp"
+
+#include <forward_list>
+#include <type_traits>
+#include <algorithm>
+#include <vector>
+#include <set>
+#include <iterator>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <type_traits>
+#include <cmath>
+#include <iostream>
+#include <functional>
+#include <numeric>
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+    template <typename T> struct is_flat_set : std::false_type {};
+    template <typename T> struct is_flat_set<flat_set<T>> : std::true_type {};
+
+    template <typename T, typename = is_flat_set<T>>
+    bool reports_as_empty(const T& s) {
+        return s.empty() && (s.size() == 0);
+    }
+    template <typename T, typename = is_flat_set<T>>
+    bool set_equal(const T &a, const std::set<typename T::value_type> &b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+    template <typename T, typename = is_flat_set<T>>
+    bool set_equal(const T &a, std::initializer_list<typename T::value_type> &&b) {
+        return set_equal(a, std::set<typename T::value_type>(std::move(b)));
+    }
+    template <typename T, typename = is_flat_set<T>>
+    bool set_equal(const T &a, const std::vector<typename T::value_type> &vb) {
+        std::set<typename T::value_type> b(vb.begin(), vb.end());
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+    template <typename T>
+    flat_set<T> make_flat_set(std::vector<T> const &v) {
+        return flat_set<T>(v.begin(), v.end());
+    }
+    class MyKey {
+        friend struct MyKeyComparator;
+        int i;
+        static unsigned s_nconstructs;
+        operator int() const {return i;}
+    public:
+        static unsigned nconstructs() {return s_nconstructs;}
+
+        explicit MyKey(int i = 0) : i(i) {s_nconstructs++;}
+        MyKey(const MyKey &o) : i(o.i) {s_nconstructs++;}
+        MyKey& operator=(const MyKey &o) {i = o.i; s_nconstructs++; return *this;}
+        MyKey(MyKey &&o) = default;
+        MyKey& operator=(MyKey &&o) = default;
+    };
+    struct MyKeyComparator {
+        bool operator()(MyKey const &a, MyKey const &b) const {
+            return a.i < b.i;
+        }
+    };
+    template <typename C, typename T, typename U>
+    bool equals(T &&a, U &&b, C &&cmp = C()) {
+        return !cmp(a, b) && !cmp(b, a);
+    }
+
+    unsigned MyKey::s_nconstructs = 0;
+
+
+    std::mt19937 mt{ std::random_device{}() };
+    std::uniform_int_distribution<> dist(INT_MIN, INT_MAX);
+
+    std::vector<int> generate(size_t N) {
+        std::vector<int> res;
+        res.reserve(N);
+
+        for (size_t i=0; i<N; ++i) {
+            res.push_back(dist(mt));
+        }
+        return res;
+    }
+    static int randint() {
+        return dist(mt);
+    }
+}
+
+TEST_CASE("Compilation tests") {
+    auto l = make_flat_set<int>({ 1, 2 });
+    const auto& const_l = l;
+    REQUIRE(!const_l.empty());
+    REQUIRE(const_l.size() == 2);
+    flat_set<int>::iterator it = l.begin();
+    flat_set<int>::const_iterator cit = it;
+    static_cast<void>(cit); // silence unused variable warning
+}
+
+TEST_CASE("compile-time tests") {
+    using namespace std;
+
+    // nice idea, but ...
+    static_assert(!is_convertible<flat_set<int>*, std::set<int>*>::value, "do not derive drom std::set :)");
+
+    using my_set = flat_set<int>;
+    my_set fs;
+    my_set::iterator i = fs.begin();
+    my_set::const_iterator ci = const_cast<const my_set&>(fs).begin();
+
+    static_assert(is_convertible<my_set::iterator, my_set::const_iterator>::value, "An iterator has to be convertible to const iterator");
+    // either const_iterator is not convertible to iterator or even iterator is const, so that it does not matter
+    static_assert(!is_convertible<my_set::const_iterator, my_set::iterator>::value || is_const<remove_reference_t<iterator_traits<my_set::iterator>::reference>>::value, "");
+    // iterators are random access; this also prevents using std::set
+    static_assert(is_same<iterator_traits<my_set::iterator>::iterator_category, random_access_iterator_tag>::value, "");
+}
+
+TEST_CASE("Anticheat tests") {
+    // Don't implement flat_set via set ... not even by composition
+    SECTION("The underlying storage is contiguous") {
+        auto fs = make_flat_set<int>({1,2,3,4,5});
+        int *expected = &*fs.begin();
+
+        for (auto i = fs.begin(), e = fs.end(); i != e; ++i) {
+            REQUIRE(expected == &*i);
+            expected++;
+        }
+    }
+}
+
+// Because the basic impl is super easy, all non-optimized funcitonality is rolled into one
+TEST_CASE("Basic functionality -- constructors, {pop, push}_{front, back}, size, empty") {
+    SECTION("Range constructor") {
+        SECTION("Empty range -> empty set") {
+            std::vector<int> v;
+            REQUIRE(reports_as_empty(flat_set<int>(v.begin(), v.end())));
+        }
+        SECTION("Singular range -> singular set") {
+            auto fs2 = make_flat_set<int>({1});
+            REQUIRE(!fs2.empty());
+            REQUIRE(fs2.size() == 1);
+            REQUIRE(*fs2.begin() == 1);
+        }
+        SECTION("Multiple elements in order") {
+            std::vector<int> elems({ 1, 2, 3, 56, 78, 86 });
+            flat_set<int> s3(elems.begin(), elems.end());
+            REQUIRE(!s3.empty());
+            REQUIRE(s3.size() == 6);
+            REQUIRE(set_equal(s3, elems));
+        }
+        SECTION("Multiple elements out of order") {
+            std::vector<int> elems({ 1, 86, 2, 56, 78, 3 });
+            flat_set<int> s3(elems.begin(), elems.end());
+            REQUIRE(!s3.empty());
+            REQUIRE(s3.size() == 6);
+            REQUIRE(set_equal(s3, {1,2,3,56,78,86}));
+        }
+        SECTION("Multiple elements with duplicates") {
+            std::vector<int> elems({ 1, 2, 3, 56, 2, 78, 78, 86, 1 });
+            flat_set<int> s3(elems.begin(), elems.end());
+            REQUIRE(!s3.empty());
+            REQUIRE(s3.size() == 6);
+            REQUIRE(set_equal(s3, {1,2,3,56,78,86}));
+        }
+    }
+    SECTION("Series of inserts in order") {
+        flat_set<int> fs;
+        for (int i : {-9, 0, 2000, 543210123}) {
+            fs.insert(i);
+            REQUIRE(*(--fs.end()) == i);
+        }
+        REQUIRE(fs.size() == 4);
+        REQUIRE(set_equal(fs, { -9, 0, 2000, 543210123 }));
+    }
+    SECTION("Series of inserts out of order") {
+        flat_set<int> fs;
+        std::vector<int> elems = {5, 0, 1, 2, 9};
+        for (int i : elems) {
+            fs.insert(i);
+            REQUIRE(std::is_sorted(fs.begin(), fs.end()));
+        }
+        REQUIRE(fs.size() == 5);
+        REQUIRE(set_equal(fs, { 0, 1, 2, 5, 9 }));
+    }
+    SECTION("Range insert") {
+        flat_set<int> fs;
+        std::vector<int> elems = {5, 0, 0, 1, 9, 2};
+        fs.insert(elems.begin(), elems.end());
+        REQUIRE(fs.size() == 5);
+        REQUIRE(set_equal(fs, { 0, 1, 2, 5, 9 }));
+    }
+    SECTION("insert return value") {
+        flat_set<int> fs;
+        std::pair<flat_set<int>::iterator, bool> ret;
+        ret = fs.insert(1);
+        REQUIRE(ret.second == true);
+        REQUIRE(ret.first == fs.begin());
+        ret = fs.insert(2);
+        REQUIRE(ret.second == true);
+        REQUIRE(ret.first == ++fs.begin());
+        ret = fs.insert(1);
+        REQUIRE(ret.second == false);
+        REQUIRE(ret.first == fs.begin());
+    }
+    SECTION("erase") {
+        flat_set<int> fs;
+        std::vector<int> elems = {0,1,2,5,9};
+        flat_set<int>::iterator i;
+        flat_set<int>::size_type ret;
+        fs.insert(elems.begin(), elems.end());
+        REQUIRE(set_equal(fs, {0,1,2,5,9}));
+
+        i = fs.erase(fs.begin());
+        REQUIRE(i == fs.begin());
+        REQUIRE(set_equal(fs, {1,2,5,9}));
+
+        i = fs.find(5);
+        i = fs.erase(i);
+        REQUIRE(*i == 9);
+        REQUIRE(set_equal(fs, {1,2,9}));
+
+        ret = fs.erase(123);
+        REQUIRE(ret == 0);
+        ret = fs.erase(2);
+        REQUIRE(ret == 1);
+        REQUIRE(set_equal(fs, { 1, 9 }));
+
+        i = fs.erase(fs.begin(), fs.end());
+        REQUIRE(reports_as_empty(fs));
+        REQUIRE(i == fs.end());
+    }
+    SECTION("find") {
+        auto fs2 = make_flat_set<int>({5, 0, 0, 1, 9, 2});
+        REQUIRE(fs2.find(0) == fs2.begin()+0);
+        REQUIRE(fs2.find(9) == fs2.begin()+4);
+        REQUIRE(fs2.find(42) == fs2.end()); // greater than max
+        REQUIRE(fs2.find(-1) == fs2.end()); // lesser than min
+        REQUIRE(fs2.find(3) == fs2.end());  // in range, but not present
+    }
+    SECTION("find in empty set") {
+        flat_set<int> fs2;
+        REQUIRE(fs2.find(42) == fs2.end()); // should not crash on *0
+    }
+    SECTION("lower_bound") {
+        auto fs2 = make_flat_set<int>({5, 0, 0, 1, 9, 2});
+        REQUIRE(fs2.lower_bound(0) == fs2.begin());
+        REQUIRE(fs2.lower_bound(9) == fs2.begin()+4);
+        REQUIRE(fs2.lower_bound(42) == fs2.end()); // greater than max
+        REQUIRE(fs2.lower_bound(-1) == fs2.begin()); // lesser than min
+        REQUIRE(fs2.lower_bound(3) == fs2.begin()+3);  // in range, but not present
+    }
+    SECTION("upper_bound") {
+        auto fs2 = make_flat_set<int>({ 5, 0, 0, 1, 9, 2 });
+        REQUIRE(fs2.upper_bound(0) == fs2.begin() + 1);
+        REQUIRE(fs2.upper_bound(9) == fs2.end());
+        REQUIRE(fs2.lower_bound(42) == fs2.end()); // greater than max
+        REQUIRE(fs2.upper_bound(-1) == fs2.begin()); // lesser than min
+        REQUIRE(fs2.upper_bound(3) == fs2.begin() + 3);  // in range, but not present
+    }
+    SECTION("size, clear, capacity, reserve") {
+        flat_set<int> fs2;
+        REQUIRE(fs2.size() == 0);
+
+        fs2.insert(42);
+        REQUIRE(fs2.size() == 1);
+        REQUIRE(fs2.capacity() >= fs2.size());
+
+        fs2.clear();
+        REQUIRE(fs2.size() == 0);
+
+        fs2.reserve(1024);
+        REQUIRE(fs2.capacity() >= 1024);
+    }
+}
+
+TEST_CASE("Iterators") {
+    SECTION("Empty flat_set's iterators should be equal.") {
+        flat_set<int> l;
+        REQUIRE(l.begin() == l.end());
+    }
+    SECTION("Non empty flat_set") {
+        auto l1 = make_flat_set<int>({ 1, 2, 3 });
+        SECTION("Moving through the flat_set") {
+            auto sit = l1.begin();
+            auto eit = l1.end();
+            REQUIRE(sit != eit);
+            SECTION("Forward") {
+                ++sit;
+                REQUIRE(sit != eit);
+                ++sit;
+                REQUIRE(sit != eit);
+                ++sit;
+                REQUIRE(sit == eit);
+            }
+            SECTION("Backward") {
+                --eit;
+                REQUIRE(sit != eit);
+                --eit;
+                REQUIRE(sit != eit);
+                --eit;
+                REQUIRE(sit == eit);
+            }
+            SECTION("Forward - postincr") {
+                REQUIRE(sit++ != eit);
+                REQUIRE(sit++ != eit);
+                REQUIRE(sit++ != eit);
+                REQUIRE(sit   == eit);
+            }
+            SECTION("Backward - postdecr") {
+                REQUIRE(sit != eit--);
+                REQUIRE(sit != eit--);
+                REQUIRE(sit != eit--);
+                REQUIRE(sit == eit);
+            }
+        }
+        SECTION("Dereferencing iterators") {
+            auto sit = l1.begin();
+            for (int i = 1; i <= 3; ++i) {
+                REQUIRE(*sit == i);
+                ++sit;
+            }
+            REQUIRE(sit == l1.end());
+        }
+    }
+    SECTION("Constructors") {
+        SECTION("Default inited iterators should be equal") {
+            flat_set<int>::iterator it, it2;
+            REQUIRE(it == it2);
+        }
+        SECTION("Iterator's copy is equal") {
+            flat_set<int> l = make_flat_set<int>({ 1, 2, 3 });
+            auto it = l.begin();
+            auto it2(it);
+            REQUIRE(it2 == it);
+            REQUIRE(*it2 == *it);
+            SECTION("And can be used to iterate") {
+                for (int i = 1; i <= 3; ++i) {
+                    REQUIRE(*it2 == i);
+                    ++it2;
+                }
+                REQUIRE(it2 == l.end());
+            }
+            SECTION("And so is copy assigned") {
+                it2 = it;
+                REQUIRE(it2 == it);
+                for (int i = 1; i <= 3; ++i) {
+                    REQUIRE(*it2 == i);
+                    ++it2;
+                }
+                REQUIRE(it2 == l.end());
+            }
+        }
+    }
+}
+
+TEST_CASE("Constant Iterators") {
+    SECTION("Empty flat_set's iterators should be equal.") {
+        flat_set<int> l;
+        REQUIRE(l.cbegin() == l.cend());
+    }
+    SECTION("Non empty flat_set") {
+        flat_set<int> l1 = make_flat_set<int>({ 1, 2, 3 });
+        SECTION("Moving through the flat_set") {
+            auto sit = l1.cbegin();
+            auto eit = l1.cend();
+            REQUIRE(sit != eit);
+            SECTION("Forward") {
+                ++sit;
+                REQUIRE(sit != eit);
+                ++sit;
+                REQUIRE(sit != eit);
+                ++sit;
+                REQUIRE(sit == eit);
+            }
+            SECTION("Backward") {
+                --eit;
+                REQUIRE(sit != eit);
+                --eit;
+                REQUIRE(sit != eit);
+                --eit;
+                REQUIRE(sit == eit);
+            }
+            SECTION("Forward - postincr") {
+                REQUIRE(sit++ != eit);
+                REQUIRE(sit++ != eit);
+                REQUIRE(sit++ != eit);
+                REQUIRE(sit == eit);
+            }
+            SECTION("Backward - postdecr") {
+                REQUIRE(sit != eit--);
+                REQUIRE(sit != eit--);
+                REQUIRE(sit != eit--);
+                REQUIRE(sit == eit);
+            }
+        }
+        SECTION("Dereferencing iterators") {
+            auto sit = l1.cbegin();
+            for (int i = 1; i <= 3; ++i) {
+                REQUIRE(*sit == i);
+                ++sit;
+            }
+            REQUIRE(sit == l1.cend());
+        }
+    }
+    SECTION("Constructors") {
+        SECTION("Default inited iterators should be equal") {
+            flat_set<int>::const_iterator it, it2;
+            REQUIRE(it == it2);
+        }
+        SECTION("Iterator's copy is equal") {
+            flat_set<int> l = make_flat_set<int>({ 1, 2, 3 });
+            auto it = l.cbegin();
+            auto it2(it);
+            REQUIRE(it2 == it);
+            REQUIRE(*it2 == *it);
+            SECTION("And can be used to iterate") {
+                for (int i = 1; i <= 3; ++i) {
+                    REQUIRE(*it2 == i);
+                    ++it2;
+                }
+                REQUIRE(it2 == l.cend());
+            }
+            SECTION("And so is copy assigned") {
+                it2 = it;
+                REQUIRE(it2 == it);
+                for (int i = 1; i <= 3; ++i) {
+                    REQUIRE(*it2 == i);
+                    ++it2;
+                }
+                REQUIRE(it2 == l.cend());
+            }
+        }
+    }
+}
+
+TEST_CASE("Explicit comparator") {
+    SECTION("Function object") {
+        flat_set<int, std::greater<int>> fs;
+        std::vector<int> elements{ 1,2,3,4,5 };
+        fs.insert(elements.begin(), elements.end());
+        REQUIRE(std::equal(fs.begin(), fs.end(), elements.rbegin(), elements.rend()));
+    }
+    SECTION("Function") {
+        flat_set<int, bool(*)(int, int)> fs([] (int a, int b) {return a > b; });
+        std::vector<int> elements{ 1,2,3,4,5 };
+        fs.insert(elements.begin(), elements.end());
+        REQUIRE(std::equal(fs.begin(), fs.end(), elements.rbegin(), elements.rend()));
+    }
+    SECTION("Swapping swaps comparators") {
+        auto my_lesser = [] (int a, int b) {return a < b; };
+        auto my_greater = [] (int a, int b) {return a > b; };
+        std::vector<int> e{ 0,1,2,3 };
+        flat_set<int, bool(*)(int, int)> l1(e.begin(), e.end(), my_lesser);
+        flat_set<int, bool(*)(int, int)> l2(e.begin(), e.end(), my_greater);
+        l1.swap(l2);
+        l1.insert(100);
+        REQUIRE(l1.find(100) == l1.begin());
+        l2.insert(-100);
+        REQUIRE(l2.find(-100) == l2.begin());
+    }
+    SECTION("Copying copies comparators") {
+        auto my_lesser = [] (int a, int b) {return a < b; };
+        auto my_greater = [] (int a, int b) {return a > b; };
+        std::vector<int> e{ 0,1,2,3 };
+        flat_set<int, bool(*)(int, int)> l1(e.begin(), e.end(), my_greater);
+        flat_set<int, bool(*)(int, int)> l2(e.begin(), e.end(), my_lesser);
+        flat_set<int, bool(*)(int, int)> l3(l1);
+        l3.insert(100);
+        REQUIRE(l3.find(100) == l3.begin());
+        l2 = l1;
+        REQUIRE(std::equal(l2.begin(), l2.end(), e.rbegin(), e.rend()));
+        l2.insert(100);
+        REQUIRE(l2.find(100) == l2.begin());
+        REQUIRE(l2.find(0) == l2.end() - 1);
+    }
+    SECTION("Custom key") {
+        std::vector<MyKey> e{ MyKey(1), MyKey(2), MyKey(3), MyKey(4), MyKey(100) };
+
+        SECTION("Compare using same type") {
+            using flat_set_k_t = flat_set<MyKey, MyKeyComparator>;
+            flat_set_k_t fs(e.begin(), e.end());
+
+            auto off = MyKey::nconstructs();
+            REQUIRE(equals<MyKeyComparator>(*fs.find(MyKey{ 3 }), e[2]));
+            REQUIRE(MyKey::nconstructs() - off == 1); // implicit conversion from 3 to MyKey(3)
+
+            REQUIRE(fs.find(MyKey{ 42 }) == fs.end());
+        }
+    }
+}
+
+TEST_CASE("operator==, !=") {
+    SECTION("Empty flat_sets are equal") {
+        REQUIRE(flat_set<int>{} == flat_set<int>{});
+        REQUIRE(flat_set<int>{} == flat_set<int>{});
+    }
+    SECTION("empty and non empty flat_sets") {
+        flat_set<int> l1 = make_flat_set<int>({ 1, 2, 3 });
+        REQUIRE(l1 != flat_set<int>{});
+        REQUIRE(flat_set<int>{} != l1);
+    }
+    SECTION("Two non-equal non-empty flat_sets") {
+        flat_set<int> l1 = make_flat_set<int>({ 1, 2, 3 });
+        flat_set<int> l2 = make_flat_set<int>({ 4, 5, 6 });
+        REQUIRE(l1 != l2);
+    }
+    SECTION("Two equal non-empty flat_sets") {
+        flat_set<int> l1 = make_flat_set<int>({ 4, 5, 6});
+        flat_set<int> l2 = make_flat_set<int>({ 4, 5, 6 });
+        REQUIRE(l1 == l2);
+    }
+    SECTION("A flat_set is equal to itself") {
+        flat_set<int> l1 = make_flat_set<int>({12, 32, 43, 54, 765, 123, 43, 1, 1, 1});
+        REQUIRE(l1 == l1);
+    }
+}
+
+TEST_CASE("Relational operators (<, <=, >, >=)"){
+    SECTION("One empty flat_set is not smaller than another") {
+        REQUIRE_FALSE(flat_set<int>{} < flat_set<int>{});
+    }
+    SECTION("Empty flat_set should be smaller than non-empty flat_set") {
+        REQUIRE(flat_set<int>{} < make_flat_set<int>({ 1, 2, 3 }));
+    }
+    SECTION("lhs is a subset") {
+        auto l1 = make_flat_set<int>({1, 2, 3});
+        auto l2 = make_flat_set<int>({ 1, 2, 3, 4 });
+        REQUIRE(l1 < l2);
+    }
+    SECTION("rhs is a subset") {
+        auto l1 = make_flat_set<int>({ 1, 2, 3 });
+        auto l2 = make_flat_set<int>({ 1, 2 });
+        REQUIRE(l1 > l2);
+    }
+    SECTION("flat_sets are equal") {
+        auto l1 = make_flat_set<int>({ 3, 2, 1 });
+        flat_set<int> l2(l1);
+        REQUIRE(l1 <= l2);
+        REQUIRE(l1 >= l2);
+    }
+    SECTION("Just diff flat_sets") {
+        auto l1 = make_flat_set<int>({ 1, 3, 5 });
+        auto l2 = make_flat_set<int>({ 1, 4, 5 });
+        REQUIRE(l1 < l2);
+    }
+    SECTION("Just a mismatch 2") {
+        auto l1 = make_flat_set<int>({ 1, 2, 3, 4, 5, 6 });
+        auto l2 = make_flat_set<int>({ 1, 2, 3, 4, 5 });
+        REQUIRE(l1 > l2);
+    }
+    SECTION("Different types") {
+        SECTION("Same length") {
+            auto l1 = make_flat_set<std::string>({ "abc", "def", "ghi" });
+            auto l2 = make_flat_set<std::string>({ "abc", "def", "ghj" });
+            REQUIRE(l1 < l2);
+        }
+        SECTION("Shorter is later") {
+            auto l1 = make_flat_set<std::string>({ "qqq" });
+            auto l2 = make_flat_set<std::string>({ "a", "b", "c" });
+            REQUIRE(l2 < l1);
+        }
+    }
+}
+
+TEST_CASE("Copy operations") {
+    SECTION("Move insert moves") {
+        flat_set<tracker> fs;
+        tracker t(1);
+        auto start = tracker::cnt;
+        fs.insert(std::move(t));
+        auto t1 = tracker::cnt;
+        t1.move_constructors = start.move_constructors;
+        t1.move_assignments = start.move_assignments;
+        REQUIRE(start == t1);
+    }
+    SECTION("Value insert performs 1 copy") {
+        flat_set<tracker> fs;
+        tracker t(1);
+        auto start = tracker::cnt;
+        fs.insert(t);
+        auto t1 = tracker::cnt;
+        t1.move_constructors = start.move_constructors;
+        t1.move_assignments = start.move_assignments;
+        t1.copy_constructors -= 1;
+        REQUIRE(start == t1);
+    }
+    SECTION("Range constructor only performs n copies") {
+        std::vector<tracker> elems{ 1, 9, 2, 4, 3, 8 };
+        auto start = tracker::cnt;
+        flat_set<tracker> fs(elems.begin(), elems.end());
+        auto t1 = tracker::cnt;
+        t1.destructors -= t1.move_constructors - start.move_constructors;
+        t1.move_constructors = start.move_constructors;
+        t1.move_assignments = start.move_assignments;
+        t1.copy_constructors -= 6;
+        REQUIRE(start == t1);
+    }
+
+    SECTION("Copy constructor") {
+        SECTION("Make sure flat_sets are disconnected") {
+            auto l1 = make_flat_set<int>({ 1, 2, 3 });
+            flat_set<int> l2(l1);
+            SECTION("Simple copy") {
+                REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            }
+            SECTION("Add to old flat_set") {
+                l1.insert(4);
+                REQUIRE(set_equal(l1, { 1, 2, 3, 4 }));
+                REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            }
+            SECTION("Add to new flat_set") {
+                l2.insert(4);
+                REQUIRE(set_equal(l1, { 1, 2, 3 }));
+                REQUIRE(set_equal(l2, { 1, 2, 3, 4 }));
+            }
+            SECTION("Add to both flat_sets") {
+                l1.insert(4);
+                l2.insert(5);
+                REQUIRE(set_equal(l1, { 1, 2, 3, 4 }));
+                REQUIRE(set_equal(l2, { 1, 2, 3, 5 }));
+            }
+        }
+        SECTION("Copying an empty flat_set") {
+            flat_set<int> l1;
+            flat_set<int> l2(l1);
+            REQUIRE(reports_as_empty(l1));
+            REQUIRE(reports_as_empty(l2));
+        }
+    }
+    SECTION("Copy assignment") {
+        auto l1 = make_flat_set<int>({ 1, 2, 3 });
+        auto l2 = make_flat_set<int>({ 4, 5, 6, 7 });
+        SECTION("Simple assignment") {
+            l2 = l1;
+            REQUIRE(set_equal(l1, { 1, 2, 3 }));
+            REQUIRE(set_equal(l2, { 1, 2, 3 }));
+        }
+        SECTION("Self assignment") {
+            l2 = l2;
+            REQUIRE(!l2.empty());
+            REQUIRE(set_equal(l2, { 4, 5, 6, 7 }));
+        }
+        SECTION("Repeated assignments") {
+            l2 = l1;
+            REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            l1.insert(4);
+            l2 = l1;
+            REQUIRE(set_equal(l2, { 1, 2, 3, 4 }));
+            l1.insert(5);
+            l2 = l1;
+            REQUIRE(set_equal(l2, { 1, 2, 3, 4, 5 }));
+            l1.insert(6);
+            l2 = l1;
+            REQUIRE(set_equal(l2, { 1, 2, 3, 4, 5, 6 }));
+        }
+    }
+}
+
+namespace {
+    // Moves without throwing, but its move assignment is not noexcept
+    struct throwing_assignment_less {
+        throwing_assignment_less() = default;
+        throwing_assignment_less(throwing_assignment_less&&) noexcept = default;
+        throwing_assignment_less& operator=(throwing_assignment_less&&) noexcept(false) {
+            return *this;
+        }
+
+        bool operator()(int a, int b) const {
+            return a < b;
+        }
+    };
+}
+
+TEST_CASE("Move operations") {
+    SECTION("Move constructor") {
+        SECTION("From empty flat_set") {
+            flat_set<int> l1;
+            flat_set<int> l2(std::move(l1));
+            REQUIRE(reports_as_empty(l2));
+        }
+        SECTION("From full flat_set") {
+            auto elems = std::vector<int>({ 1, 2, 3, 4, 5, 6, 7, 8 });
+            flat_set<int> l1(elems.begin(), elems.end());
+            flat_set<int> l2(std::move(l1));
+            REQUIRE(set_equal(l2, elems));
+        }
+        SECTION("Steals the storage") {
+            std::vector<tracker> elems{ 3, 1, 2 };
+            flat_set<tracker> l1(elems.begin(), elems.end());
+            l1.build_eytzinger();
+            const tracker* storage = &*l1.begin();
+
+            auto oldt = tracker::cnt;
+            auto old_allocations = allocation_count();
+            flat_set<tracker> l2(std::move(l1));
+            REQUIRE(allocation_count() == old_allocations);
+            REQUIRE(tracker::cnt - oldt == counter{});
+
+            REQUIRE(&*l2.begin() == storage);
+            REQUIRE(l2.has_eytzinger());
+            REQUIRE(reports_as_empty(l1));
+            REQUIRE_FALSE(l1.has_eytzinger());
+        }
+        SECTION("Is noexcept") {
+            static_assert(std::is_nothrow_move_constructible<flat_set<int>>::value, "");
+            static_assert(std::is_nothrow_move_assignable<flat_set<int>>::value, "");
+            static_assert(noexcept(std::declval<flat_set<int>&>().swap(std::declval<flat_set<int>&>())), "");
+
+            // Swapping comparators also move assigns them
+            using assign_may_throw = flat_set<int, throwing_assignment_less>;
+            static_assert(std::is_nothrow_move_constructible<assign_may_throw>::value, "");
+            static_assert(!std::is_nothrow_move_assignable<assign_may_throw>::value, "");
+            static_assert(!noexcept(std::declval<assign_may_throw&>().swap(std::declval<assign_may_throw&>())), "");
+        }
+    }
+    SECTION("Move assignment") {
+        SECTION("From empty flat_set") {
+            flat_set<int> l1;
+            SECTION("To empty flat_set") {
+                flat_set<int> l2;
+                l2 = std::move(l1);
+                REQUIRE(reports_as_empty(l2));
+            }
+            SECTION("To full flat_set") {
+                auto l2 = make_flat_set<int>({ 1, 2, 3, 4, 5, 6 });
+                l2 = std::move(l1);
+                REQUIRE(reports_as_empty(l2));
+            }
+        }
+        SECTION("From full flat_set") {
+            auto l1 = make_flat_set<int>({ 5, 4, 3, 2, 1 });
+            SECTION("to empty flat_set") {
+                flat_set<int> l2;
+                l2 = std::move(l1);
+                REQUIRE(set_equal(l2, { 5, 4, 3, 2, 1 }));
+            }
+            SECTION("To full flat_set") {
+                auto l2 = make_flat_set<int>({ 4, 2, 3 });
+                l2 = std::move(l1);
+                REQUIRE(set_equal(l2, { 5, 4, 3, 2, 1 }));
+            }
+            SECTION("Without touching elements") {
+                std::vector<tracker> elems{ 3, 1, 2 };
+                flat_set<tracker> l2(elems.begin(), elems.end());
+                flat_set<tracker> l3(elems.begin(), elems.begin() + 1);
+
+                auto oldt = tracker::cnt;
+                auto old_allocations = allocation_count();
+                l3 = std::move(l2);
+                REQUIRE(allocation_count() == old_allocations);
+                // Only the previous element of l3 is destroyed
+                REQUIRE(tracker::cnt - oldt == counter(0, 0, 0, 0, 0, 1, 0));
+                REQUIRE(l3.size() == 3);
+                REQUIRE(reports_as_empty(l2));
+            }
+        }
+        SECTION("Back and forth") {
+            auto l1 = make_flat_set<int>({ 44, 2, 4 });
+            auto l2 = make_flat_set<int>({ 1, 2, 3, 4, 5, 6 });
+            l1 = std::move(l2);
+            REQUIRE(set_equal(l1, { 1, 2, 3, 4, 5, 6 }));
+            l2 = std::move(l1);
+            REQUIRE(set_equal(l2, { 1, 2, 3, 4, 5, 6 }));
+
+            l2.clear();
+            SECTION("Sets can be used after being move assigned") {
+                l2.insert(7);
+                l2.erase(l2.begin());
+                l2.insert(0);
+                REQUIRE(set_equal(l2, { 0 }));
+            }
+        }
+    }
+}
+
+TEST_CASE("member swap") {
+    SECTION("Swapping empty flat_sets leaves both empty") {
+        flat_set<int> l1, l2;
+        l1.swap(l2);
+        REQUIRE(reports_as_empty(l1));
+        REQUIRE(reports_as_empty(l2));
+    }
+    SECTION("Swapping elements actually swaps them") {
+        auto l1 = make_flat_set<int>({ 1, 2, 3 });
+        SECTION("empty and full") {
+            flat_set<int> l2;
+            l1.swap(l2);
+            REQUIRE(reports_as_empty(l1));
+            REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            SECTION("Roundtrip") {
+                l1.swap(l2);
+                REQUIRE(set_equal(l1, { 1, 2, 3 }));
+                REQUIRE(reports_as_empty(l2));
+            }
+        }
+        SECTION("full and full") {
+            auto l2 = make_flat_set<int>({ 4, 5, 6, 7 });
+            l1.swap(l2);
+            REQUIRE(set_equal(l1, { 4, 5, 6, 7 }));
+            REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            SECTION("Roundtrip") {
+                l1.swap(l2);
+                REQUIRE(set_equal(l1, { 1, 2, 3 }));
+                REQUIRE(set_equal(l2, { 4, 5, 6, 7 }));
+            }
+        }
+    }
+}
+
+TEST_CASE("member swap - complexity", "[.long]") {
+    // Swap should take constant time regardless of flat_set size.
+    using namespace std::chrono_literals;
+    double last_time = 0;
+    for (int i = 1'000; i <= 1'500'000; i *= 4) {
+        auto lhs_elems = generate(i);
+        flat_set<int> lhs{ lhs_elems.begin(), lhs_elems.end() };
+        auto rhs_elems = generate(i);
+        flat_set<int> rhs{ rhs_elems.begin(), rhs_elems.end() };
+        auto start_time = std::chrono::high_resolution_clock::now();
+        lhs.swap(rhs);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        // Add 0.5 ms to even out variability
+        auto time_diff = end_time - start_time + 500us;
+        auto total_time = static_cast<double>(time_diff.count());
+        lhs.swap(rhs);
+        REQUIRE(set_equal(lhs, lhs_elems));
+        if (last_time != 0) {
+            // The coefficient is a rough approximation.
+            // A linear time coefficient should blow out, constant time
+            // jitter should remain inside some reasonable coefficient
+            REQUIRE(total_time / last_time <= 1.25);
+        }
+        last_time = total_time;
+        std::cout << "member swap: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
+    }
+}
+
+TEST_CASE("swap overload") {
+    SECTION("Swapping empty flat_sets leaves both empty") {
+        flat_set<int> l1, l2;
+        swap(l1, l2);
+        REQUIRE(reports_as_empty(l1));
+        REQUIRE(reports_as_empty(l2));
+    }
+    SECTION("Swapping elements actually swaps them") {
+        auto l1 = make_flat_set<int>({ 1, 2, 3 });
+        SECTION("empty and full") {
+            flat_set<int> l2;
+            swap(l1, l2);
+            REQUIRE(reports_as_empty(l1));
+            REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            SECTION("Roundtrip") {
+                swap(l1, l2);
+                REQUIRE(set_equal(l1, { 1, 2, 3 }));
+                REQUIRE(reports_as_empty(l2));
+            }
+        }
+        SECTION("full and full") {
+            auto l2 = make_flat_set<int>({ 4, 5, 6, 7 });
+            swap(l1, l2);
+            REQUIRE(set_equal(l1, { 4, 5, 6, 7 }));
+            REQUIRE(set_equal(l2, { 1, 2, 3 }));
+            SECTION("Roundtrip") {
+                swap(l1, l2);
+                REQUIRE(set_equal(l1, { 1, 2, 3 }));
+                REQUIRE(set_equal(l2, { 4, 5, 6, 7 }));
+            }
+        }
+    }
+}
+
+TEST_CASE("swap overload - complexity", "[.long]") {
+    // Swap should take constant time regardless of flat_set size.
+    using namespace std::chrono_literals;
+    double last_time = 0;
+    for (int i = 1'000; i <= 1'500'000; i *= 4) {
+        auto lhs_elems = generate(i);
+        auto lhs = make_flat_set<int>(lhs_elems);
+        auto rhs_elems = generate(i);
+        auto rhs = make_flat_set<int>(rhs_elems);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        swap(lhs, rhs);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        // Add 0.5 ms to even out variability
+        auto time_diff = end_time - start_time + 500us;
+        auto total_time = static_cast<double>(time_diff.count());
+        swap(lhs, rhs);
+        REQUIRE(set_equal(lhs, lhs_elems));
+        if (last_time != 0) {
+            // The coefficient is a rough approximation.
+            // A linear time coefficient should blow out, constant time
+            // jitter should remain inside some reasonable coefficient
+            REQUIRE(total_time / last_time <= 1.25);
+        }
+        last_time = total_time;
+        std::cout << "swap overload: i = " << i << " total time = " << (time_diff - 500us).count() << '\n';
+    }
+}
+
+// End of basic functionality
+
+TEST_CASE("Reserve should not construct any elements") {
+    flat_set<tracker> set;
+    auto old = tracker::cnt;
+    set.reserve(100);
+    REQUIRE(old == tracker::cnt);
+}
+
+TEST_CASE("Proper reference handling") {
+    flat_set<tracker> set;
+    set.reserve(100);
+    SECTION("Insert as a copy") {
+        tracker t;
+        auto oldt = tracker::cnt;
+        set.insert(t);
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors == newt.copy_constructors - 1);
+    }
+    SECTION("Insert as a move") {
+        auto oldt = tracker::cnt;
+        set.insert(tracker{});
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.move_constructors == newt.move_constructors - 1);
+    }
+    SECTION("Range insert copies") {
+        std::vector<tracker> vec{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        auto oldt = tracker::cnt;
+        set.insert(begin(vec), end(vec));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors == newt.copy_constructors - 9);
+    }
+}
+
+TEST_CASE("Proper iterator tag handling") {
+    using input_iter = fake_input_iterator<std::vector<tracker>::iterator, false>;
+    const size_t num_elems = 1000;
+    std::vector<tracker> elems; elems.reserve(num_elems);
+    std::generate_n(std::back_inserter(elems), num_elems, [] () {
+        static int i = 0;
+        return i++;
+    });
+    SECTION("RandomAccessIterator range constructor") {
+        auto oldt = tracker::cnt;
+        flat_set<tracker> fs(begin(elems), end(elems));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
+        REQUIRE(fs == make_flat_set(elems));
+    }
+    SECTION("ForwardIterator range constructor") {
+        std::forward_list<tracker> slist(begin(elems), end(elems));
+        auto oldt = tracker::cnt;
+        flat_set<tracker> fs(begin(slist), end(slist));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
+        REQUIRE(fs == make_flat_set(elems));
+    }
+    SECTION("InputIterator range constructor") {
+        auto oldt = tracker::cnt;
+        flat_set<tracker> fs(input_iter(begin(elems)),
+                             input_iter(end(elems)));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors < newt.copy_constructors - num_elems);
+        REQUIRE(fs == make_flat_set(elems));
+    }
+    SECTION("RandomAccessIterator range insert") {
+        flat_set<tracker> fs;
+        auto oldt = tracker::cnt;
+        fs.insert(begin(elems), end(elems));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
+        REQUIRE(fs == make_flat_set(elems));
+    }
+    SECTION("ForwardIterator range insert") {
+        std::forward_list<tracker> slist(begin(elems), end(elems));
+        flat_set<tracker> fs;
+        auto oldt = tracker::cnt;
+        fs.insert(begin(slist), end(slist));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors == newt.copy_constructors - num_elems);
+        REQUIRE(fs == make_flat_set(elems));
+    }
+    SECTION("InputIterator range insert") {
+        flat_set<tracker> fs;
+        auto oldt = tracker::cnt;
+        fs.insert(input_iter(begin(elems)),
+                  input_iter(end(elems)));
+        auto newt = tracker::cnt;
+        REQUIRE(oldt.copy_constructors < newt.copy_constructors - num_elems);
+        REQUIRE(fs == make_flat_set(elems));
+    }
+}
+
+TEST_CASE("Range constructor complexity", "[.long]") {
+    // We check the number of allocations in a different test
+    // So we only deal with time-complexity
+    // Good implementation should just copy the elements over and sort them
+    // leaving it with complexity of O(N log N)
+    using namespace std::chrono_literals;
+    double last_time = 0;
+    for (int i = 1'000'000; i <= 16'000'000; i *= 4) {
+        auto data = generate(i);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        flat_set<int> fs(begin(data), end(data));
+        auto end_time = std::chrono::high_resolution_clock::now();
+        // Add 0.5 ms to even out variability
+        auto time_diff = end_time - start_time;
+        auto total_time = static_cast<double>(time_diff.count());
+        auto time_per_item = time_diff.count() / static_cast<double>(i);
+        REQUIRE(set_equal(fs, data));
+        if (last_time != 0) {
+            // The coefficient is a rough approximation.
+            // A linear time coefficient should blow out, constant time
+            // jitter should remain inside some reasonable coefficient
+            CHECK(time_per_item / last_time <= 1.55);
+        }
+        std::cout << "range constructor: i = " << i << " time per item = " << time_per_item << '\n';
+        last_time = time_per_item;
+    }
+}
+
+TEST_CASE("Lookup agrees with std::set") {
+    // Sizes around powers of two exercise both the last step of the binary
+    // search and the incomplete last level of the Eytzinger tree
+    std::uniform_int_distribution<> small(-100, 100);
+    for (size_t n : { 0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 100 }) {
+        std::vector<int> data;
+        for (size_t i = 0; i < n; ++i) {
+            data.push_back(small(mt));
+        }
+        std::set<int> expected(data.begin(), data.end());
+        auto fs = make_flat_set(data);
+
+        auto check_all = [&] {
+            for (int v = -102; v <= 102; ++v) {
+                auto found = expected.find(v);
+                auto lower = expected.lower_bound(v);
+                auto upper = expected.upper_bound(v);
+                REQUIRE(fs.find(v) - fs.begin() == std::distance(expected.begin(), found));
+                REQUIRE(fs.lower_bound(v) - fs.begin() == std::distance(expected.begin(), lower));
+                REQUIRE(fs.upper_bound(v) - fs.begin() == std::distance(expected.begin(), upper));
+
+                const auto& cfs = fs;
+                REQUIRE(cfs.find(v) - cfs.begin() == std::distance(expected.begin(), found));
+            }
+        };
+
+        check_all();
+        fs.build_eytzinger();
+        REQUIRE(fs.has_eytzinger() == !expected.empty());
+        check_all();
+    }
+}
+
+TEST_CASE("Eytzinger layout") {
+    auto fs = make_flat_set<int>({ 5, 0, 1, 9, 2, 7, 3 });
+    fs.build_eytzinger();
+    REQUIRE(fs.has_eytzinger());
+
+    SECTION("Modifications drop it and lookups stay correct") {
+        fs.insert(4);
+        REQUIRE_FALSE(fs.has_eytzinger());
+        REQUIRE(fs.find(4) == fs.begin() + 4);
+
+        fs.build_eytzinger();
+        fs.erase(0);
+        REQUIRE_FALSE(fs.has_eytzinger());
+        REQUIRE(fs.find(0) == fs.end());
+        REQUIRE(fs.find(1) == fs.begin());
+
+        fs.build_eytzinger();
+        fs.clear();
+        REQUIRE_FALSE(fs.has_eytzinger());
+        REQUIRE(fs.find(1) == fs.end());
+    }
+    SECTION("Inserting a present element keeps it") {
+        REQUIRE_FALSE(fs.insert(5).second);
+        REQUIRE(fs.has_eytzinger());
+    }
+    SECTION("Copies and swaps carry it along") {
+        auto copy = fs;
+        REQUIRE(copy.has_eytzinger());
+        REQUIRE(copy.find(9) == copy.begin() + 6);
+
+        flat_set<int> other;
+        other.swap(fs);
+        REQUIRE(other.has_eytzinger());
+        REQUIRE_FALSE(fs.has_eytzinger());
+        REQUIRE(other.find(7) == other.begin() + 5);
+    }
+    SECTION("Explicit comparator") {
+        std::vector<int> e{ 0, 1, 2, 3, 4, 5 };
+        flat_set<int, std::greater<int>> rev(e.begin(), e.end(), std::greater<int>());
+        rev.build_eytzinger();
+        REQUIRE(rev.find(5) == rev.begin());
+        REQUIRE(rev.find(0) == rev.begin() + 5);
+        REQUIRE(rev.lower_bound(-1) == rev.end());
+        REQUIRE(rev.upper_bound(6) == rev.begin());
+    }
+}
+
+TEST_CASE("Range insert merges with present elements") {
+    auto fs = make_flat_set<int>({ 1, 5, 9 });
+
+    SECTION("Present elements are kept") {
+        std::vector<int> batch{ 12, 7, 5, 0, 7 };
+        fs.insert(batch.begin(), batch.end());
+        REQUIRE(set_equal(fs, { 0, 1, 5, 7, 9, 12 }));
+    }
+    SECTION("Empty range changes nothing") {
+        std::vector<int> batch;
+        fs.insert(batch.begin(), batch.end());
+        REQUIRE(set_equal(fs, { 1, 5, 9 }));
+    }
+    SECTION("Only duplicates") {
+        std::vector<int> batch{ 9, 1, 1 };
+        fs.insert(batch.begin(), batch.end());
+        REQUIRE(set_equal(fs, { 1, 5, 9 }));
+    }
+    SECTION("Merges in place when capacity allows") {
+        fs.reserve(100);
+        const int* storage = &*fs.begin();
+        std::vector<int> batch{ 10, -3, 4, 6, 2 };
+        fs.insert(batch.begin(), batch.end());
+        REQUIRE(set_equal(fs, { -3, 1, 2, 4, 5, 6, 9, 10 }));
+        REQUIRE(&*fs.begin() == storage);
+    }
+    SECTION("Agrees with std::set") {
+        std::uniform_int_distribution<> small(-1000, 1000);
+        std::uniform_int_distribution<> batch_size(0, 300);
+        std::set<int> expected(fs.begin(), fs.end());
+        for (int round = 0; round < 50; ++round) {
+            if (round % 3 == 0) {
+                fs.reserve(fs.size() + 300);
+            }
+            std::vector<int> batch;
+            for (int i = batch_size(mt); i > 0; --i) {
+                batch.push_back(small(mt));
+            }
+            fs.insert(batch.begin(), batch.end());
+            expected.insert(batch.begin(), batch.end());
+            REQUIRE(set_equal(fs, expected));
+        }
+    }
+    SECTION("Copies every element of the range once") {
+        flat_set<tracker> trackers;
+        std::vector<tracker> first{ 2, 4, 6, 8 };
+        trackers.insert(first.begin(), first.end());
+        std::vector<tracker> second{ 9, 7, 5, 3, 1 };
+        auto oldt = tracker::cnt;
+        trackers.insert(second.begin(), second.end());
+        auto newt = tracker::cnt;
+        REQUIRE(newt.copy_constructors - oldt.copy_constructors == 5);
+        REQUIRE(newt.copy_assignments == oldt.copy_assignments);
+        REQUIRE(trackers.size() == 9);
+    }
+}
+
+TEST_CASE("Sorted unique input") {
+    std::vector<tracker> sorted{ 1, 2, 3, 5, 8, 13 };
+
+    SECTION("Constructor copies without sorting") {
+        auto oldt = tracker::cnt;
+        flat_set<tracker> fs(sorted_unique, sorted.begin(), sorted.end());
+        auto newt = tracker::cnt;
+        REQUIRE(newt.copy_constructors - oldt.copy_constructors == 6);
+        REQUIRE(newt.move_constructors == oldt.move_constructors);
+        REQUIRE(newt.move_assignments == oldt.move_assignments);
+        REQUIRE(fs == make_flat_set(sorted));
+    }
+    SECTION("Constructor with comparator") {
+        std::vector<int> descending{ 9, 4, 2, 0 };
+        flat_set<int, std::greater<int>> fs(sorted_unique, descending.begin(), descending.end(), std::greater<int>());
+        REQUIRE(std::equal(fs.begin(), fs.end(), descending.begin(), descending.end()));
+        REQUIRE(fs.find(2) == fs.begin() + 2);
+    }
+    SECTION("Insert merges with present elements") {
+        auto fs = make_flat_set<int>({ 0, 4, 10 });
+        std::vector<int> batch{ 1, 4, 7, 12 };
+        fs.insert(sorted_unique, batch.begin(), batch.end());
+        REQUIRE(set_equal(fs, { 0, 1, 4, 7, 10, 12 }));
+    }
+    SECTION("Input iterators") {
+        using input_iter = fake_input_iterator<std::vector<tracker>::iterator, false>;
+        flat_set<tracker> fs(sorted_unique, input_iter(sorted.begin()), input_iter(sorted.end()));
+        REQUIRE(fs == make_flat_set(sorted));
+    }
+}
+
+TEST_CASE("Adopting and extracting storage") {
+    SECTION("adopt sorts and deduplicates") {
+        std::vector<int> v{ 5, 1, 5, 3, 1 };
+        flat_set<int> fs;
+        fs.adopt(std::move(v));
+        REQUIRE(set_equal(fs, { 1, 3, 5 }));
+    }
+    SECTION("Storage is handed over, not copied") {
+        std::vector<tracker> v{ 1, 2, 3, 4 };
+        const tracker* storage = v.data();
+        flat_set<tracker> fs;
+        fs.insert(7);
+        fs.build_eytzinger();
+
+        auto oldt = tracker::cnt;
+        fs.adopt(sorted_unique, std::move(v));
+        REQUIRE(&*fs.begin() == storage);
+        REQUIRE(fs.size() == 4);
+        REQUIRE_FALSE(fs.has_eytzinger());
+        REQUIRE(fs.find(7) == fs.end());
+
+        auto extracted = fs.extract();
+        auto newt = tracker::cnt;
+        REQUIRE(extracted.data() == storage);
+        REQUIRE(reports_as_empty(fs));
+        REQUIRE(newt.copy_constructors == oldt.copy_constructors);
+        REQUIRE(newt.move_constructors == oldt.move_constructors);
+
+        fs.insert(2);
+        REQUIRE(set_equal(fs, std::vector<tracker>{ 2 }));
+    }
+}
+
+namespace {
+    // Throws from every comparison while armed
+    struct throwing_less {
+        const bool* armed = nullptr;
+
+        bool operator()(int a, int b) const {
+            if (*armed) {
+                throw std::runtime_error("comparison failed");
+            }
+            return a < b;
+        }
+    };
+}
+
+TEST_CASE("Batch inserter") {
+    auto fs = make_flat_set<int>({ 2, 4, 6 });
+
+    SECTION("Elements appear on commit") {
+        auto batch = fs.batch_insert();
+        batch.insert(5);
+        batch.insert(1);
+        batch.insert(4);
+        batch.insert(5);
+        REQUIRE(batch.pending_size() == 4);
+        REQUIRE(set_equal(fs, { 2, 4, 6 }));
+
+        batch.commit();
+        REQUIRE(batch.pending_size() == 0);
+        REQUIRE(set_equal(fs, { 1, 2, 4, 5, 6 }));
+
+        batch.insert(0);
+        batch.commit();
+        REQUIRE(set_equal(fs, { 0, 1, 2, 4, 5, 6 }));
+    }
+    SECTION("Destructor commits pending elements") {
+        {
+            auto batch = fs.batch_insert();
+            for (int i = 10; i > 0; --i) {
+                batch.insert(i);
+            }
+        }
+        REQUIRE(set_equal(fs, { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }));
+    }
+    SECTION("Destructor drops pending elements while an exception unwinds") {
+        try {
+            auto batch = fs.batch_insert();
+            batch.insert(5);
+            throw std::runtime_error("load failed");
+        } catch (std::runtime_error const&) {
+        }
+        REQUIRE(set_equal(fs, { 2, 4, 6 }));
+    }
+    SECTION("Moved handle keeps the elements") {
+        auto batch = fs.batch_insert();
+        batch.insert(3);
+        auto moved = std::move(batch);
+        REQUIRE(batch.pending_size() == 0);
+        batch.commit();
+        REQUIRE(set_equal(fs, { 2, 4, 6 }));
+        moved.insert(7);
+        moved.commit();
+        REQUIRE(set_equal(fs, { 2, 3, 4, 6, 7 }));
+    }
+    SECTION("Exception from the comparator reaches commit") {
+        bool armed = false;
+        throwing_less less;
+        less.armed = &armed;
+        flat_set<int, throwing_less> guarded(less);
+        guarded.insert(2);
+        guarded.insert(4);
+        {
+            auto batch = guarded.batch_insert();
+            batch.insert(3);
+            batch.insert(1);
+            armed = true;
+            REQUIRE_THROWS_AS(batch.commit(), std::runtime_error);
+            // The destructor commits again, that throws too and must not escape
+        }
+        armed = false;
+        REQUIRE(guarded.size() == 2);
+        REQUIRE(*guarded.begin() == 2);
+    }
+    SECTION("Moves elements inserted as rvalues") {
+        flat_set<tracker> trackers;
+        auto oldt = tracker::cnt;
+        {
+            auto batch = trackers.batch_insert();
+            batch.reserve(3);
+            batch.insert(tracker(3));
+            batch.insert(tracker(1));
+            batch.insert(tracker(2));
+            batch.commit();
+        }
+        auto newt = tracker::cnt;
+        REQUIRE(newt.copy_constructors == oldt.copy_constructors);
+        REQUIRE(newt.copy_assignments == oldt.copy_assignments);
+        REQUIRE(trackers.size() == 3);
+        REQUIRE(trackers.begin()->value == 1);
+    }
+    SECTION("Agrees with std::set") {
+        std::uniform_int_distribution<> small(-5000, 5000);
+        std::set<int> expected(fs.begin(), fs.end());
+        auto batch = fs.batch_insert();
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 0; i < 1000; ++i) {
+                int v = small(mt);
+                batch.insert(v);
+                expected.insert(v);
+            }
+            batch.commit();
+            REQUIRE(set_equal(fs, expected));
+        }
+    }
+}
+
+TEST_CASE("Bulk erase") {
+    auto fs = make_flat_set<int>({ 1, 3, 4, 6, 8, 9, 12 });
+
+    SECTION("erase by key uses the comparator") {
+        std::vector<int> e{ 1, 2, 3, 4 };
+        flat_set<int, std::greater<int>> rev(e.begin(), e.end(), std::greater<int>());
+        REQUIRE(rev.erase(3) == 1);
+        REQUIRE(rev.erase(3) == 0);
+        REQUIRE(std::equal(rev.begin(), rev.end(), std::vector<int>{ 4, 2, 1 }.begin()));
+    }
+    SECTION("erase by key range") {
+        REQUIRE(fs.erase(4, 9) == 3);
+        REQUIRE(set_equal(fs, { 1, 3, 9, 12 }));
+        REQUIRE(fs.erase(5, 6) == 0);
+        REQUIRE(fs.erase(12, 1) == 0);
+        REQUIRE(fs.erase(0, 100) == 4);
+        REQUIRE(reports_as_empty(fs));
+    }
+    SECTION("erase_if") {
+        fs.build_eytzinger();
+        REQUIRE(fs.erase_if([] (int v) { return v % 2 == 0; }) == 4);
+        REQUIRE(set_equal(fs, { 1, 3, 9 }));
+        REQUIRE_FALSE(fs.has_eytzinger());
+        REQUIRE(fs.find(3) == fs.begin() + 1);
+
+        REQUIRE(erase_if(fs, [] (int v) { return v > 100; }) == 0);
+        REQUIRE(erase_if(fs, [] (int v) { return v < 5; }) == 2);
+        REQUIRE(set_equal(fs, { 9 }));
+    }
+    SECTION("erase_sorted") {
+        std::vector<int> keys{ 0, 3, 3, 5, 8, 9, 13 };
+        REQUIRE(fs.erase_sorted(keys.begin(), keys.end()) == 3);
+        REQUIRE(set_equal(fs, { 1, 4, 6, 12 }));
+
+        std::vector<int> none{ 2, 5, 7 };
+        REQUIRE(fs.erase_sorted(none.begin(), none.end()) == 0);
+        REQUIRE(fs.erase_sorted(keys.end(), keys.end()) == 0);
+        REQUIRE(set_equal(fs, { 1, 4, 6, 12 }));
+    }
+    SECTION("erase_sorted agrees with std::set") {
+        std::uniform_int_distribution<> small(0, 2000);
+        std::vector<int> data;
+        for (int i = 0; i < 1000; ++i) {
+            data.push_back(small(mt));
+        }
+        for (int round = 0; round < 20; ++round) {
+            auto all = make_flat_set(data);
+            std::set<int> expected(data.begin(), data.end());
+            std::vector<int> keys;
+            for (int i = round * 10; i > 0; --i) {
+                keys.push_back(small(mt));
+            }
+            std::sort(keys.begin(), keys.end());
+
+            size_t erased = 0;
+            for (int key : keys) {
+                erased += expected.erase(key);
+            }
+            REQUIRE(all.erase_sorted(keys.begin(), keys.end()) == erased);
+            REQUIRE(set_equal(all, expected));
+        }
+    }
+}
+
+TEST_CASE("Set algebra") {
+    SECTION("Small sets") {
+        auto a = make_flat_set<int>({ 1, 2, 3, 5, 8 });
+        auto b = make_flat_set<int>({ 2, 4, 8, 16 });
+        REQUIRE(set_equal(a | b, { 1, 2, 3, 4, 5, 8, 16 }));
+        REQUIRE(set_equal(a & b, { 2, 8 }));
+        REQUIRE(set_equal(a - b, { 1, 3, 5 }));
+        REQUIRE(set_equal(b - a, { 4, 16 }));
+        REQUIRE(set_equal(a ^ b, { 1, 3, 4, 5, 16 }));
+        REQUIRE(set_union(a, b) == (a | b));
+        REQUIRE(set_intersection(a, b) == (a & b));
+        REQUIRE(set_difference(a, b) == (a - b));
+        REQUIRE(set_symmetric_difference(a, b) == (a ^ b));
+
+        flat_set<int> empty;
+        REQUIRE((a | empty) == a);
+        REQUIRE(reports_as_empty(a & empty));
+        REQUIRE((a - empty) == a);
+        REQUIRE(reports_as_empty(empty - a));
+        REQUIRE((empty ^ a) == a);
+    }
+    SECTION("Agrees with std algorithms for any size ratio") {
+        std::uniform_int_distribution<> values(0, 100000);
+        for (size_t small_size : { 0, 1, 10, 100, 1000, 5000 }) {
+            std::vector<int> small_data, big_data;
+            for (size_t i = 0; i < small_size; ++i) {
+                small_data.push_back(values(mt));
+            }
+            for (size_t i = 0; i < 5000; ++i) {
+                big_data.push_back(values(mt));
+            }
+            // Shared elements, so that intersections are not empty
+            big_data.insert(big_data.end(), small_data.begin(), small_data.begin() + small_size / 2);
+
+            auto small = make_flat_set(small_data);
+            auto big = make_flat_set(big_data);
+            for (int swapped = 0; swapped < 2; ++swapped) {
+                auto& a = swapped ? big : small;
+                auto& b = swapped ? small : big;
+                std::vector<int> expected;
+
+                std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                REQUIRE(set_equal(a | b, expected));
+                expected.clear();
+                std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                REQUIRE(set_equal(a & b, expected));
+                expected.clear();
+                std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                REQUIRE(set_equal(a - b, expected));
+                expected.clear();
+                std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                REQUIRE(set_equal(a ^ b, expected));
+            }
+        }
+    }
+    SECTION("Equivalent elements come from the left operand") {
+        for (size_t big_size : { 3, 1000 }) {
+            std::vector<ordered> left_data, right_data;
+            for (size_t i = 0; i < big_size; ++i) {
+                left_data.emplace_back(static_cast<int>(i) * 2, 0);
+            }
+            right_data.emplace_back(2, 1);
+            right_data.emplace_back(3, 1);
+            auto left = make_flat_set(left_data);
+            auto right = make_flat_set(right_data);
+
+            auto u = left | right;
+            REQUIRE(u.find(ordered(2, 9))->order == 0);
+            REQUIRE(u.find(ordered(3, 9))->order == 1);
+            REQUIRE((right | left).find(ordered(2, 9))->order == 1);
+            REQUIRE((left & right).begin()->order == 0);
+            REQUIRE((right & left).begin()->order == 1);
+        }
+    }
+    SECTION("Results keep the comparator") {
+        std::vector<int> e1{ 1, 2, 3 }, e2{ 3, 4 };
+        flat_set<int, std::greater<int>> a(e1.begin(), e1.end(), std::greater<int>());
+        flat_set<int, std::greater<int>> b(e2.begin(), e2.end(), std::greater<int>());
+        auto u = a | b;
+        REQUIRE(std::equal(u.begin(), u.end(), std::vector<int>{ 4, 3, 2, 1 }.begin()));
+        REQUIRE(u.find(2) == u.begin() + 2);
+    }
+}
+
+namespace {
+    template <typename T>
+    std::vector<T> sorted_unique_values(size_t count, T range, T shift) {
+        std::uniform_int_distribution<unsigned long long> values(0, static_cast<unsigned long long>(range));
+        std::vector<T> v;
+        for (size_t i = 0; i < count; ++i) {
+            v.push_back(static_cast<T>(values(mt)) - shift);
+        }
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        return v;
+    }
+
+    // The SSE versions each handle one size of integers
+    template <typename T, typename Check>
+    void check_sse(Check check, std::integral_constant<size_t, 4>) {
+#ifdef FLATSET_SIMD_SSE2
+        check(flatset_simd::intersect_sse2<T>);
+#endif
+        (void)check;
+    }
+
+    template <typename T, typename Check>
+    void check_sse(Check check, std::integral_constant<size_t, 8>) {
+#ifdef FLATSET_SIMD_SSE4
+        check(flatset_simd::intersect_sse4<T>);
+#endif
+        (void)check;
+    }
+
+    // Compares every intersection kernel this target has with the plain merge
+    template <typename T>
+    void check_intersection_kernels(T shift) {
+        for (size_t n : { 0, 1, 3, 8, 9, 31, 100, 1000 }) {
+            for (size_t m : { 0, 5, 16, 17, 200, 3000 }) {
+                auto a = sorted_unique_values<T>(n, 4000, shift);
+                auto b = sorted_unique_values<T>(m, 4000, shift);
+                std::vector<T> expected;
+                std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+                std::vector<T> out(std::min(a.size(), b.size()) + 1);
+                auto check = [&] (size_t (*kernel)(const T*, size_t, const T*, size_t, T*)) {
+                    size_t count = kernel(a.data(), a.size(), b.data(), b.size(), out.data());
+                    REQUIRE(std::vector<T>(out.begin(), out.begin() + count) == expected);
+                    REQUIRE(kernel(a.data(), a.size(), b.data(), b.size(), nullptr) == expected.size());
+                };
+
+                check(flatset_simd::intersect_scalar<T>);
+                check(flatset_simd::intersect<T>);
+#ifdef FLATSET_SIMD_AVX2
+                check(flatset_simd::intersect_avx2<T>);
+#endif
+                check_sse<T>(check, std::integral_constant<size_t, sizeof(T)>());
+            }
+        }
+    }
+}
+
+TEST_CASE("Integer intersection") {
+    SECTION("Kernels agree with the plain merge") {
+        check_intersection_kernels<std::uint32_t>(0);
+        check_intersection_kernels<std::int32_t>(2000);
+        check_intersection_kernels<std::uint64_t>(0);
+        check_intersection_kernels<std::int64_t>(2000);
+    }
+    SECTION("Only integers ordered by std::less are accelerated") {
+        REQUIRE_FALSE(flatset_simd::accelerated<std::uint32_t, std::greater<std::uint32_t>>::value);
+        REQUIRE_FALSE(flatset_simd::accelerated<double, std::less<double>>::value);
+        REQUIRE_FALSE(flatset_simd::accelerated<std::uint16_t, std::less<std::uint16_t>>::value);
+    }
+    SECTION("flat_set intersection and its size") {
+        auto a = sorted_unique_values<std::uint64_t>(5000, 20000, 0);
+        auto b = sorted_unique_values<std::uint64_t>(3000, 20000, 0);
+        std::vector<std::uint64_t> expected;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+        flat_set<std::uint64_t> fa(sorted_unique, a.begin(), a.end());
+        flat_set<std::uint64_t> fb(sorted_unique, b.begin(), b.end());
+        REQUIRE(set_equal(fa & fb, expected));
+        REQUIRE(fa.intersection_size(fb) == expected.size());
+
+        flat_set<std::uint64_t> few(sorted_unique, b.begin(), b.begin() + 10);
+        REQUIRE(fa.intersection_size(few) == (fa & few).size());
+
+        flat_set<std::uint64_t, std::greater<std::uint64_t>> ra(a.begin(), a.end(), std::greater<std::uint64_t>());
+        flat_set<std::uint64_t, std::greater<std::uint64_t>> rb(b.begin(), b.end(), std::greater<std::uint64_t>());
+        REQUIRE(ra.intersection_size(rb) == expected.size());
+        REQUIRE((ra & rb).size() == expected.size());
+    }
+}
+
+namespace {
+    // Fails the comparison after it was called given number of times, from any thread
+    struct failing_less {
+        std::atomic<int>* calls_left = nullptr;
+
+        bool operator()(int a, int b) const {
+            if (--*calls_left < 0) {
+                throw std::runtime_error("comparison failed");
+            }
+            return a < b;
+        }
+    };
+}
+
+TEST_CASE("Parallel construction") {
+    std::mt19937 gen(17);
+    SECTION("Agrees with the serial constructor") {
+        for (size_t size : { 0, 1, 1000, 100'000, 300'001 }) {
+            // The narrow range has many duplicates, the wide one almost none
+            for (int range : { 10, 1000, INT_MAX }) {
+                std::uniform_int_distribution<int> dist(0, range);
+                std::vector<int> data(size);
+                std::generate(data.begin(), data.end(), [&] { return dist(gen); });
+                flat_set<int> expected(data.begin(), data.end());
+                for (unsigned threads : { 0, 1, 2, 3, 4, 8 }) {
+                    flat_set<int> fs(parallel_t(threads), data.begin(), data.end());
+                    REQUIRE(std::equal(fs.begin(), fs.end(), expected.begin(), expected.end()));
+                }
+            }
+        }
+    }
+    SECTION("Groups of equivalent elements span several chunks") {
+        std::vector<int> data(200'000, 7);
+        data.resize(400'000, 3);
+        std::shuffle(data.begin(), data.end(), gen);
+        flat_set<int> fs(parallel_t(5), data.begin(), data.end());
+        REQUIRE(set_equal(fs, { 3, 7 }));
+
+        std::vector<int> same(500'000, 42);
+        flat_set<int> single(parallel, same.begin(), same.end());
+        REQUIRE(set_equal(single, { 42 }));
+    }
+    SECTION("Custom comparator and input iterators") {
+        auto data = generate(200'000);
+        std::vector<int> copy = data;
+        using iterator = fake_input_iterator<std::vector<int>::iterator>;
+        flat_set<int, std::greater<int>> fs(parallel_t(4), iterator(copy.begin()), iterator(copy.end()), std::greater<int>());
+        flat_set<int, std::greater<int>> expected(data.begin(), data.end(), std::greater<int>());
+        REQUIRE(std::equal(fs.begin(), fs.end(), expected.begin(), expected.end()));
+    }
+    SECTION("Adopting a vector") {
+        auto data = generate(150'000);
+        flat_set<int> expected(data.begin(), data.end());
+        flat_set<int> fs;
+        fs.adopt(parallel_t(3), std::move(data));
+        REQUIRE(std::equal(fs.begin(), fs.end(), expected.begin(), expected.end()));
+    }
+    SECTION("Exception from a comparison reaches the caller") {
+        auto data = generate(200'000);
+        std::atomic<int> calls_left(100'000);
+        failing_less less;
+        less.calls_left = &calls_left;
+        REQUIRE_THROWS_AS((flat_set<int, failing_less>(parallel_t(4), data.begin(), data.end(), less)), std::runtime_error);
+    }
+}
+
+namespace {
+    // Compares trackers with each other and with plain numbers, counting the calls
+    struct counting_less {
+        using is_transparent = void;
+        size_t* calls = nullptr;
+
+        bool operator()(const tracker& a, const tracker& b) const { ++*calls; return a.value < b.value; }
+        bool operator()(const tracker& a, double b) const { ++*calls; return a.value < b; }
+        bool operator()(double a, const tracker& b) const { ++*calls; return a < b.value; }
+    };
+}
+
+TEST_CASE("Hinted insert and emplace") {
+    SECTION("Any hint gives the same set") {
+        std::mt19937 gen(5);
+        std::uniform_int_distribution<int> dist(0, 500);
+        flat_set<int> fs;
+        std::set<int> expected;
+        for (int i = 0; i < 2000; ++i) {
+            int v = dist(gen);
+            auto hint = fs.begin() + std::uniform_int_distribution<size_t>(0, fs.size())(gen);
+            auto it = (i % 2) ? fs.insert(hint, v) : fs.emplace_hint(hint, v);
+            REQUIRE(*it == v);
+            expected.insert(v);
+        }
+        REQUIRE(set_equal(fs, expected));
+    }
+    SECTION("Emplace reports whether it inserted") {
+        flat_set<std::pair<int, int>> fs;
+        REQUIRE(fs.emplace(1, 2).second);
+        REQUIRE(fs.emplace(0, 5).second);
+        auto present = fs.emplace(1, 2);
+        REQUIRE_FALSE(present.second);
+        REQUIRE(*present.first == std::make_pair(1, 2));
+        REQUIRE(fs.size() == 2);
+    }
+    SECTION("Appending in order with end() as the hint takes one comparison") {
+        size_t calls = 0;
+        counting_less less;
+        less.calls = &calls;
+        flat_set<tracker, counting_less> fs(less);
+        fs.reserve(1000);
+        for (int i = 0; i < 1000; ++i) {
+            fs.emplace_hint(fs.end(), i);
+        }
+        REQUIRE(fs.size() == 1000);
+        REQUIRE(calls == 999);
+
+        // A wrong hint costs two comparisons on top of the binary search
+        calls = 0;
+        fs.insert(fs.end(), tracker(500.5));
+        REQUIRE(calls <= 2 + 12);
+        REQUIRE(fs.size() == 1001);
+    }
+    SECTION("Elements are constructed only when inserted") {
+        size_t calls = 0;
+        counting_less less;
+        less.calls = &calls;
+        flat_set<tracker, counting_less> fs(less);
+        fs.reserve(100);
+        fs.emplace(1.0);
+        fs.emplace(2.0);
+
+        // Numbers are compared with the elements as they are
+        auto oldt = tracker::cnt;
+        REQUIRE_FALSE(fs.emplace(1.0).second);
+        REQUIRE(fs.emplace_hint(fs.begin(), 2.0) == fs.begin() + 1);
+        REQUIRE(tracker::cnt - oldt == counter{});
+
+        oldt = tracker::cnt;
+        fs.emplace_hint(fs.end(), 3.0);
+        REQUIRE(tracker::cnt - oldt == counter(0, 0, 0, 0, 0, 0, 1));
+
+        tracker present(2.0);
+        oldt = tracker::cnt;
+        fs.insert(fs.end(), present);
+        fs.insert(fs.begin(), present);
+        REQUIRE(tracker::cnt - oldt == counter{});
+
+        tracker appended(4.0);
+        oldt = tracker::cnt;
+        fs.insert(fs.end(), appended);
+        REQUIRE(tracker::cnt - oldt == counter(0, 1, 0, 0, 0, 0, 0));
+    }
+    SECTION("Without a transparent comparator the element is built to be looked up") {
+        flat_set<tracker> fs;
+        fs.reserve(10);
+        fs.emplace(1.0);
+        auto oldt = tracker::cnt;
+        REQUIRE_FALSE(fs.emplace(1.0).second);
+        REQUIRE(tracker::cnt - oldt == counter(0, 0, 0, 0, 0, 1, 1));
+
+        oldt = tracker::cnt;
+        REQUIRE(fs.emplace(2.0).second);
+        REQUIRE(tracker::cnt - oldt == counter(0, 0, 0, 1, 0, 1, 1));
+    }
+}